@@ -0,0 +1,860 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "mjson.h"
+#include "mjson.hpp"
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+static std::string make_comment_heavy_config(size_t target_size)
+{
+    std::string text;
+    int         entry = 0;
+
+    while (text.size() < target_size)
+    {
+        char buf[1024];
+
+        snprintf(buf, sizeof(buf),
+            "// ---------------------------------------------------------------------------\n"
+            "// Entry %d: settings below are documented in the engine configuration manual\n"
+            "// ---------------------------------------------------------------------------\n"
+            "entry_%d = {\n"
+            "    /* Name shown in the editor.\n"
+            "     * Keep it short, it is used as a column header. */\n"
+            "    name     = \"Entry %d\"      // display name\n"
+            "    enabled  = true            // disabled entries are skipped at load time\n"
+            "    priority = %d              // higher value wins\n"
+            "    weights  = [ 1.5, 2.25,    /* inline comment */ 3.0 ]\n"
+            "}\n\n",
+            entry, entry, entry, entry % 16);
+        text += buf;
+        ++entry;
+    }
+
+    return text;
+}
+
+static std::string make_compact_config(size_t target_size)
+{
+    std::string text;
+    int         entry = 0;
+
+    while (text.size() < target_size)
+    {
+        char buf[256];
+
+        snprintf(buf, sizeof(buf),
+            "entry_%d={name=\"Entry %d\" enabled=true priority=%d weights=[1.5,2.25,3.0]}\n",
+            entry, entry, entry % 16);
+        text += buf;
+        ++entry;
+    }
+
+    return text;
+}
+
+static std::string make_string_heavy_json(size_t target_size)
+{
+    std::string text = "[\n";
+    int         entry = 0;
+
+    while (text.size() < target_size)
+    {
+        char buf[1024];
+
+        snprintf(buf, sizeof(buf),
+            "  {\"id\": \"menu.entry.%d\", \"en\": \"Open the selected item in a new window\", "
+            "\"de\": \"Ausgew\\u00e4hltes Element in einem neuen Fenster \\u00f6ffnen\", "
+            "\"quote\": \"He said \\\"hello\\\" \\ud83d\\ude00\\nand left\"},\n",
+            entry);
+        text += buf;
+        ++entry;
+    }
+    text += "  {}\n]\n";
+
+    return text;
+}
+
+typedef int (*parse_func_t)(const char*, size_t, void*, size_t, mjson_element_t*);
+
+static void run_benchmark(const char* name, const char* mode, parse_func_t parse, const std::string& text, int iterations)
+{
+    std::vector<uint8_t> storage(text.size() * 4 + 1024);
+    mjson_element_t      top = NULL;
+    double               best_seconds = 1e30;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        if (!parse(text.data(), text.size(), &storage[0], storage.size(), &top))
+        {
+            printf("%-16s %-8s parse failed\n", name, mode);
+            return;
+        }
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < best_seconds)
+            best_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s\n", name, mode, text.size() / 1e6, text.size() / 1e6 / best_seconds);
+}
+
+// Feeds input in 64 KB chunks as if it was read from a pipe
+static int parse_stream(const char* json, size_t json_size, void* storage_buf, size_t storage_buf_size, mjson_element_t* top_element)
+{
+    const size_t    chunk_size = 64 * 1024;
+    mjson_stream_t* parser     = mjson_parser_begin(storage_buf, storage_buf_size, 0);
+
+    for (size_t i = 0; i < json_size; i += chunk_size)
+    {
+        if (!mjson_parser_feed(parser, json + i, json_size - i < chunk_size ? json_size - i : chunk_size))
+            break;
+    }
+
+    return mjson_parser_end(parser, top_element);
+}
+
+// Size pass only, storage is not touched
+static int parse_size(const char* json, size_t json_size, void* storage_buf, size_t storage_buf_size, mjson_element_t* top_element)
+{
+    size_t size;
+
+    *top_element = NULL;
+
+    return mjson_parse_size(json, json_size, &size) && size <= storage_buf_size;
+}
+
+// Validation of blob parsed with lookup tables, throughput is per blob byte
+static void run_validate_benchmark(const char* name, const std::string& text, int iterations)
+{
+    void*           storage;
+    size_t          storage_size;
+    mjson_element_t top;
+    double          best_seconds = 1e30;
+
+    if (!mjson_parse_ex(text.data(), text.size(), MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS, NULL, &storage, &storage_size, &top))
+    {
+        printf("%-16s %-8s parse failed\n", name, "validate");
+        return;
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        if (!mjson_validate_blob(storage, storage_size))
+        {
+            printf("%-16s %-8s validation failed\n", name, "validate");
+            break;
+        }
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < best_seconds)
+            best_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s\n", name, "validate", storage_size / 1e6, storage_size / 1e6 / best_seconds);
+    free(storage);
+}
+
+// Writes blob back as compact text, throughput is per text byte
+static void run_write_benchmark(const char* name, const std::string& text, int iterations)
+{
+    std::vector<uint8_t> storage(text.size() * 4 + 1024);
+    std::vector<char>    output(text.size() * 2 + 1024);
+    mjson_element_t      top;
+    size_t               size = 0;
+    double               best_seconds = 1e30;
+
+    if (!mjson_parse(text.data(), text.size(), &storage[0], storage.size(), &top))
+    {
+        printf("%-16s %-8s parse failed\n", name, "write");
+        return;
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        if (!mjson_write(top, MJSON_WRITE_STRICT, &output[0], output.size(), &size))
+        {
+            printf("%-16s %-8s write failed\n", name, "write");
+            return;
+        }
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < best_seconds)
+            best_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s\n", name, "write", size / 1e6, size / 1e6 / best_seconds);
+}
+
+// Top-level array split between threads, 0 threads picks cpu count
+static void run_parallel_benchmark(const char* name, const char* mode, int thread_count, const std::string& text, int iterations)
+{
+    double best_seconds = 1e30;
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        void*           storage;
+        size_t          storage_size;
+        mjson_element_t top;
+
+        bench_clock::time_point start = bench_clock::now();
+
+        if (!mjson_parse_parallel(text.data(), text.size(), 0, thread_count, NULL, &storage, &storage_size, &top))
+        {
+            printf("%-16s %-8s parse failed\n", name, mode);
+            return;
+        }
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < best_seconds)
+            best_seconds = seconds;
+
+        free(storage);
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s\n", name, mode, text.size() / 1e6, text.size() / 1e6 / best_seconds);
+}
+
+// Nested lookup through accessor chain against precompiled path
+static void run_path_benchmark(const char* mode, unsigned flags, int iterations)
+{
+    static const char*   text = "config = { servers = [ { name = \"a\" port = 1 }, { name = \"b\" port = 2 limits = { max_connections = 64 } } ] }";
+    std::vector<uint8_t> storage(4096);
+    mjson_element_t      top = NULL;
+    mjson_path_t*        path = mjson_path_compile("config.servers[1].limits.max_connections");
+    long long            sum = 0;
+    const int            lookups = 100000;
+
+    if (!mjson_parse_with_flags(text, strlen(text), &storage[0], storage.size(), flags, &top))
+    {
+        printf("%-16s %-8s parse failed\n", "path", mode);
+        return;
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+
+    for (int n = 0; n < iterations * lookups; ++n)
+        sum += mjson_get_int(mjson_get_member(mjson_get_member(mjson_get_element(mjson_get_member(mjson_get_member(top, "config"), "servers"), 1), "limits"), "max_connections"), 0);
+
+    double chain_seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    start = bench_clock::now();
+
+    for (int n = 0; n < iterations * lookups; ++n)
+        sum += mjson_get_int(mjson_path_eval(top, path), 0);
+
+    double path_seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    using namespace mj::literals;
+
+    start = bench_clock::now();
+
+    for (int n = 0; n < iterations * lookups; ++n)
+        sum += mjson_get_int(mj::value(top)["config"_key]["servers"_key][1]["limits"_key]["max_connections"_key].element(), 0);
+
+    double key_seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    printf("%-16s %-8s %6.1f ns/chain %6.1f ns/path %6.1f ns/key (%d)\n", "path", mode,
+        chain_seconds * 1e9 / ((double)lookups * iterations), path_seconds * 1e9 / ((double)lookups * iterations),
+        key_seconds * 1e9 / ((double)lookups * iterations), (int)(sum & 1));
+    mjson_path_free(path);
+}
+
+// Reads last top level value of big document, full parse against
+// on-demand navigation of text
+static void run_lazy_benchmark(const char* name, const std::string& text, int iterations)
+{
+    std::vector<uint8_t> storage(text.size() * 4 + 1024);
+    mjson_element_t      top = NULL, key, value;
+    std::string          last_key;
+    double               parse_seconds = 1e30, lazy_seconds = 1e30;
+    int                  count, found = 0;
+
+    if (!mjson_parse(text.data(), text.size(), &storage[0], storage.size(), &top))
+    {
+        printf("%-16s %-8s parse failed\n", name, "lazy");
+        return;
+    }
+
+    count = mjson_get_array_length(top);
+    for (key = mjson_get_member_first(top, &value); key; key = mjson_get_member_next(top, key, &value))
+        last_key = mjson_get_string(key, "");
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        mjson_parse(text.data(), text.size(), &storage[0], storage.size(), &top);
+        if (count)
+            found += mjson_get_type(mjson_get_element(top, count - 1)) != MJSON_ID_NULL;
+        else
+            found += mjson_get_type(mjson_get_member(top, last_key.c_str())) != MJSON_ID_NULL;
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < parse_seconds)
+            parse_seconds = seconds;
+
+        start = bench_clock::now();
+
+        mjson_lazy_t lazy = mjson_lazy_open(text.data(), text.size());
+        if (count)
+            found += mjson_lazy_get_type(mjson_lazy_get_element(lazy, count - 1)) != MJSON_ID_NULL;
+        else
+            found += mjson_lazy_get_type(mjson_lazy_get_member(lazy, last_key.c_str())) != MJSON_ID_NULL;
+
+        seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < lazy_seconds)
+            lazy_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s  x%.1f\n", name, "lazy", text.size() / 1e6, text.size() / 1e6 / lazy_seconds, parse_seconds / lazy_seconds);
+    if (found != 2 * iterations)
+        printf("%-16s %-8s lookup failed\n", name, "lazy");
+}
+
+struct bench_settings_t
+{
+    int32_t width, height, depth;
+    double  scale;
+    int     fullscreen;
+    char    title[32];
+    int32_t layers[16];
+    size_t  layer_count;
+};
+
+// Config document copied into struct: parse and mjson_get_member against
+// mjson_bind, which builds no blob
+static void run_bind_benchmark(const char* mode, int iterations)
+{
+    static const mjson_bind_field_t fields[] = {
+        { "width",      MJSON_BIND_INT32,  offsetof(bench_settings_t, width) },
+        { "height",     MJSON_BIND_INT32,  offsetof(bench_settings_t, height) },
+        { "depth",      MJSON_BIND_INT32,  offsetof(bench_settings_t, depth) },
+        { "scale",      MJSON_BIND_DOUBLE, offsetof(bench_settings_t, scale) },
+        { "fullscreen", MJSON_BIND_BOOL,   offsetof(bench_settings_t, fullscreen) },
+        { "title",      MJSON_BIND_STRING, offsetof(bench_settings_t, title), sizeof(((bench_settings_t*)0)->title) },
+        { "layers",     MJSON_BIND_ARRAY,  offsetof(bench_settings_t, layers), sizeof(int32_t), NULL, MJSON_BIND_INT32, 16, offsetof(bench_settings_t, layer_count) }
+    };
+    static const mjson_schema_t schema = { fields, sizeof(fields) / sizeof(fields[0]) };
+    static const char* text =
+        "// window\n"
+        "title = \"Bench window\", width = 1920, height = 1080, depth = 32, scale = 1.25, fullscreen = false,\n"
+        "audio = { volume = 0.8, device = \"default\", channels = [\"left\", \"right\"] },\n"
+        "input = { bindings = [ { key = \"w\", action = \"forward\" }, { key = \"s\", action = \"back\" } ] },\n"
+        "layers = [1, 2, 3, 4, 5, 6, 7, 8]";
+    std::vector<uint8_t> storage(4096);
+    bench_settings_t     settings;
+    mjson_element_t      top, item;
+    long long            sum = 0;
+    const int            documents = 20000;
+    size_t               len = strlen(text);
+
+    bench_clock::time_point start = bench_clock::now();
+
+    for (int n = 0; n < iterations * documents; ++n)
+    {
+        if (!mjson_parse(text, len, &storage[0], storage.size(), &top))
+        {
+            printf("%-16s %-8s parse failed\n", "bind", mode);
+            return;
+        }
+
+        settings.width      = mjson_get_int(mjson_get_member(top, "width"), 0);
+        settings.height     = mjson_get_int(mjson_get_member(top, "height"), 0);
+        settings.depth      = mjson_get_int(mjson_get_member(top, "depth"), 0);
+        settings.scale      = mjson_get_double(mjson_get_member(top, "scale"), 0);
+        settings.fullscreen = mjson_get_bool(mjson_get_member(top, "fullscreen"), 0);
+        snprintf(settings.title, sizeof(settings.title), "%s", mjson_get_string(mjson_get_member(top, "title"), ""));
+        settings.layer_count = 0;
+        for (item = mjson_get_element_first(mjson_get_member(top, "layers")); item && settings.layer_count < 16; item = mjson_get_element_next(mjson_get_member(top, "layers"), item))
+            settings.layers[settings.layer_count++] = mjson_get_int(item, 0);
+
+        sum += settings.width + settings.layer_count;
+    }
+
+    double parse_seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    start = bench_clock::now();
+
+    for (int n = 0; n < iterations * documents; ++n)
+    {
+        if (!mjson_bind(text, len, &schema, &settings))
+        {
+            printf("%-16s %-8s bind failed\n", "bind", mode);
+            return;
+        }
+
+        sum += settings.width + settings.layer_count;
+    }
+
+    double bind_seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    printf("%-16s %-8s %6.2f us/parse %6.2f us/bind  x%.1f (%d)\n", "bind", mode,
+        parse_seconds * 1e6 / ((double)documents * iterations), bind_seconds * 1e6 / ((double)documents * iterations),
+        parse_seconds / bind_seconds, (int)(sum & 1));
+}
+
+// Full document walks summing integers and string lengths
+static long long walk_c(mjson_element_t element)
+{
+    mjson_element_t key, value;
+    long long       sum = 0;
+
+    switch (mjson_get_type(element))
+    {
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_ARRAY64:
+            for (value = mjson_get_element_first(element); value; value = mjson_get_element_next(element, value))
+                sum += walk_c(value);
+            return sum;
+
+        case MJSON_ID_DICT32:
+        case MJSON_ID_DICT64:
+            for (key = mjson_get_member_first(element, &value); key; key = mjson_get_member_next(element, key, &value))
+                sum += strlen(mjson_get_string(key, "")) + walk_c(value);
+            return sum;
+
+        case MJSON_ID_UTF8_STRING32:
+        case MJSON_ID_UTF8_STRING64:
+            return strlen(mjson_get_string(element, ""));
+    }
+
+    return mjson_get_int64(element, 0);
+}
+
+static long long walk_cursor(mjson_element_t element)
+{
+    mjson_cursor_t cursor;
+    long long      sum = 0;
+
+    switch (mjson_get_type(element))
+    {
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_ARRAY64:
+        case MJSON_ID_DICT32:
+        case MJSON_ID_DICT64:
+            for (mjson_cursor_enter(&cursor, element); !mjson_cursor_at_end(&cursor); mjson_cursor_next(&cursor))
+            {
+                if (mjson_cursor_key(&cursor))
+                    sum += strlen(mjson_get_string(mjson_cursor_key(&cursor), ""));
+                sum += walk_cursor(mjson_cursor_value(&cursor));
+            }
+            return sum;
+
+        case MJSON_ID_UTF8_STRING32:
+        case MJSON_ID_UTF8_STRING64:
+            return strlen(mjson_get_string(element, ""));
+    }
+
+    return mjson_get_int64(element, 0);
+}
+
+static long long walk_views(mj::value element)
+{
+    long long sum = 0;
+
+    switch (element.type())
+    {
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_ARRAY64:
+            for (mj::value value : element.array())
+                sum += walk_views(value);
+            return sum;
+
+        case MJSON_ID_DICT32:
+        case MJSON_ID_DICT64:
+            for (mj::member member : element.dict())
+                sum += member.key.size() + walk_views(member.val);
+            return sum;
+
+        case MJSON_ID_UTF8_STRING32:
+        case MJSON_ID_UTF8_STRING64:
+            return element.string().size();
+    }
+
+    return element.get<int64_t>();
+}
+
+static void run_walk_benchmark(const char* name, const std::string& text, int iterations)
+{
+    std::vector<uint8_t> storage(text.size() * 4 + 1024);
+    mjson_element_t      top = NULL;
+    double               c_seconds = 1e30, cursor_seconds = 1e30, views_seconds = 1e30;
+    long long            c_sum = 0, cursor_sum = 0, views_sum = 0;
+
+    if (!mjson_parse(text.data(), text.size(), &storage[0], storage.size(), &top))
+    {
+        printf("%-16s %-8s parse failed\n", name, "walk");
+        return;
+    }
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        c_sum = walk_c(top);
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < c_seconds)
+            c_seconds = seconds;
+
+        start = bench_clock::now();
+
+        cursor_sum = walk_cursor(top);
+
+        seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < cursor_seconds)
+            cursor_seconds = seconds;
+
+        start = bench_clock::now();
+
+        views_sum = walk_views(top);
+
+        seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+        if (seconds < views_seconds)
+            views_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f ms/walk  %8.2f ms/cursor  x%.1f  %8.2f ms/views  x%.1f\n", name, "walk",
+        c_seconds * 1e3, cursor_seconds * 1e3, c_seconds / cursor_seconds, views_seconds * 1e3, c_seconds / views_seconds);
+    if (c_sum != cursor_sum || c_sum != views_sum)
+        printf("%-16s %-8s walks differ\n", name, "walk");
+}
+
+// NDJSON lines parsed into caller buffers, so threads share nothing but
+// input; speedup is relative to the first thread count
+static void run_ndjson_benchmark(const char* name, size_t size, int iterations)
+{
+    static const int              thread_counts[] = { 1, 2, 4, 8, 16 };
+    std::string                   text;
+    std::vector<mjson_document_t> documents;
+    std::vector<uint8_t>          storage;
+    size_t                        count = 0;
+    double                        base_seconds = 0;
+
+    for (int entry = 0; text.size() < size; ++entry)
+    {
+        char buf[256];
+
+        snprintf(buf, sizeof(buf),
+            "{\"time\": %d, \"level\": \"info\", \"msg\": \"request %d served\", \"tags\": [\"http\", \"get\"], \"ms\": %d.25}\n",
+            1600000000 + entry, entry, entry % 1000);
+        text += buf;
+    }
+
+    mjson_parse_ndjson(text.data(), text.size(), 0, 1, NULL, NULL, &count);
+    documents.resize(count);
+    storage.resize(count * 512);
+
+    for (int t = 0; t < (int)(sizeof(thread_counts) / sizeof(thread_counts[0])); ++t)
+    {
+        double best_seconds = 1e30;
+        char   mode[16];
+
+        for (int i = 0; i < iterations; ++i)
+        {
+            for (size_t d = 0; d < count; ++d)
+            {
+                documents[d].storage_buf      = &storage[d * 512];
+                documents[d].storage_buf_size = 512;
+            }
+
+            bench_clock::time_point start = bench_clock::now();
+
+            if (!mjson_parse_ndjson(text.data(), text.size(), 0, thread_counts[t], NULL, &documents[0], &count))
+            {
+                printf("%-16s %-8s parse failed\n", name, "ndjson");
+                return;
+            }
+
+            double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+            if (seconds < best_seconds)
+                best_seconds = seconds;
+        }
+
+        if (t == 0)
+            base_seconds = best_seconds;
+
+        snprintf(mode, sizeof(mode), "%d thr", thread_counts[t]);
+        printf("%-16s %-8s %8.2f MB  %9.1f MB/s  x%.2f\n", name, mode, text.size() / 1e6, text.size() / 1e6 / best_seconds, base_seconds / best_seconds);
+    }
+}
+
+static void run_benchmarks(const char* name, const std::string& text, int iterations)
+{
+    run_benchmark(name, "parse",   mjson_parse,         text, iterations);
+    run_benchmark(name, "indexed", mjson_parse_indexed, text, iterations);
+    run_benchmark(name, "stream",  parse_stream,        text, iterations);
+    run_benchmark(name, "size",    parse_size,          text, iterations);
+    run_validate_benchmark(name, text, iterations);
+    run_write_benchmark(name, text, iterations);
+    run_lazy_benchmark(name, text, iterations);
+    run_walk_benchmark(name, text, iterations);
+    run_parallel_benchmark(name, "serial",   1, text, iterations);
+    run_parallel_benchmark(name, "parallel", 0, text, iterations);
+}
+
+static void run_lookup_benchmark(const char* mode, unsigned flags, int keys, int iterations)
+{
+    std::string          text;
+    std::vector<uint8_t> storage;
+    mjson_element_t      top = NULL;
+    char                 buf[64];
+    int                  found = 0;
+
+    for (int i = 0; i < keys; ++i)
+    {
+        snprintf(buf, sizeof(buf), "key_%d = %d\n", i, i);
+        text += buf;
+    }
+
+    storage.resize(text.size() * 8 + 1024);
+    if (!mjson_parse_with_flags(text.data(), text.size(), &storage[0], storage.size(), flags, &top))
+    {
+        printf("%-16s %-8s parse failed\n", "lookup", mode);
+        return;
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+
+    for (int n = 0; n < iterations; ++n)
+    {
+        for (int i = 0; i < keys; ++i)
+        {
+            snprintf(buf, sizeof(buf), "key_%d", i);
+            found += mjson_get_member(top, buf) != NULL;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    printf("%-16s %-8s %8d keys %9.1f ns/lookup\n", "lookup", mode, keys, seconds * 1e9 / ((double)keys * iterations));
+    if (found != keys * iterations)
+        printf("%-16s %-8s lookup failed\n", "lookup", mode);
+}
+
+static void run_array_benchmark(const char* mode, unsigned flags, int count, int iterations)
+{
+    std::string          text = "[";
+    std::vector<uint8_t> storage;
+    mjson_element_t      top = NULL;
+    char                 buf[32];
+    long long            sum = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        snprintf(buf, sizeof(buf), i ? ",%d" : "%d", i);
+        text += buf;
+    }
+    text += "]";
+
+    storage.resize(text.size() * 8 + 1024);
+    if (!mjson_parse_with_flags(text.data(), text.size(), &storage[0], storage.size(), flags, &top))
+    {
+        printf("%-16s %-8s parse failed\n", "array", mode);
+        return;
+    }
+
+    bench_clock::time_point start = bench_clock::now();
+
+    // random access near the end is the worst case for linear walk
+    for (int n = 0; n < iterations; ++n)
+        for (int i = count - 1000; i < count; ++i)
+            sum += mjson_get_int(mjson_get_element(top, i), 0);
+
+    double seconds = std::chrono::duration<double>(bench_clock::now() - start).count();
+
+    printf("%-16s %-8s %8d elements %6.1f ns/access (%d)\n", "array", mode, mjson_get_array_length(top), seconds * 1e9 / (1000.0 * iterations), (int)(sum & 1));
+}
+
+static int read_file(const char* path, std::string& text)
+{
+    FILE* file = fopen(path, "rb");
+    char  buf[64 * 1024];
+    size_t read;
+
+    if (!file) return 0;
+
+    text.clear();
+    while ((read = fread(buf, 1, sizeof(buf), file)) > 0)
+        text.append(buf, read);
+    fclose(file);
+
+    return 1;
+}
+
+static int write_to_file(void* user_data, const char* data, size_t size)
+{
+    return fwrite(data, 1, size, (FILE*)user_data) == size;
+}
+
+// mjson_parse over one corpus document: throughput, documents per second and
+// blob bytes per input byte. Result is added to results array if given.
+static void run_corpus_benchmark(const char* name, const std::string& text, int iterations, mjson_builder_t* results)
+{
+    std::vector<uint8_t> storage;
+    mjson_element_t      top = NULL;
+    size_t               blob_size;
+    double               best_seconds = 1e30;
+    // small documents are parsed repeatedly so timer resolution does not matter
+    int                  repeat = text.size() < (1 << 20) ? (int)((1 << 20) / (text.size() + 1)) + 1 : 1;
+
+    if (!mjson_parse_size(text.data(), text.size(), &blob_size))
+    {
+        printf("%-16s %-8s parse failed\n", name, "corpus");
+        return;
+    }
+
+    storage.resize(blob_size);
+
+    for (int i = 0; i < iterations; ++i)
+    {
+        bench_clock::time_point start = bench_clock::now();
+
+        for (int r = 0; r < repeat; ++r)
+        {
+            if (!mjson_parse(text.data(), text.size(), &storage[0], storage.size(), &top))
+            {
+                printf("%-16s %-8s parse failed\n", name, "corpus");
+                return;
+            }
+        }
+
+        double seconds = std::chrono::duration<double>(bench_clock::now() - start).count() / repeat;
+        if (seconds < best_seconds)
+            best_seconds = seconds;
+    }
+
+    printf("%-16s %-8s %8.2f MB  %9.1f MB/s  %9.1f docs/s  %5.2f out/in\n", name, "corpus",
+        text.size() / 1e6, text.size() / 1e6 / best_seconds, 1.0 / best_seconds, (double)blob_size / text.size());
+
+    if (!results)
+        return;
+
+    mjson_builder_begin_dict(results);
+    mjson_builder_key   (results, "name");
+    mjson_builder_string(results, name);
+    mjson_builder_key   (results, "input_bytes");
+    mjson_builder_uint  (results, text.size());
+    mjson_builder_key   (results, "output_bytes");
+    mjson_builder_uint  (results, blob_size);
+    mjson_builder_key   (results, "mb_per_s");
+    mjson_builder_float (results, text.size() / 1e6 / best_seconds);
+    mjson_builder_key   (results, "docs_per_s");
+    mjson_builder_float (results, 1.0 / best_seconds);
+    mjson_builder_key   (results, "output_per_input");
+    mjson_builder_float (results, (double)blob_size / text.size());
+    mjson_builder_end   (results);
+}
+
+// Usage: mjson_bench [iterations] [size_kb] [-c] [-o results.json] [corpus files...]
+// -c runs corpus only, -o writes corpus results as JSON
+int main(int argc, char** argv)
+{
+    size_t                   size         = 1024 * 1024;
+    int                      iterations   = 10;
+    int                      numbers      = 0;
+    int                      corpus_only  = 0;
+    const char*              results_path = NULL;
+    std::vector<const char*> files;
+    std::string              text;
+    mjson_builder_t*         results;
+    void*                    blob;
+    size_t                   blob_size;
+    mjson_element_t          top;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "-c") == 0)
+            corpus_only = 1;
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+            results_path = argv[++i];
+        else if (argv[i][0] >= '0' && argv[i][0] <= '9' && numbers < 2)
+        {
+            if (numbers++ == 0)
+                iterations = atoi(argv[i]);
+            else
+                size = (size_t)atoi(argv[i]) * 1024;
+        }
+        else
+            files.push_back(argv[i]);
+    }
+
+    results = mjson_builder_create_ex(0, NULL);
+    mjson_builder_begin_dict (results);
+    mjson_builder_key        (results, "iterations");
+    mjson_builder_int        (results, iterations);
+    mjson_builder_key        (results, "corpus");
+    mjson_builder_begin_array(results);
+
+    for (size_t i = 0; i < files.size(); ++i)
+    {
+        const char* name = strrchr(files[i], '/') ? strrchr(files[i], '/') + 1 : files[i];
+
+        if (!read_file(files[i], text))
+        {
+            printf("%-16s %-8s can not read %s\n", name, "corpus", files[i]);
+            continue;
+        }
+
+        run_corpus_benchmark(name, text, iterations, results);
+    }
+
+    run_corpus_benchmark("comment-heavy", make_comment_heavy_config(size), iterations, results);
+    run_corpus_benchmark("compact",       make_compact_config(size),       iterations, results);
+    run_corpus_benchmark("string-heavy",  make_string_heavy_json(size),    iterations, results);
+
+    mjson_builder_end(results);
+    mjson_builder_end(results);
+
+    if (mjson_builder_finish(results, &blob, &blob_size, &top))
+    {
+        FILE* file = results_path ? fopen(results_path, "wb") : NULL;
+
+        if (file)
+        {
+            mjson_write_sink(top, MJSON_WRITE_PRETTY | MJSON_WRITE_STRICT, write_to_file, file);
+            fputc('\n', file);
+            fclose(file);
+        }
+        else if (results_path)
+        {
+            printf("can not write %s\n", results_path);
+        }
+
+        free(blob);
+    }
+
+    if (corpus_only)
+        return 0;
+
+    run_benchmarks("comment-heavy", make_comment_heavy_config(size), iterations);
+    run_benchmarks("compact",       make_compact_config(size),       iterations);
+    run_benchmarks("string-heavy",  make_string_heavy_json(size),    iterations);
+
+    run_lookup_benchmark("linear", 0,                      2000, iterations);
+    run_lookup_benchmark("hashed", MJSON_PARSE_HASH_DICTS, 2000, iterations);
+
+    run_array_benchmark("linear",  0,                        100000, iterations);
+    run_array_benchmark("indexed", MJSON_PARSE_INDEX_ARRAYS, 100000, iterations);
+
+    run_path_benchmark("linear", 0,                      iterations);
+    run_path_benchmark("hashed", MJSON_PARSE_HASH_DICTS, iterations);
+
+    run_bind_benchmark("config", iterations);
+
+    run_ndjson_benchmark("ndjson", size, iterations);
+
+    return 0;
+}
@@ -1,10 +1,39 @@
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <vector>
 #include "sput.h"
 #include "mjson.h"
+#include "mjson.hpp"
 
 void mjson_valid_syntax_tests();
 void mjson_invalid_syntax_tests();
+void mjson_indexed_tests();
+void mjson_stream_tests();
+void mjson_size_tests();
+void mjson_allocator_tests();
+void mjson_file_tests();
+void mjson_parallel_tests();
+void mjson_batch_tests();
+void mjson_validate_tests();
+void mjson_stats_tests();
+void mjson_bind_tests();
 void mjson_content_tests();
+void mjson_number_tests();
+void mjson_string_tests();
+void mjson_hashed_dict_tests();
+void mjson_indexed_array_tests();
+void mjson_interning_tests();
+void mjson_write_tests();
+void mjson_builder_tests();
+void mjson_wide_entry_tests();
+void mjson_path_tests();
+void mjson_lazy_tests();
+void mjson_cursor_tests();
+void mjson_cpp_key_tests();
+void mjson_cpp_view_tests();
 
 int main()
 {
@@ -13,9 +42,32 @@ int main()
     sput_enter_suite("mjson: Parsing tests");
     sput_run_test(mjson_valid_syntax_tests);
     sput_run_test(mjson_invalid_syntax_tests);
+    sput_run_test(mjson_indexed_tests);
+    sput_run_test(mjson_stream_tests);
+    sput_run_test(mjson_size_tests);
+    sput_run_test(mjson_allocator_tests);
+    sput_run_test(mjson_file_tests);
+    sput_run_test(mjson_parallel_tests);
+    sput_run_test(mjson_batch_tests);
+    sput_run_test(mjson_validate_tests);
+    sput_run_test(mjson_stats_tests);
+    sput_run_test(mjson_bind_tests);
 
     sput_enter_suite("mjson: Data tests");
     sput_run_test(mjson_content_tests);
+    sput_run_test(mjson_number_tests);
+    sput_run_test(mjson_string_tests);
+    sput_run_test(mjson_hashed_dict_tests);
+    sput_run_test(mjson_indexed_array_tests);
+    sput_run_test(mjson_interning_tests);
+    sput_run_test(mjson_write_tests);
+    sput_run_test(mjson_builder_tests);
+    sput_run_test(mjson_wide_entry_tests);
+    sput_run_test(mjson_path_tests);
+    sput_run_test(mjson_lazy_tests);
+    sput_run_test(mjson_cursor_tests);
+    sput_run_test(mjson_cpp_key_tests);
+    sput_run_test(mjson_cpp_view_tests);
 
     sput_finish_testing();
 
@@ -122,6 +174,15 @@ const char* valid_json[] =
     "{ \"言語\": \"日本語\" }",
     /*UTF-8 with escape sequence*/
     "{ \"Язык\": \"Русский\\n\" }",
+    /*Long whitespace and comment runs*/
+    "{\n                                                                        a = 1\n}",
+    "{\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t\t}",
+    "// Single line comment which is longer than any vector register width\n"
+    "a = 1 // trailing comment with * and / characters inside /* */\n"
+    "/* Multi line comment\n * with leading stars on every line\n ***/\n"
+    "b = 2 /**/ c = 3 /***/ d = 4\n",
+    "[1, /* a comment which is long enough to cross a vector boundary or two of them */ 2]",
+    "a = 1 /***/ b = 2 */ c = 3",
 };
 
 void mjson_valid_syntax_tests()
@@ -203,6 +264,11 @@ const char* invalid_json[] =
     "[0,]",
     "[,0]",
     "[]0",
+
+    "a = 1 // comment without newline",
+    "a = 1 /* unterminated comment                                            ",
+    "a = 1 /*/ b = 2",
+    "a = 1 /                                                                  ",
 };
 
 void mjson_invalid_syntax_tests()
@@ -215,6 +281,533 @@ void mjson_invalid_syntax_tests()
     }
 }
 
+void mjson_indexed_tests()
+{
+    static uint8_t  bjson_indexed[MAX_BJSON_SIZE];
+    mjson_element_t top_element;
+    mjson_element_t top_element_indexed;
+    int             result, result_indexed;
+
+    for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+    {
+        memset(bjson, 0, 64*1024);
+        memset(bjson_indexed, 0, 64*1024);
+        result         = mjson_parse(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), &top_element);
+        result_indexed = mjson_parse_indexed(valid_json[i], strlen(valid_json[i]), bjson_indexed, sizeof(bjson_indexed), &top_element_indexed);
+        sput_fail_unless(result && result_indexed, "");
+        sput_fail_unless((const uint8_t*)top_element - bjson == (const uint8_t*)top_element_indexed - bjson_indexed, "");
+        sput_fail_unless(memcmp(bjson, bjson_indexed, 64*1024) == 0, "");
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+    {
+        sput_fail_if(mjson_parse_indexed(invalid_json[i], strlen(invalid_json[i]), bjson, sizeof(bjson), &top_element), "");
+    }
+}
+
+static int stream_parse(const char* json, size_t chunk_size, void* storage_buf, size_t storage_buf_size, mjson_element_t* top_element)
+{
+    mjson_stream_t* parser = mjson_parser_begin(storage_buf, storage_buf_size, 0);
+    size_t          len    = strlen(json);
+
+    for (size_t i = 0; i < len; i += chunk_size)
+        mjson_parser_feed(parser, json + i, len - i < chunk_size ? len - i : chunk_size);
+
+    return mjson_parser_end(parser, top_element);
+}
+
+void mjson_stream_tests()
+{
+    static uint8_t  bjson_stream[MAX_BJSON_SIZE];
+    static const size_t chunk_sizes[] = { 1, 3, 64 };
+    mjson_element_t top_element;
+    mjson_element_t top_element_stream;
+    int             result, result_stream;
+
+    for (int c = 0; c < ARRAY_SIZE(chunk_sizes); ++c)
+    {
+        for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+        {
+            memset(bjson, 0, 64*1024);
+            memset(bjson_stream, 0, 64*1024);
+            result        = mjson_parse(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), &top_element);
+            result_stream = stream_parse(valid_json[i], chunk_sizes[c], bjson_stream, sizeof(bjson_stream), &top_element_stream);
+            sput_fail_unless(result && result_stream, "");
+            sput_fail_unless((const uint8_t*)top_element - bjson == (const uint8_t*)top_element_stream - bjson_stream, "");
+            sput_fail_unless(memcmp(bjson, bjson_stream, 64*1024) == 0, "");
+        }
+
+        for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+        {
+            sput_fail_if(stream_parse(invalid_json[i], chunk_sizes[c], bjson, sizeof(bjson), &top_element), "");
+        }
+    }
+}
+
+void mjson_size_tests()
+{
+    static const unsigned flags[] = { 0, MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS };
+    mjson_element_t top_element;
+    size_t          size;
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+        {
+            size_t len = strlen(valid_json[i]);
+
+            sput_fail_unless(mjson_parse_size_with_flags(valid_json[i], len, flags[f], &size), "");
+            sput_fail_unless(mjson_parse_with_flags(valid_json[i], len, bjson, size, flags[f], &top_element), "");
+            sput_fail_if(mjson_parse_with_flags(valid_json[i], len, bjson, size - 1, flags[f], &top_element), "");
+        }
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+    {
+        sput_fail_if(mjson_parse_size(invalid_json[i], strlen(invalid_json[i]), &size), "");
+        sput_fail_unless(size == 0, "");
+    }
+
+    // \\u escapes of 1 to 4 UTF-8 bytes at the very end of exact storage
+    static const char* escaped_json[] = {
+        "[\"x\\u0041\"]",
+        "[\"x\\u00e9\"]",
+        "[\"xy\\u00e9\"]",
+        "[\"x\\u20ac\"]",
+        "[\"x\\ud83d\\ude00\"]",
+        "[\"\\u00e9\\u00e9\\u00e9\"]",
+        "[\"ab\\u20ac\", \"\\ud83d\\ude00x\"]"
+    };
+
+    for (int i = 0; i < ARRAY_SIZE(escaped_json); ++i)
+    {
+        size_t len = strlen(escaped_json[i]);
+
+        sput_fail_unless(mjson_parse_size(escaped_json[i], len, &size), escaped_json[i]);
+        sput_fail_unless(mjson_parse(escaped_json[i], len, bjson, size, &top_element), escaped_json[i]);
+        sput_fail_if(mjson_parse(escaped_json[i], len, bjson, size - 1, &top_element), escaped_json[i]);
+    }
+}
+
+struct test_allocator_t
+{
+    size_t grows;
+    size_t live;
+};
+
+static void* test_reserve(void* user_data, size_t size)
+{
+    ((test_allocator_t*)user_data)->live++;
+    return malloc(size);
+}
+
+// always moves the block and poisons the old one, so stale pointers show up
+static void* test_grow(void* user_data, void* buf, size_t old_size, size_t new_size)
+{
+    void* moved = malloc(new_size);
+
+    ((test_allocator_t*)user_data)->grows++;
+    memcpy(moved, buf, old_size < new_size ? old_size : new_size);
+    memset(buf, 0xcd, old_size);
+    free(buf);
+
+    return moved;
+}
+
+static void test_release(void* user_data, void* buf, size_t size)
+{
+    ((test_allocator_t*)user_data)->live--;
+    free(buf);
+}
+
+void mjson_allocator_tests()
+{
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_INDEXED,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS | MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS
+    };
+    test_allocator_t  state = { 0, 0 };
+    mjson_allocator_t allocator = { test_reserve, test_grow, test_release, &state };
+    mjson_element_t   top_element, top_element_ex;
+    void*             storage;
+    size_t            storage_size;
+    std::string       text;
+
+    for (int i = 0; i < 2000; ++i)
+    {
+        char item[96];
+        sprintf(item, "k%d = { s = \"value\\t%d\" a = [%d, -%d.5, true, \"x\"] }\n", i, i, i, i);
+        text += item;
+    }
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        for (int i = 0; i <= ARRAY_SIZE(valid_json); ++i)
+        {
+            const char* json = i < ARRAY_SIZE(valid_json) ? valid_json[i] : text.c_str();
+            size_t      len  = strlen(json);
+            size_t      size;
+
+            sput_fail_unless(mjson_parse_size_with_flags(json, len, flags[f], &size), "");
+            sput_fail_unless(mjson_parse_with_flags(json, len, bjson, sizeof(bjson), flags[f], &top_element), "");
+            sput_fail_unless(mjson_parse_ex(json, len, flags[f], &allocator, &storage, &storage_size, &top_element_ex), "");
+            sput_fail_unless(storage_size <= size, "");
+            sput_fail_unless((const uint8_t*)top_element_ex - (const uint8_t*)storage == (const uint8_t*)top_element - bjson, "");
+            sput_fail_unless(memcmp(storage, bjson, storage_size) == 0, "");
+            allocator.release(allocator.user_data, storage, storage_size);
+        }
+    }
+
+    sput_fail_unless(state.grows > 0, "");
+
+    // short interned strings and keys outgrow initial storage at every
+    // offset, so some grow happens on padding after string entry
+    static const char* items[] = { "\"a\"", "\"b\\t\"", "{\"k\":\"ab\"}", "\"abc\"", "{\"kk\":\"a\\tb\"}" };
+
+    for (int n = 1; n < 96; ++n)
+    {
+        std::string doc = "[";
+
+        for (int i = 0; i < n; ++i)
+        {
+            doc += i ? "," : "";
+            doc += items[(i + n) % ARRAY_SIZE(items)];
+        }
+        doc += "]";
+
+        sput_fail_unless(mjson_parse_with_flags(doc.c_str(), doc.size(), bjson, sizeof(bjson), flags[2], &top_element), "");
+        sput_fail_unless(mjson_parse_ex(doc.c_str(), doc.size(), flags[2], &allocator, &storage, &storage_size, &top_element_ex), "");
+        sput_fail_unless(memcmp(storage, bjson, storage_size) == 0, "");
+        allocator.release(allocator.user_data, storage, storage_size);
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+    {
+        sput_fail_if(mjson_parse_ex(invalid_json[i], strlen(invalid_json[i]), 0, &allocator, &storage, &storage_size, &top_element_ex), "");
+        sput_fail_unless(storage == NULL && storage_size == 0, "");
+    }
+
+    sput_fail_unless(state.live == 0, "");
+
+    sput_fail_unless(mjson_parse_ex(text.c_str(), text.size(), 0, NULL, &storage, &storage_size, &top_element_ex), "");
+    sput_fail_unless(mjson_get_type(mjson_get_member(top_element_ex, "k1999")) == MJSON_ID_DICT32, "");
+    free(storage);
+}
+
+static int write_file(const char* path, const void* data, size_t size)
+{
+    FILE* file = fopen(path, "wb");
+
+    if (!file) return 0;
+
+    size_t written = fwrite(data, 1, size, file);
+    fclose(file);
+
+    return written == size;
+}
+
+void mjson_file_tests()
+{
+    static const char* text_path = "mjson_test_text.tmp";
+    static const char* blob_path = "mjson_test_blob.tmp";
+    mjson_element_t top_element, top_element_file;
+    void*           storage;
+    size_t          storage_size, blob_size;
+    const void*     blob;
+
+    for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+    {
+        size_t len = strlen(valid_json[i]);
+
+        memset(bjson, 0, sizeof(bjson));
+        sput_fail_unless(mjson_parse(valid_json[i], len, bjson, sizeof(bjson), &top_element), "");
+        sput_fail_unless(write_file(text_path, valid_json[i], len), "");
+        sput_fail_unless(mjson_load_text_file(text_path, 0, NULL, &storage, &storage_size, &top_element_file), "");
+        sput_fail_unless((const uint8_t*)top_element_file - (const uint8_t*)storage == (const uint8_t*)top_element - bjson, "");
+        sput_fail_unless(memcmp(storage, bjson, storage_size) == 0, "");
+
+        sput_fail_unless(mjson_get_top_element(storage, storage_size) == top_element_file, "");
+        sput_fail_unless(write_file(blob_path, storage, storage_size), "");
+        free(storage);
+
+        blob = mjson_map_blob_file(blob_path, &blob_size, &top_element_file);
+        sput_fail_unless(blob != NULL && blob_size == storage_size, "");
+        sput_fail_unless((const uint8_t*)top_element_file - (const uint8_t*)blob == (const uint8_t*)top_element - bjson, "");
+        sput_fail_unless(blob && memcmp(blob, bjson, blob_size) == 0, "");
+        mjson_unmap_blob_file(blob, blob_size);
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+    {
+        sput_fail_unless(write_file(text_path, invalid_json[i], strlen(invalid_json[i])), "");
+        sput_fail_if(mjson_load_text_file(text_path, 0, NULL, &storage, &storage_size, &top_element_file), "");
+        sput_fail_unless(storage == NULL, "");
+    }
+
+    // text file is not a blob
+    sput_fail_unless(write_file(blob_path, "{ a = 1 }", 9), "");
+    sput_fail_unless(mjson_map_blob_file(blob_path, &blob_size, &top_element_file) == NULL, "");
+    sput_fail_unless(top_element_file == NULL, "");
+
+    remove(text_path);
+    remove(blob_path);
+
+    sput_fail_if(mjson_load_text_file(text_path, 0, NULL, &storage, &storage_size, &top_element_file), "");
+    sput_fail_unless(mjson_map_blob_file(blob_path, &blob_size, &top_element_file) == NULL, "");
+}
+
+void mjson_parallel_tests()
+{
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS
+    };
+    static const char* broken[] = { ",,", ",]", "]" };
+    mjson_element_t top_element, top_element_ex;
+    void*           storage;
+    void*           storage_ex;
+    size_t          storage_size, storage_ex_size;
+    std::string     text = "[\n";
+
+    // big enough to be split in several slices
+    for (int i = 0; text.size() < 5 * 1024 * 1024; ++i)
+    {
+        char item[160];
+        sprintf(item, "  {\"id\": %d, \"name\": \"item, [%d]\", \"tags\": [\"a\", \"b\"], \"nested\": {\"v\": -%d.5}},\n", i, i, i);
+        text += item;
+    }
+    text += "  null\n]\n";
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_ex(text.c_str(), text.size(), flags[f], NULL, &storage_ex, &storage_ex_size, &top_element_ex), "");
+        sput_fail_unless(mjson_parse_parallel(text.c_str(), text.size(), flags[f], 4, NULL, &storage, &storage_size, &top_element), "");
+        sput_fail_unless(storage_size == storage_ex_size, "");
+        sput_fail_unless((const uint8_t*)top_element - (const uint8_t*)storage == (const uint8_t*)top_element_ex - (const uint8_t*)storage_ex, "");
+        sput_fail_unless(memcmp(storage, storage_ex, storage_size) == 0, "");
+        free(storage);
+        free(storage_ex);
+    }
+
+    // errors anywhere in the middle fail the whole parse
+    for (int i = 0; i < ARRAY_SIZE(broken); ++i)
+    {
+        std::string bad = text;
+        size_t      pos = bad.find(",\n", bad.size() / 3 + i * bad.size() / 5);
+
+        bad.replace(pos, 1, broken[i]);
+        sput_fail_if(mjson_parse_parallel(bad.c_str(), bad.size(), 0, 4, NULL, &storage, &storage_size, &top_element), "");
+        sput_fail_unless(storage == NULL && storage_size == 0, "");
+    }
+
+    sput_fail_if(mjson_parse_parallel(text.c_str(), text.size() - 3, 0, 4, NULL, &storage, &storage_size, &top_element), "");
+
+    // greedy comment spans guessed split, commas hide in comments and
+    // strings with raw newlines, all must give the serial blob
+    static const char* greedy_middle[] = { ",\n/* x **/ 2,\n 3 /* y **/ 4", ",\n/* x **/ 2,\n 3 */       4" };
+    std::string greedy[ARRAY_SIZE(greedy_middle)];
+    std::string commented = "[\r\n";
+
+    for (int m = 0; m < ARRAY_SIZE(greedy_middle); ++m)
+    {
+        greedy[m] = "[0";
+        for (int i = 0; i < 600008; ++i)
+            greedy[m] += ",\n7";
+        greedy[m] += greedy_middle[m];
+        for (int i = 0; i < 600000; ++i)
+            greedy[m] += ",\n9";
+        greedy[m] += "]";
+    }
+
+    for (int i = 0; commented.size() < 3 * 1024 * 1024; ++i)
+    {
+        char item[160];
+        sprintf(item, "  // item, [%d\r\n  {id: %d, /* a, { */ s: \"p\r\n, q\"},\r\n", i, i);
+        commented += item;
+    }
+    commented += "  null\r\n]\r\n";
+
+    const std::string* serial_checked[] = { &greedy[0], &greedy[1], &commented };
+
+    for (int i = 0; i < ARRAY_SIZE(serial_checked); ++i)
+    {
+        const std::string& doc = *serial_checked[i];
+
+        sput_fail_unless(mjson_parse_ex(doc.c_str(), doc.size(), 0, NULL, &storage_ex, &storage_ex_size, &top_element_ex), "");
+
+        for (int threads = 2; threads <= 4; ++threads)
+        {
+            sput_fail_unless(mjson_parse_parallel(doc.c_str(), doc.size(), 0, threads, NULL, &storage, &storage_size, &top_element), "");
+            sput_fail_unless(storage_size == storage_ex_size, "");
+            sput_fail_unless(memcmp(storage, storage_ex, storage_size) == 0, "");
+            free(storage);
+        }
+
+        free(storage_ex);
+    }
+
+    // other documents go to serial parser
+    for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+    {
+        sput_fail_unless(mjson_parse_parallel(valid_json[i], strlen(valid_json[i]), 0, 4, NULL, &storage, &storage_size, &top_element), "");
+        free(storage);
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid_json); ++i)
+        sput_fail_if(mjson_parse_parallel(invalid_json[i], strlen(invalid_json[i]), 0, 4, NULL, &storage, &storage_size, &top_element), "");
+}
+
+void mjson_batch_tests()
+{
+    const size_t                  valid_count = ARRAY_SIZE(valid_json);
+    std::vector<mjson_document_t> documents(2 * valid_count);
+    std::vector<uint8_t>          buffers(valid_count * 4096);
+    std::vector<std::string>      texts;
+    mjson_element_t               top_element;
+    std::string                   ndjson;
+    size_t                        count;
+
+    // every document twice, into allocated and into caller storage
+    for (size_t i = 0; i < valid_count; ++i)
+    {
+        documents[2 * i].json_data          = valid_json[i];
+        documents[2 * i].json_data_size     = strlen(valid_json[i]);
+        documents[2 * i + 1]                = documents[2 * i];
+        documents[2 * i + 1].storage_buf      = &buffers[i * 4096];
+        documents[2 * i + 1].storage_buf_size = 4096;
+    }
+
+    sput_fail_unless(mjson_parse_batch(&documents[0], documents.size(), 0, 4, NULL), "");
+
+    for (size_t i = 0; i < valid_count; ++i)
+    {
+        const mjson_document_t& allocated = documents[2 * i];
+        const mjson_document_t& provided  = documents[2 * i + 1];
+
+        sput_fail_unless(mjson_parse(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), &top_element), "");
+        sput_fail_unless((const uint8_t*)allocated.top_element - (const uint8_t*)allocated.storage_buf == (const uint8_t*)top_element - bjson, "");
+        sput_fail_unless((const uint8_t*)provided.top_element - (const uint8_t*)provided.storage_buf == (const uint8_t*)top_element - bjson, "");
+        sput_fail_unless(memcmp(allocated.storage_buf, bjson, allocated.storage_buf_size) == 0, "");
+        sput_fail_unless(memcmp(provided.storage_buf, bjson, allocated.storage_buf_size) == 0, "");
+        free(allocated.storage_buf);
+    }
+
+    // many documents of uneven size make workers steal from each other
+    documents.assign(5000, mjson_document_t());
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::string text = "a = [";
+        for (int j = 0; j < (i % 100 == 0 ? 2000 : 3); ++j)
+            text += j ? ", 1" : "1";
+        texts.push_back(text + (i % 1000 == 999 ? "}" : "]"));
+    }
+
+    for (size_t i = 0; i < texts.size(); ++i)
+    {
+        documents[i].json_data      = texts[i].c_str();
+        documents[i].json_data_size = texts[i].size();
+    }
+
+    sput_fail_if(mjson_parse_batch(&documents[0], documents.size(), MJSON_PARSE_INDEX_ARRAYS, 8, NULL), "");
+
+    for (size_t i = 0; i < documents.size(); ++i)
+    {
+        sput_fail_unless((documents[i].top_element == NULL) == (i % 1000 == 999), "");
+        sput_fail_unless(mjson_get_array_length(mjson_get_member(documents[i].top_element, "a")) == (i % 1000 == 999 ? 0 : i % 100 == 0 ? 2000 : 3), "");
+        free(documents[i].storage_buf);
+    }
+
+    ndjson = "{\"id\": 1, \"v\": [1, 2]}\n\n{\"id\": 2}\r\n  \t\r\n{\"id\": 3, \"s\": \"x\"}";
+
+    sput_fail_unless(mjson_parse_ndjson(ndjson.c_str(), ndjson.size(), 0, 2, NULL, NULL, &count), "");
+    sput_fail_unless(count == 3, "");
+
+    documents.assign(2, mjson_document_t());
+    count = documents.size();
+    sput_fail_if(mjson_parse_ndjson(ndjson.c_str(), ndjson.size(), 0, 2, NULL, &documents[0], &count), "");
+    sput_fail_unless(count == 3 && documents[0].top_element == NULL, "");
+
+    documents.assign(3, mjson_document_t());
+    sput_fail_unless(mjson_parse_ndjson(ndjson.c_str(), ndjson.size(), MJSON_PARSE_HASH_DICTS, 2, NULL, &documents[0], &count), "");
+    for (size_t i = 0; i < count; ++i)
+    {
+        sput_fail_unless(mjson_get_int(mjson_get_member(documents[i].top_element, "id"), 0) == (int)i + 1, "");
+        free(documents[i].storage_buf);
+    }
+
+    // broken line fails only itself
+    ndjson += "\n{\"id\": }\n{\"id\": 5}\n";
+    documents.assign(5, mjson_document_t());
+    count = documents.size();
+    sput_fail_if(mjson_parse_ndjson(ndjson.c_str(), ndjson.size(), 0, 0, NULL, &documents[0], &count), "");
+    sput_fail_unless(count == 5, "");
+    sput_fail_unless(documents[3].top_element == NULL && documents[3].storage_buf == NULL, "");
+    sput_fail_unless(mjson_get_int(mjson_get_member(documents[4].top_element, "id"), 0) == 5, "");
+    for (size_t i = 0; i < count; ++i)
+        free(documents[i].storage_buf);
+
+    sput_fail_unless(mjson_parse_batch(NULL, 0, 0, 4, NULL), "");
+}
+
+void mjson_validate_tests()
+{
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS
+    };
+    static const char* json = "{ k = [1, 2.5, \"str\", {a = \"str\", b = null}, 12345678901], s = \"x\" }";
+    mjson_element_t top_element;
+    void*           storage;
+    size_t          size, len = strlen(json);
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+        {
+            sput_fail_unless(mjson_parse_size_with_flags(valid_json[i], strlen(valid_json[i]), flags[f], &size), "");
+            sput_fail_unless(mjson_parse_with_flags(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), flags[f], &top_element), "");
+            sput_fail_unless(mjson_validate_blob(bjson, sizeof(bjson)), "");
+        }
+
+        // blob is exactly trimmed here, so any truncation breaks it
+        sput_fail_unless(mjson_parse_ex(json, len, flags[f], NULL, &storage, &size, &top_element), "");
+        sput_fail_unless(mjson_validate_blob(storage, size), "");
+
+        for (size_t s = 0; s < size; ++s)
+            sput_fail_if(mjson_validate_blob(storage, s), "");
+
+        sput_fail_if(mjson_validate_blob((uint8_t*)storage + 4, size - 4), "");
+        free(storage);
+    }
+
+    sput_fail_unless(mjson_parse(json, len, bjson, sizeof(bjson), &top_element), "");
+    sput_fail_unless(mjson_parse_size(json, len, &size), "");
+
+    uint32_t* words = (uint32_t*)bjson;
+
+    words[0] ^= 1;                  // fourcc
+    sput_fail_if(mjson_validate_blob(bjson, size), "");
+    words[0] ^= 1;
+
+    words[3] = 0x7f;                // unknown id of first element
+    sput_fail_if(mjson_validate_blob(bjson, size), "");
+    words[3] = 10;
+
+    words[4] += 4;                  // key length no longer points at terminator
+    sput_fail_if(mjson_validate_blob(bjson, size), "");
+    words[4] -= 4;
+
+    words[2] += 4;                  // top dictionary overlaps its last value
+    sput_fail_if(mjson_validate_blob(bjson, size), "");
+    words[2] -= 4;
+
+    sput_fail_unless(mjson_validate_blob(bjson, size), "");
+    memmove(bjson + 1, bjson, size);
+    sput_fail_if(mjson_validate_blob(bjson + 1, size), "");
+}
+
 const char* jsonAPItest = 
     "a = 5\n"
     "b = \"string\"\n"
@@ -234,6 +827,170 @@ const char* jsonAPItest =
     "c : null\n"
     "ff = 11.0\n";
 
+void mjson_stats_tests()
+{
+    static const char* json = "// comment\n{ k = [1, 2.5, \"s\\n\", {a = \"str\", b = null}], s = \"x\" }";
+    mjson_parse_stats_t stats, zero;
+    mjson_element_t     top_element;
+    size_t              size, len = strlen(json);
+    uint64_t            total = 0;
+
+    memset(&stats, 0, sizeof(stats));
+    memset(&zero,  0, sizeof(zero));
+
+    sput_fail_unless(mjson_parse_with_stats(json, len, bjson, sizeof(bjson), 0, &stats, &top_element), "");
+    sput_fail_unless(mjson_get_int(mjson_get_element(mjson_get_member(top_element, "k"), 0), 0) == 1, "");
+
+    if (!stats.enabled)
+    {
+        // library built without MJSON_STATS leaves stats alone
+        sput_fail_unless(memcmp(&stats, &zero, sizeof(stats)) == 0, "");
+        return;
+    }
+
+    sput_fail_unless(stats.tokens[MJSON_STATS_IDENTIFIER] == 4, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_STRING]     == 3, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_INTEGER]    == 1, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_FLOAT]      == 1, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_LITERAL]    == 1, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_SEPARATOR]  == 9, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_OPEN]       == 3, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_CLOSE]      == 3, "");
+    sput_fail_unless(stats.escaped_strings == 1, "");
+    sput_fail_unless(stats.plain_strings   == 6, "");
+    sput_fail_unless(stats.max_depth       == 3, "");
+
+    sput_fail_unless(mjson_parse_size(json, len, &size), "");
+    for (int i = 0; i <= MJSON_ID_DICT64; ++i)
+        total += stats.output_bytes[i];
+    sput_fail_unless(total == size - sizeof(uint32_t), "");
+    sput_fail_unless(stats.output_bytes[MJSON_ID_DICT32] == 16, "");
+    sput_fail_unless(stats.output_bytes[MJSON_ID_NULL]   == 4, "");
+
+    // counters accumulate over documents, lookup tables are BINARY32
+    memset(&stats, 0, sizeof(stats));
+    sput_fail_unless(mjson_parse_with_stats("/* c */ [ 1 ]", 13, bjson, sizeof(bjson), MJSON_PARSE_INDEX_ARRAYS, &stats, &top_element), "");
+    sput_fail_unless(mjson_parse_with_stats("/* c */ [ 1 ]", 13, bjson, sizeof(bjson), MJSON_PARSE_INDEXED, &stats, &top_element), "");
+    sput_fail_unless(stats.skipped_bytes == 20, "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_INTEGER] == 2, "");
+    sput_fail_unless(stats.max_depth == 1, "");
+    sput_fail_unless(stats.output_bytes[MJSON_ID_ARRAY32] == 16, "");
+    sput_fail_unless(stats.output_bytes[MJSON_ID_BINARY32] > 0, "");
+
+    // failed parse still counts tokens it has seen
+    memset(&stats, 0, sizeof(stats));
+    sput_fail_if(mjson_parse_with_stats("[1, 2", 5, bjson, sizeof(bjson), 0, &stats, &top_element), "");
+    sput_fail_unless(stats.tokens[MJSON_STATS_INTEGER] == 2, "");
+    sput_fail_unless(stats.output_bytes[MJSON_ID_ARRAY32] == 0, "");
+}
+
+struct bind_point_t
+{
+    int32_t x, y;
+};
+
+struct bind_config_t
+{
+    int32_t      width;
+    int64_t      big;
+    uint32_t     u32;
+    uint64_t     u64;
+    float        scale;
+    double       ratio;
+    int          enabled;
+    char         name[8];
+    bind_point_t origin;
+    int32_t      nums[4];
+    size_t       num_count;
+    bind_point_t points[2];
+    size_t       point_count;
+    char         tags[2][4];
+    size_t       tag_count;
+};
+
+void mjson_bind_tests()
+{
+    static const mjson_bind_field_t point_fields[] = {
+        { "x", MJSON_BIND_INT32, offsetof(bind_point_t, x) },
+        { "y", MJSON_BIND_INT32, offsetof(bind_point_t, y) }
+    };
+    static const mjson_schema_t point_schema = { point_fields, ARRAY_SIZE(point_fields) };
+    static const mjson_bind_field_t config_fields[] = {
+        { "width",   MJSON_BIND_INT32,  offsetof(bind_config_t, width) },
+        { "big",     MJSON_BIND_INT64,  offsetof(bind_config_t, big) },
+        { "u32",     MJSON_BIND_UINT32, offsetof(bind_config_t, u32) },
+        { "u64",     MJSON_BIND_UINT64, offsetof(bind_config_t, u64) },
+        { "scale",   MJSON_BIND_FLOAT,  offsetof(bind_config_t, scale) },
+        { "ratio",   MJSON_BIND_DOUBLE, offsetof(bind_config_t, ratio) },
+        { "enabled", MJSON_BIND_BOOL,   offsetof(bind_config_t, enabled) },
+        { "name",    MJSON_BIND_STRING, offsetof(bind_config_t, name), sizeof(((bind_config_t*)0)->name) },
+        { "origin",  MJSON_BIND_OBJECT, offsetof(bind_config_t, origin), 0, &point_schema },
+        { "nums",    MJSON_BIND_ARRAY,  offsetof(bind_config_t, nums), sizeof(int32_t), NULL, MJSON_BIND_INT32, 4, offsetof(bind_config_t, num_count) },
+        { "points",  MJSON_BIND_ARRAY,  offsetof(bind_config_t, points), sizeof(bind_point_t), &point_schema, MJSON_BIND_OBJECT, 2, offsetof(bind_config_t, point_count) },
+        { "tags",    MJSON_BIND_ARRAY,  offsetof(bind_config_t, tags), 4, NULL, MJSON_BIND_STRING, 2, offsetof(bind_config_t, tag_count) }
+    };
+    static const mjson_schema_t config_schema = { config_fields, ARRAY_SIZE(config_fields) };
+    static const char* json =
+        "// unknown members are skipped\n"
+        "width = 640, big = -5000000000, u32 = 0xFFFFFFFF, u64 = 18446744073709551615, scale = 2, ratio = 0.1,\n"
+        "enabled = true, name = \"a\\tb\", skip = { deep = [1, { x = 2 }], s = \"x\" }, origin = { y = -3, z = 1, x = 7 },\n"
+        "nums = [1 2 3], points = [ { x = 1, y = 2 }, { x = 3 } ], tags = [\"abc\", \"d\"], \"x\" = null";
+    static const char* invalid[] = {
+        "width = 2147483648",
+        "width = -2147483649",
+        "width = 1.5",
+        "width = \"1\"",
+        "u32 = -1",
+        "u32 = 4294967296",
+        "u64 = -1",
+        "big = 9223372036854775808",
+        "enabled = 1",
+        "name = \"12345678\"",
+        "name = \"1234567\\n\"",
+        "name = 1",
+        "origin = [1]",
+        "nums = [1, 2, 3, 4, 5]",
+        "nums = [1.5]",
+        "tags = [\"abcd\"]",
+        "skip = [1,]",
+        "skip = { a }",
+        "width = 1,",
+        "[ 1 ]",
+        "{ width = 1 } x"
+    };
+    bind_config_t config;
+
+    memset(&config, 0, sizeof(config));
+    config.width = 5;
+    config.num_count = 9;
+
+    sput_fail_unless(mjson_bind("{ }", 3, &config_schema, &config), "");
+    sput_fail_unless(config.width == 5 && config.num_count == 9, "");
+
+    sput_fail_unless(mjson_bind(json, strlen(json), &config_schema, &config), "");
+    sput_fail_unless(config.width == 640, "");
+    sput_fail_unless(config.big == -5000000000ll, "");
+    sput_fail_unless(config.u32 == 0xFFFFFFFFu, "");
+    sput_fail_unless(config.u64 == 18446744073709551615ull, "");
+    sput_fail_unless(config.scale == 2.0f, "");
+    sput_fail_unless(config.ratio == 0.1, "");
+    sput_fail_unless(config.enabled == 1, "");
+    sput_fail_unless(strcmp(config.name, "a\tb") == 0, "");
+    sput_fail_unless(config.origin.x == 7 && config.origin.y == -3, "");
+    sput_fail_unless(config.num_count == 3 && config.nums[0] == 1 && config.nums[2] == 3, "");
+    sput_fail_unless(config.point_count == 2, "");
+    sput_fail_unless(config.points[0].x == 1 && config.points[0].y == 2 && config.points[1].x == 3, "");
+    sput_fail_unless(config.tag_count == 2 && strcmp(config.tags[0], "abc") == 0 && strcmp(config.tags[1], "d") == 0, "");
+
+    for (int i = 0; i < ARRAY_SIZE(invalid); ++i)
+        sput_fail_if(mjson_bind(invalid[i], strlen(invalid[i]), &config_schema, &config), invalid[i]);
+
+    // same values as parsing and reading blob
+    mjson_element_t top_element;
+    sput_fail_unless(mjson_parse(json, strlen(json), bjson, sizeof(bjson), &top_element), "");
+    sput_fail_unless(mjson_get_double(mjson_get_member(top_element, "ratio"), 0) == config.ratio, "");
+}
+
 void mjson_content_tests()
 {
     int result;
@@ -335,3 +1092,928 @@ void mjson_content_tests()
     cres =  mjson_get_string(it, "");
     sput_fail_unless(strcmp(cres, "ff")==0, "");
 }
+
+const char* jsonNumberTest =
+    "small   = -2147483648\n"
+    "big     = 12439084123\n"
+    "neg     = -12439084123\n"
+    "huge    = 18446744073709551615\n"
+    "hex     = 0xFFFFFFFF\n"
+    "oct     = 0777\n"
+    "half    = 0.5\n"
+    "precise = 0.30000000000000004\n"
+    "tiny    = 4.9e-324\n"
+    "beyond  = 123456789012345678901234567890\n";
+
+void mjson_number_tests()
+{
+    int result;
+    mjson_element_t top_element, v;
+
+    result = mjson_parse(jsonNumberTest, strlen(jsonNumberTest), bjson, sizeof(bjson), &top_element);
+    sput_fail_unless(result, "");
+
+    v = mjson_get_member(top_element, "small");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_SINT32, "");
+    sput_fail_unless(mjson_get_int(v, 0) == INT32_MIN, "");
+
+    v = mjson_get_member(top_element, "big");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_SINT64, "");
+    sput_fail_unless(mjson_get_int64(v, 0) == 12439084123LL, "");
+    sput_fail_unless(mjson_get_int(v, -1) == -1, "");
+
+    v = mjson_get_member(top_element, "neg");
+    sput_fail_unless(mjson_get_int64(v, 0) == -12439084123LL, "");
+    sput_fail_unless(mjson_get_uint64(v, 7) == 7, "");
+
+    v = mjson_get_member(top_element, "huge");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_UINT64, "");
+    sput_fail_unless(mjson_get_uint64(v, 0) == 18446744073709551615ULL, "");
+    sput_fail_unless(mjson_get_int64(v, 7) == 7, "");
+
+    v = mjson_get_member(top_element, "hex");
+    sput_fail_unless(mjson_get_int64(v, 0) == 0xFFFFFFFFLL, "");
+
+    v = mjson_get_member(top_element, "oct");
+    sput_fail_unless(mjson_get_int(v, 0) == 0777, "");
+
+    v = mjson_get_member(top_element, "half");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_FLOAT32, "");
+    sput_fail_unless(mjson_get_float(v, 0.0f) == 0.5f, "");
+
+    v = mjson_get_member(top_element, "precise");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_FLOAT64, "");
+    sput_fail_unless(mjson_get_double(v, 0.0) == 0.30000000000000004, "");
+
+    v = mjson_get_member(top_element, "tiny");
+    sput_fail_unless(mjson_get_double(v, 0.0) == 4.9e-324, "");
+
+    v = mjson_get_member(top_element, "beyond");
+    sput_fail_unless(mjson_get_type(v) == MJSON_ID_FLOAT64, "");
+    sput_fail_unless(mjson_get_double(v, 0.0) == 123456789012345678901234567890.0, "");
+}
+
+const char* jsonStringTest =
+    "escapes   = \"\\\"\\\\\\/\\b\\f\\n\\r\\t\"\n"
+    "bmp       = \"\\u0041\\u00e9\\u65E5\"\n"
+    "pair      = \"\\ud83d\\ude00\"\n"
+    "lone      = \"\\ud83d|\\ude00\"\n"
+    "long      = \"a string which is longer than any vector register width \\u0041\\n with escapes\"\n";
+
+void mjson_string_tests()
+{
+    int result;
+    mjson_element_t top_element, v;
+
+    result = mjson_parse(jsonStringTest, strlen(jsonStringTest), bjson, sizeof(bjson), &top_element);
+    sput_fail_unless(result, "");
+
+    v = mjson_get_member(top_element, "escapes");
+    sput_fail_unless(strcmp(mjson_get_string(v, ""), "\"\\/\b\f\n\r\t") == 0, "");
+
+    v = mjson_get_member(top_element, "bmp");
+    sput_fail_unless(strcmp(mjson_get_string(v, ""), "A\xC3\xA9\xE6\x97\xA5") == 0, "");
+
+    v = mjson_get_member(top_element, "pair");
+    sput_fail_unless(strcmp(mjson_get_string(v, ""), "\xF0\x9F\x98\x80") == 0, "");
+
+    v = mjson_get_member(top_element, "lone");
+    sput_fail_unless(strcmp(mjson_get_string(v, ""), "\xED\xA0\xBD|\xED\xB8\x80") == 0, "");
+
+    v = mjson_get_member(top_element, "long");
+    sput_fail_unless(strcmp(mjson_get_string(v, ""), "a string which is longer than any vector register width A\n with escapes") == 0, "");
+}
+
+const char* jsonHashedDictTest =
+    "ab     = 1\n"
+    "abc    = 2\n"
+    "a      = 3\n"
+    "nested = { x = 4, y = { z = 5 } }\n"
+    "empty  = {}\n"
+    "list   = [ { k = 6 }, { k = 7 } ]\n"
+    "ab     = 8\n";
+
+void mjson_hashed_dict_tests()
+{
+    int result;
+    mjson_element_t top_element, v, key, nested;
+    int count;
+    char name[16];
+
+    result = mjson_parse_with_flags(jsonHashedDictTest, strlen(jsonHashedDictTest), bjson, sizeof(bjson), MJSON_PARSE_HASH_DICTS, &top_element);
+    sput_fail_unless(result, "");
+    sput_fail_unless(mjson_get_type(top_element) == MJSON_ID_DICT32, "");
+
+    sput_fail_unless(mjson_get_int(mjson_get_member(top_element, "a"),   0) == 3, "");
+    sput_fail_unless(mjson_get_int(mjson_get_member(top_element, "ab"),  0) == 1, "");
+    sput_fail_unless(mjson_get_int(mjson_get_member(top_element, "abc"), 0) == 2, "");
+    sput_fail_unless(mjson_get_member(top_element, "abcd") == NULL, "");
+    sput_fail_unless(mjson_get_member(top_element, "") == NULL, "");
+
+    nested = mjson_get_member(top_element, "nested");
+    sput_fail_unless(mjson_get_int(mjson_get_member(nested, "x"), 0) == 4, "");
+    sput_fail_unless(mjson_get_int(mjson_get_member(mjson_get_member(nested, "y"), "z"), 0) == 5, "");
+
+    sput_fail_unless(mjson_get_member(mjson_get_member(top_element, "empty"), "x") == NULL, "");
+
+    v = mjson_get_member(top_element, "list");
+    sput_fail_unless(mjson_get_int(mjson_get_member(mjson_get_element(v, 1), "k"), 0) == 7, "");
+
+    count = 0;
+    for (key = mjson_get_member_first(top_element, &v); key; key = mjson_get_member_next(top_element, key, &v))
+        ++count;
+    sput_fail_unless(count == 7, "");
+
+    // large dictionary
+    std::string text;
+    for (int i = 0; i < 2000; ++i)
+    {
+        snprintf(name, sizeof(name), "key%d = %d\n", i, i);
+        text += name;
+    }
+
+    result = mjson_parse_with_flags(text.c_str(), text.size(), bjson, sizeof(bjson), MJSON_PARSE_HASH_DICTS, &top_element);
+    sput_fail_unless(result, "");
+
+    count = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        snprintf(name, sizeof(name), "key%d", i);
+        count += mjson_get_int(mjson_get_member(top_element, name), -1) == i;
+    }
+    sput_fail_unless(count == 2000, "");
+}
+
+const char* jsonIndexedArrayTest =
+    "mixed = [ 1, \"two\", [ 3, 4 ], { five = 5 }, 6.5, 12439084123, null ]\n"
+    "empty = []\n";
+
+void mjson_indexed_array_tests()
+{
+    static const unsigned flags[] = { 0, MJSON_PARSE_INDEX_ARRAYS };
+
+    int result;
+    mjson_element_t top_element, v, mixed, empty;
+
+    for (int i = 0; i < ARRAY_SIZE(flags); ++i)
+    {
+        result = mjson_parse_with_flags(jsonIndexedArrayTest, strlen(jsonIndexedArrayTest), bjson, sizeof(bjson), flags[i], &top_element);
+        sput_fail_unless(result, "");
+
+        mixed = mjson_get_member(top_element, "mixed");
+        empty = mjson_get_member(top_element, "empty");
+
+        sput_fail_unless(mjson_get_type(mixed) == MJSON_ID_ARRAY32, "");
+        sput_fail_unless(mjson_get_array_length(mixed) == 7, "");
+        sput_fail_unless(mjson_get_array_length(empty) == 0, "");
+        sput_fail_unless(mjson_get_array_length(top_element) == 0, "");
+
+        sput_fail_unless(mjson_get_int(mjson_get_element(mixed, 0), 0) == 1, "");
+        sput_fail_unless(strcmp(mjson_get_string(mjson_get_element(mixed, 1), ""), "two") == 0, "");
+        sput_fail_unless(mjson_get_int(mjson_get_element(mjson_get_element(mixed, 2), 1), 0) == 4, "");
+        sput_fail_unless(mjson_get_int(mjson_get_member(mjson_get_element(mixed, 3), "five"), 0) == 5, "");
+        sput_fail_unless(mjson_get_float(mjson_get_element(mixed, 4), 0.0f) == 6.5f, "");
+        sput_fail_unless(mjson_get_int64(mjson_get_element(mixed, 5), 0) == 12439084123LL, "");
+        sput_fail_unless(mjson_get_type(mjson_get_element(mixed, 6)) == MJSON_ID_NULL && mjson_get_element(mixed, 6) != NULL, "");
+        sput_fail_unless(mjson_get_element(mixed, 7) == NULL, "");
+        sput_fail_unless(mjson_get_element(mixed, -1) == NULL, "");
+        sput_fail_unless(mjson_get_element(empty, 0) == NULL, "");
+
+        // empty array must not expose the sibling which follows it
+        sput_fail_unless(mjson_get_element_first(empty) == NULL, "");
+
+        v = mjson_get_element_first(mixed);
+        for (int j = 0; j < 6; ++j)
+            v = mjson_get_element_next(mixed, v);
+        sput_fail_unless(v == mjson_get_element(mixed, 6), "");
+        sput_fail_unless(mjson_get_element_next(mixed, v) == NULL, "");
+    }
+}
+
+void mjson_interning_tests()
+{
+    static uint8_t small_bjson[4096];
+
+    int result;
+    mjson_element_t top_element, first, last, key, value;
+    std::string text = "[";
+    char record[128];
+
+    for (int i = 0; i < 50; ++i)
+    {
+        snprintf(record, sizeof(record), "{ \"identifier\": %d, \"category\": \"tools\", \"description\": \"item %d\" }", i, i % 10);
+        text += record;
+    }
+    text += "]";
+
+    // does not fit without interning
+    result = mjson_parse(text.c_str(), text.size(), small_bjson, sizeof(small_bjson), &top_element);
+    sput_fail_if(result, "");
+
+    result = mjson_parse_with_flags(text.c_str(), text.size(), small_bjson, sizeof(small_bjson),
+                                    MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS, &top_element);
+    sput_fail_unless(result, "");
+
+    first = mjson_get_element(top_element, 0);
+    last  = mjson_get_element(top_element, 49);
+
+    sput_fail_unless(mjson_get_int(mjson_get_member(last, "identifier"), 0) == 49, "");
+    sput_fail_unless(strcmp(mjson_get_string(mjson_get_member(last, "description"), ""), "item 9") == 0, "");
+
+    // identical strings share storage
+    sput_fail_unless(mjson_get_string(mjson_get_member(first, "category"), NULL) ==
+                     mjson_get_string(mjson_get_member(last,  "category"), NULL), "");
+
+    key = mjson_get_member_first(last, &value);
+    sput_fail_unless(mjson_get_type(key) == MJSON_ID_UTF8_KEY32, "");
+    sput_fail_unless(strcmp(mjson_get_string(key, ""), "identifier") == 0, "");
+    sput_fail_unless(mjson_get_string(key, NULL) == mjson_get_string(mjson_get_member_first(first, &value), NULL), "");
+}
+
+static int append_to_string(void* user_data, const char* data, size_t size)
+{
+    ((std::string*)user_data)->append(data, size);
+    return 1;
+}
+
+void mjson_write_tests()
+{
+    static const unsigned flags[] = { 0, MJSON_WRITE_PRETTY, MJSON_WRITE_STRICT, MJSON_WRITE_PRETTY | MJSON_WRITE_STRICT };
+    static uint8_t  bjson_text[MAX_BJSON_SIZE];
+    static char     text[64*1024];
+    mjson_element_t top_element, top_element_text;
+    size_t          size, text_size;
+    std::string     sunk;
+
+    // text parses back into identical blob
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+        {
+            memset(bjson, 0, 64*1024);
+            memset(bjson_text, 0, 64*1024);
+            sput_fail_unless(mjson_parse(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), &top_element), "");
+            sput_fail_unless(mjson_write(top_element, flags[f], text, sizeof(text), &text_size), "");
+            sput_fail_unless(strlen(text) == text_size, "");
+            sput_fail_unless(mjson_parse(text, text_size, bjson_text, sizeof(bjson_text), &top_element_text), "");
+
+            // except infinity, which strict JSON can not express
+            if (!(flags[f] & MJSON_WRITE_STRICT) || !strstr(valid_json[i], "E+1423"))
+                sput_fail_unless(memcmp(bjson, bjson_text, 64*1024) == 0, "");
+
+            sunk.clear();
+            sput_fail_unless(mjson_write_sink(top_element, flags[f], append_to_string, &sunk), "");
+            sput_fail_unless(sunk == text, "");
+        }
+    }
+
+    const char* json = "k = { a = [1, -2, 2.5, 1e300, 4294967296, 18446744073709551615], "
+                       "\"b c\" = \"q\\\"\\t\", \"null\" = null, e = {}, f = [] }";
+
+    sput_fail_unless(mjson_parse(json, strlen(json), bjson, sizeof(bjson), &top_element), "");
+
+    sput_fail_unless(mjson_write(top_element, 0, text, sizeof(text), &size), "");
+    sput_fail_unless(strcmp(text, "{k:{a:[1,-2,2.5,1e300,4294967296,18446744073709551615],\"b c\":\"q\\\"\\t\",\"null\":null,e:{},f:[]}}") == 0, "");
+
+    sput_fail_unless(mjson_write(top_element, MJSON_WRITE_STRICT, text, sizeof(text), &size), "");
+    sput_fail_unless(strcmp(text, "{\"k\":{\"a\":[1,-2,2.5,1e300,4294967296,18446744073709551615],\"b c\":\"q\\\"\\t\",\"null\":null,\"e\":{},\"f\":[]}}") == 0, "");
+
+    sput_fail_unless(mjson_write(mjson_get_member(top_element, "k"), MJSON_WRITE_PRETTY, text, sizeof(text), &size), "");
+    sput_fail_unless(strcmp(text,
+        "{\n"
+        "    a: [\n"
+        "        1,\n"
+        "        -2,\n"
+        "        2.5,\n"
+        "        1e300,\n"
+        "        4294967296,\n"
+        "        18446744073709551615\n"
+        "    ],\n"
+        "    \"b c\": \"q\\\"\\t\",\n"
+        "    \"null\": null,\n"
+        "    e: {},\n"
+        "    f: []\n"
+        "}") == 0, "");
+
+    // too small buffer still reports full size
+    sput_fail_unless(mjson_write(top_element, 0, text, sizeof(text), &size), "");
+    sput_fail_unless(mjson_write(top_element, 0, text, size, &text_size), "");
+    sput_fail_if(mjson_write(top_element, 0, text, size - 1, &text_size), "");
+    sput_fail_unless(text_size == size, "");
+    sput_fail_if(mjson_write(top_element, 0, NULL, 0, &text_size), "");
+    sput_fail_unless(text_size == size, "");
+
+    // keys take no escapes, control characters in them are written as is
+    const char* raw_keys = "{\"\nfq/oy\": 1, \"a\tb\": \"\\n\", \"\u00e9\": [] }";
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        memset(bjson, 0, 64*1024);
+        memset(bjson_text, 0, 64*1024);
+        sput_fail_unless(mjson_parse(raw_keys, strlen(raw_keys), bjson, sizeof(bjson), &top_element), "");
+        sput_fail_unless(mjson_write(top_element, flags[f], text, sizeof(text), &text_size), "");
+        sput_fail_unless(mjson_parse(text, text_size, bjson_text, sizeof(bjson_text), &top_element_text), "");
+        sput_fail_unless(memcmp(bjson, bjson_text, 64*1024) == 0, "");
+    }
+
+    // key with quote has no text form
+    mjson_builder_t* builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    void*            storage;
+
+    sput_fail_unless(mjson_builder_begin_dict(builder), "");
+    sput_fail_unless(mjson_builder_key(builder, "a\"b"), "");
+    sput_fail_unless(mjson_builder_null(builder), "");
+    sput_fail_unless(mjson_builder_end(builder), "");
+    sput_fail_unless(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+    sput_fail_if(mjson_write(top_element, 0, text, sizeof(text), &size), "");
+    sput_fail_if(mjson_write_sink(top_element, 0, append_to_string, &sunk), "");
+
+    // shortest text which reads back to the same value
+    const char* numbers = "[0.1, 1.0, -0.0, 1e21, 5e-324, 1.7976931348623157e308, 0.000001, 1e-7, 123456.789, 2.5]";
+
+    sput_fail_unless(mjson_parse(numbers, strlen(numbers), bjson, sizeof(bjson), &top_element), "");
+    sput_fail_unless(mjson_write(top_element, 0, text, sizeof(text), &size), "");
+    sput_fail_unless(strcmp(text, "[0.1,1.0,-0.0,1e21,5e-324,1.7976931348623157e308,0.000001,1e-7,123456.789,2.5]") == 0, "");
+}
+
+static int build_document(mjson_builder_t* builder)
+{
+    int result = 1;
+
+    result &= mjson_builder_begin_dict(builder);
+    result &= mjson_builder_key(builder, "name");    result &= mjson_builder_string(builder, "mjson");
+    result &= mjson_builder_key(builder, "version"); result &= mjson_builder_int(builder, 3);
+    result &= mjson_builder_key(builder, "ratio");   result &= mjson_builder_float(builder, 0.5);
+    result &= mjson_builder_key(builder, "pi");      result &= mjson_builder_float(builder, 3.14159);
+    result &= mjson_builder_key(builder, "big");     result &= mjson_builder_int(builder, 4294967296ll);
+    result &= mjson_builder_key(builder, "min");     result &= mjson_builder_int(builder, -2147483648ll);
+    result &= mjson_builder_key(builder, "huge");    result &= mjson_builder_uint(builder, 18446744073709551615ull);
+    result &= mjson_builder_key(builder, "empty");   result &= mjson_builder_string(builder, "");
+    result &= mjson_builder_key(builder, "ok");      result &= mjson_builder_bool(builder, 1);
+    result &= mjson_builder_key(builder, "no");      result &= mjson_builder_bool(builder, 0);
+    result &= mjson_builder_key(builder, "nothing"); result &= mjson_builder_null(builder);
+    result &= mjson_builder_key(builder, "list");
+    result &= mjson_builder_begin_array(builder);
+    for (int i = 0; i < 20; ++i)
+        result &= mjson_builder_int(builder, -i);
+    result &= mjson_builder_string(builder, "mjson");
+    result &= mjson_builder_begin_array(builder);
+    result &= mjson_builder_end(builder);
+    result &= mjson_builder_begin_dict(builder);
+    result &= mjson_builder_end(builder);
+    result &= mjson_builder_end(builder);
+    result &= mjson_builder_key(builder, "nested");
+    result &= mjson_builder_begin_dict(builder);
+    result &= mjson_builder_key(builder, "name");    result &= mjson_builder_string(builder, "mjson");
+    result &= mjson_builder_end(builder);
+    result &= mjson_builder_end(builder);
+
+    return result;
+}
+
+void mjson_builder_tests()
+{
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS | MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS
+    };
+    const char* json = "{ name = \"mjson\", version = 3, ratio = 0.5, pi = 3.14159, big = 4294967296, "
+                       "min = -2147483648, huge = 18446744073709551615, empty = \"\", ok = true, no = false, "
+                       "nothing = null, list = [0, -1, -2, -3, -4, -5, -6, -7, -8, -9, -10, -11, -12, -13, "
+                       "-14, -15, -16, -17, -18, -19, \"mjson\", [], {}], nested = { name = \"mjson\" } }";
+    test_allocator_t  state = { 0, 0 };
+    mjson_allocator_t allocator = { test_reserve, test_grow, test_release, &state };
+    mjson_builder_t*  builder;
+    mjson_element_t   top_element, top_element_text;
+    void*             storage;
+    void*             storage_text;
+    size_t            size, size_text;
+
+    // same blob as parser produces from equivalent text
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_ex(json, strlen(json), flags[f], NULL, &storage_text, &size_text, &top_element_text), "");
+
+        memset(bjson, 0xcd, 64*1024);
+        builder = mjson_builder_create(bjson, sizeof(bjson), flags[f]);
+        sput_fail_unless(build_document(builder), "");
+        sput_fail_unless(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+        sput_fail_unless(storage == bjson && size == size_text, "");
+        sput_fail_unless(memcmp(storage, storage_text, size) == 0, "");
+        sput_fail_unless(mjson_validate_blob(storage, size), "");
+
+        // only one top element, failed builder releases storage
+        builder = mjson_builder_create_ex(flags[f], &allocator);
+        sput_fail_unless(build_document(builder), "");
+        sput_fail_if(mjson_builder_begin_array(builder), "");
+        sput_fail_if(mjson_builder_end(builder), "");
+        sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+        sput_fail_unless(storage == NULL && size == 0 && top_element == NULL, "");
+
+        builder = mjson_builder_create_ex(flags[f], &allocator);
+        sput_fail_unless(mjson_builder_begin_array(builder), "");
+        for (int i = 0; i < 200; ++i)
+            sput_fail_unless(build_document(builder), "");
+        sput_fail_unless(mjson_builder_end(builder), "");
+        sput_fail_unless(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+        sput_fail_unless(mjson_validate_blob(storage, size), "");
+        sput_fail_unless(mjson_get_array_length(top_element) == 200, "");
+        sput_fail_unless(strcmp(mjson_get_string(mjson_get_member(mjson_get_element(top_element, 199), "name"), ""), "mjson") == 0, "");
+        allocator.release(allocator.user_data, storage, size);
+
+        free(storage_text);
+    }
+
+    sput_fail_unless(state.grows > 0, "");
+    sput_fail_unless(state.live == 0, "");
+
+    // calls out of order fail and failure sticks
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_if(mjson_builder_int(builder, 1), "");
+    sput_fail_if(mjson_builder_begin_dict(builder), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_dict(builder), "");
+    sput_fail_if(mjson_builder_int(builder, 1), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_dict(builder), "");
+    sput_fail_unless(mjson_builder_key(builder, "a"), "");
+    sput_fail_if(mjson_builder_key(builder, "b"), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_array(builder), "");
+    sput_fail_if(mjson_builder_key(builder, "a"), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_dict(builder), "");
+    sput_fail_unless(mjson_builder_key(builder, "a"), "");
+    sput_fail_if(mjson_builder_end(builder), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_array(builder), "");
+    sput_fail_if(mjson_builder_float(builder, 0.0 / 0.0), "");
+    sput_fail_if(mjson_builder_end(builder), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    builder = mjson_builder_create(bjson, sizeof(bjson), 0);
+    sput_fail_unless(mjson_builder_begin_array(builder), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+
+    // fixed storage is not grown
+    builder = mjson_builder_create(bjson, 64, 0);
+    sput_fail_unless(mjson_builder_begin_array(builder), "");
+    sput_fail_if(mjson_builder_string(builder, "does not fit into 64 bytes of storage together with fourcc"), "");
+    sput_fail_if(mjson_builder_finish(builder, &storage, &size, &top_element), "");
+}
+
+static void append_u32(std::vector<uint32_t>& blob, uint32_t value)
+{
+    blob.push_back(value);
+}
+
+static void append_u64(std::vector<uint32_t>& blob, uint64_t value)
+{
+    blob.push_back((uint32_t)value);
+    blob.push_back((uint32_t)(value >> 32));
+}
+
+// Parser only emits *64 entries for sizes over 4 GB, so blob is built by hand
+void mjson_wide_entry_tests()
+{
+    std::vector<uint32_t> blob;
+    mjson_element_t       top_element, key, value;
+    size_t                size;
+    static char           text[256];
+
+    append_u32(blob, 0x32334a42); // fourcc
+    append_u32(blob, MJSON_ID_DICT64);        append_u64(blob, 56);
+    append_u32(blob, MJSON_ID_UTF8_KEY64);    append_u64(blob, 3);  append_u32(blob, 'k' | 'e' << 8 | 'y' << 16);
+    append_u32(blob, MJSON_ID_ARRAY64);       append_u64(blob, 28);
+    append_u32(blob, MJSON_ID_UTF8_STRING64); append_u64(blob, 4);  append_u32(blob, 'w' | 'i' << 8 | 'd' << 16 | 'e' << 24); append_u32(blob, 0);
+    append_u32(blob, MJSON_ID_SINT32);        append_u32(blob, 7);
+
+    size = blob.size() * sizeof(uint32_t);
+
+    sput_fail_unless(mjson_validate_blob(blob.data(), size), "");
+
+    top_element = mjson_get_top_element(blob.data(), size);
+    sput_fail_unless(mjson_get_type(top_element) == MJSON_ID_DICT64, "");
+
+    key = mjson_get_member_first(top_element, &value);
+    sput_fail_unless(strcmp(mjson_get_string(key, ""), "key") == 0, "");
+    sput_fail_unless(mjson_get_type(value) == MJSON_ID_ARRAY64, "");
+    sput_fail_unless(mjson_get_member_next(top_element, key, &value) == NULL, "");
+    sput_fail_unless(mjson_get_member(top_element, "key") == value, "");
+
+    sput_fail_unless(mjson_get_array_length(value) == 2, "");
+    sput_fail_unless(strcmp(mjson_get_string(mjson_get_element(value, 0), ""), "wide") == 0, "");
+    sput_fail_unless(mjson_get_int(mjson_get_element(value, 1), 0) == 7, "");
+
+    sput_fail_unless(mjson_write(top_element, 0, text, sizeof(text), &size), "");
+    sput_fail_unless(strcmp(text, "{key:[\"wide\",7]}") == 0, "");
+
+    // size past the end, string without terminator, table on 64 bit container
+    blob[2] = 60;
+    sput_fail_if(mjson_validate_blob(blob.data(), blob.size() * sizeof(uint32_t)), "");
+    blob[2] = 56;
+    blob[15] = 'x';
+    sput_fail_if(mjson_validate_blob(blob.data(), blob.size() * sizeof(uint32_t)), "");
+    blob[15] = 0;
+    sput_fail_unless(mjson_validate_blob(blob.data(), blob.size() * sizeof(uint32_t)), "");
+    blob[1] |= 0x100;
+    sput_fail_if(mjson_validate_blob(blob.data(), blob.size() * sizeof(uint32_t)), "");
+}
+
+void mjson_path_tests()
+{
+    static const char* text =
+        "a = { b = [ 10, { c = \"x\", \"d.e\" = 1 }, [5, 6] ] }\n"
+        "\"x/y\" = 2, \"m~n\" = 3, \"\" = 4, \"0\" = 5, \"-\" = 6, arr = []\n";
+    static const struct { const char* path; int value; } found[] = {
+        { "a.b[0]",     10 },
+        { "a.b[2][1]",  6  },
+        { "/a/b/0",     10 },
+        { "/a/b/2/1",   6  },
+        { "/a/b/1/d.e", 1  },
+        { "/x~1y",      2  },
+        { "/m~0n",      3  },
+        { "/",          4  },
+        { "/0",         5  },
+        { "0",          5  },
+        { "/-",         6  },
+    };
+    static const char* missing[] = {
+        "a.b[3]", "a.b.c", "a[0]", "/a/b/01", "/a/b/-", "/a/b/3", "arr[0]", "a.b[0].c", "/a//b", "zz"
+    };
+    static const char* invalid[] = {
+        "a..b", "a.", ".a", "a[", "a[x]", "a[01]", "a[]", "a]", "a[0]b", "a.[0]", "a[1234567890]", "/a~2", "/a~"
+    };
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS | MJSON_PARSE_INTERN_KEYS
+    };
+    mjson_element_t top_element;
+    mjson_path_t*   path;
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_with_flags(text, strlen(text), bjson, sizeof(bjson), flags[f], &top_element), "");
+
+        for (int i = 0; i < ARRAY_SIZE(found); ++i)
+        {
+            path = mjson_path_compile(found[i].path);
+            sput_fail_unless(path != NULL, found[i].path);
+            sput_fail_unless(mjson_get_int(mjson_path_eval(top_element, path), 0) == found[i].value, found[i].path);
+            mjson_path_free(path);
+        }
+
+        for (int i = 0; i < ARRAY_SIZE(missing); ++i)
+        {
+            path = mjson_path_compile(missing[i]);
+            sput_fail_unless(path != NULL, missing[i]);
+            sput_fail_unless(mjson_path_eval(top_element, path) == NULL, missing[i]);
+            mjson_path_free(path);
+        }
+
+        // same query is reused on nested element and gives same result as accessors
+        path = mjson_path_compile("b[1].c");
+        sput_fail_unless(strcmp(mjson_get_string(mjson_path_eval(mjson_get_member(top_element, "a"), path), ""), "x") == 0, "");
+        sput_fail_unless(mjson_path_eval(mjson_get_member(top_element, "a"), path) ==
+                         mjson_get_member(mjson_get_element(mjson_get_member(mjson_get_member(top_element, "a"), "b"), 1), "c"), "");
+        sput_fail_unless(mjson_path_eval(top_element, path) == NULL, "");
+        sput_fail_unless(mjson_path_eval(NULL, path) == NULL, "");
+        mjson_path_free(path);
+
+        path = mjson_path_compile("");
+        sput_fail_unless(mjson_path_eval(top_element, path) == top_element, "");
+        mjson_path_free(path);
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(invalid); ++i)
+        sput_fail_unless(mjson_path_compile(invalid[i]) == NULL, invalid[i]);
+
+    sput_fail_unless(mjson_path_compile(NULL) == NULL, "");
+    sput_fail_unless(mjson_path_eval(top_element, NULL) == NULL, "");
+}
+
+// Compares on-demand view of text with parsed blob, returns number of mismatches
+static int compare_lazy(mjson_lazy_t lazy, mjson_element_t element)
+{
+    mjson_element_t key, value;
+    char            buf[256];
+    int             type = mjson_get_type(element);
+    int             mismatches = mjson_lazy_get_type(lazy) != type;
+
+    switch (type)
+    {
+        case MJSON_ID_DICT32:
+            for (key = mjson_get_member_first(element, &value); key; key = mjson_get_member_next(element, key, &value))
+                mismatches += compare_lazy(mjson_lazy_get_member(lazy, mjson_get_string(key, "")), mjson_get_member(element, mjson_get_string(key, "")));
+            break;
+
+        case MJSON_ID_ARRAY32:
+            for (int i = 0; i < mjson_get_array_length(element); ++i)
+                mismatches += compare_lazy(mjson_lazy_get_element(lazy, i), mjson_get_element(element, i));
+            mismatches += mjson_lazy_get_element(lazy, mjson_get_array_length(element)).begin != NULL;
+            break;
+
+        case MJSON_ID_UTF8_STRING32:
+            mismatches += strcmp(mjson_lazy_get_string(lazy, buf, sizeof(buf), "?"), mjson_get_string(element, "")) != 0;
+            break;
+
+        default:
+            mismatches += mjson_lazy_get_int64(lazy, 7) != mjson_get_int64(element, 7);
+            mismatches += mjson_lazy_get_uint64(lazy, 7) != mjson_get_uint64(element, 7);
+            mismatches += mjson_lazy_get_double(lazy, 7) != mjson_get_double(element, 7);
+            mismatches += mjson_lazy_get_bool(lazy, 7) != mjson_get_bool(element, 7);
+            mismatches += mjson_lazy_is_null(lazy) != mjson_is_null(element);
+            break;
+    }
+
+    return mismatches;
+}
+
+void mjson_lazy_tests()
+{
+    static const char* text =
+        "// settings\n"
+        "skip = { deep = [ \"]}\\\"\", /* ] */ { x = [[[]]] } ] }\n"
+        "name = \"caf\\u00e9\"\n"
+        "list = [ 1, -2, 3.5, 0x10, true, null, { k = \"v\" } ]\n"
+        "broken = [ 1 2 }\n";
+    mjson_element_t top_element, nested;
+    mjson_lazy_t    top, list;
+    char            buf[16];
+
+    for (int i = 0; i < ARRAY_SIZE(valid_json); ++i)
+    {
+        sput_fail_unless(mjson_parse(valid_json[i], strlen(valid_json[i]), bjson, sizeof(bjson), &top_element), "");
+        sput_fail_unless(compare_lazy(mjson_lazy_open(valid_json[i], strlen(valid_json[i])), top_element) == 0, valid_json[i]);
+    }
+
+    top  = mjson_lazy_open(text, strlen(text));
+    list = mjson_lazy_get_member(top, "list");
+
+    sput_fail_unless(mjson_lazy_get_type(top) == MJSON_ID_DICT32, "");
+    sput_fail_unless(mjson_lazy_get_type(list) == MJSON_ID_ARRAY32, "");
+    sput_fail_unless(strcmp(mjson_lazy_get_string(mjson_lazy_get_member(top, "name"), buf, sizeof(buf), ""), "caf\xc3\xa9") == 0, "");
+    sput_fail_unless(strcmp(mjson_lazy_get_string(mjson_lazy_get_member(top, "name"), buf, 5, "small"), "small") == 0, "");
+    sput_fail_unless(strcmp(mjson_lazy_get_string(list, buf, sizeof(buf), "none"), "none") == 0, "");
+
+    sput_fail_unless(mjson_lazy_get_int(mjson_lazy_get_element(list, 1), 0) == -2, "");
+    sput_fail_unless(mjson_lazy_get_double(mjson_lazy_get_element(list, 2), 0) == 3.5, "");
+    sput_fail_unless(mjson_lazy_get_type(mjson_lazy_get_element(list, 3)) == MJSON_ID_SINT32, "");
+    sput_fail_unless(mjson_lazy_get_int(mjson_lazy_get_element(list, 3), 0) == 16, "");
+    sput_fail_unless(mjson_lazy_get_bool(mjson_lazy_get_element(list, 4), 0), "");
+    sput_fail_unless(mjson_lazy_is_null(mjson_lazy_get_element(list, 5)), "");
+    sput_fail_unless(!mjson_lazy_is_null(mjson_lazy_get_element(list, 4)), "");
+    sput_fail_unless(mjson_lazy_is_null(mjson_lazy_get_element(list, 7)), "");
+    sput_fail_unless(mjson_lazy_get_int(mjson_lazy_get_element(list, 0), 5) == 1, "");
+    sput_fail_unless(mjson_lazy_get_int(mjson_lazy_get_element(list, 2), 5) == 5, "");
+
+    // commas are optional, lookup stops at first token which is not a value
+    sput_fail_unless(mjson_lazy_get_member(top, "missing").begin == NULL, "");
+    sput_fail_unless(mjson_lazy_get_element(mjson_lazy_get_member(top, "broken"), 0).begin != NULL, "");
+    sput_fail_unless(mjson_lazy_get_element(mjson_lazy_get_member(top, "broken"), 1).begin != NULL, "");
+    sput_fail_unless(mjson_lazy_get_element(mjson_lazy_get_member(top, "broken"), 2).begin == NULL, "");
+    sput_fail_unless(mjson_lazy_get_member(top, "name").begin != NULL, "");
+    sput_fail_unless(mjson_lazy_get_member(list, "name").begin == NULL, "");
+    sput_fail_unless(mjson_lazy_get_element(top, 0).begin == NULL, "");
+
+    // container is parsed into blob for regular accessors
+    sput_fail_unless(mjson_lazy_parse(mjson_lazy_get_member(top, "skip"), bjson, sizeof(bjson), MJSON_PARSE_HASH_DICTS, &top_element), "");
+    nested = mjson_get_element(mjson_get_member(top_element, "deep"), 0);
+    sput_fail_unless(strcmp(mjson_get_string(nested, ""), "]}\"") == 0, "");
+    sput_fail_unless(mjson_lazy_parse(list, bjson, sizeof(bjson), 0, &top_element), "");
+    sput_fail_unless(mjson_get_array_length(top_element) == 7, "");
+    sput_fail_if(mjson_lazy_parse(mjson_lazy_get_element(list, 0), bjson, sizeof(bjson), 0, &top_element), "");
+    sput_fail_if(mjson_lazy_parse(top, bjson, sizeof(bjson), 0, &top_element), "");
+    sput_fail_unless(top_element == NULL, "");
+}
+
+// Cursor must visit the same elements as checked iteration
+static void compare_cursor(mjson_element_t element)
+{
+    mjson_cursor_t  cursor;
+    mjson_element_t item, key, value;
+    int             container = mjson_cursor_enter(&cursor, element);
+
+    if (mjson_get_type(element) == MJSON_ID_DICT32 || mjson_get_type(element) == MJSON_ID_DICT64)
+    {
+        sput_fail_unless(container, "");
+        for (key = mjson_get_member_first(element, &value); key; key = mjson_get_member_next(element, key, &value))
+        {
+            sput_fail_if(mjson_cursor_at_end(&cursor), "");
+            sput_fail_unless(mjson_cursor_key(&cursor) == key, "");
+            sput_fail_unless(mjson_cursor_value(&cursor) == value, "");
+            compare_cursor(value);
+            mjson_cursor_next(&cursor);
+        }
+    }
+    else if (mjson_get_type(element) == MJSON_ID_ARRAY32 || mjson_get_type(element) == MJSON_ID_ARRAY64)
+    {
+        sput_fail_unless(container, "");
+        for (item = mjson_get_element_first(element); item; item = mjson_get_element_next(element, item))
+        {
+            sput_fail_if(mjson_cursor_at_end(&cursor), "");
+            sput_fail_unless(mjson_cursor_key(&cursor) == NULL, "");
+            sput_fail_unless(mjson_cursor_value(&cursor) == item, "");
+            compare_cursor(item);
+            mjson_cursor_next(&cursor);
+        }
+    }
+    else
+    {
+        sput_fail_if(container, "");
+    }
+
+    sput_fail_unless(mjson_cursor_at_end(&cursor), "");
+}
+
+void mjson_cursor_tests()
+{
+    static const char* json =
+        "a = 1, b = -5000000000, c = 0.1, d = \"str\", e = \"\", f = [1, [2, {x = \"str\"}], \"str\", {}, []],\n"
+        "g = { x = \"str\", y = [ { x = true, \"str\" = null } ] }, h = {}, i = []";
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS | MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS
+    };
+    mjson_element_t       top_element;
+    mjson_cursor_t        cursor;
+    std::vector<uint32_t> blob;
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_with_flags(json, strlen(json), bjson, sizeof(bjson), flags[f], &top_element), "");
+        compare_cursor(top_element);
+    }
+
+    sput_fail_if(mjson_cursor_enter(&cursor, NULL), "");
+    sput_fail_unless(mjson_cursor_at_end(&cursor), "");
+
+    // 64 bit entries, the same blob as in mjson_wide_entry_tests
+    append_u32(blob, 0x32334a42);
+    append_u32(blob, MJSON_ID_DICT64);        append_u64(blob, 56);
+    append_u32(blob, MJSON_ID_UTF8_KEY64);    append_u64(blob, 3);  append_u32(blob, 'k' | 'e' << 8 | 'y' << 16);
+    append_u32(blob, MJSON_ID_ARRAY64);       append_u64(blob, 28);
+    append_u32(blob, MJSON_ID_UTF8_STRING64); append_u64(blob, 4);  append_u32(blob, 'w' | 'i' << 8 | 'd' << 16 | 'e' << 24); append_u32(blob, 0);
+    append_u32(blob, MJSON_ID_SINT32);        append_u32(blob, 7);
+
+    compare_cursor(mjson_get_top_element(blob.data(), blob.size() * sizeof(uint32_t)));
+}
+
+void mjson_cpp_key_tests()
+{
+    using namespace mj::literals;
+
+    static const char* json = "width = 640, height = 480, \"wid\" = 1, nested = { \"a b\" = [7, 8] }, \"\" = 9";
+    static const unsigned flags[] = { 0, MJSON_PARSE_HASH_DICTS, MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INTERN_KEYS };
+    mjson_element_t top_element;
+
+    static_assert(mj::hash_key("a", 1) == 0xe40c292cu, "");
+    constexpr mj::key_t width = "width"_key;
+    static_assert(width.len == 5, "");
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_with_flags(json, strlen(json), bjson, sizeof(bjson), flags[f], &top_element), "");
+
+        mj::value top(top_element);
+
+        sput_fail_unless(mjson_get_int(top[width].element(), 0) == 640, "");
+        sput_fail_unless(mjson_get_int(top["height"_key].element(), 0) == 480, "");
+        sput_fail_unless(mjson_get_int(top["wid"_key].element(), 0) == 1, "");
+        sput_fail_unless(mjson_get_int(top[""_key].element(), 0) == 9, "");
+        sput_fail_unless(mjson_get_int(top["nested"_key]["a b"_key][1].element(), 0) == 8, "");
+        sput_fail_if(top["widt"_key], "");
+        sput_fail_if(top["depth"_key]["x"_key], "");
+        sput_fail_if(top[0], "");
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+        sput_fail_unless(mjson_get_int(top[mj::key<"width">].element(), 0) == 640, "");
+        sput_fail_unless(mjson_get_int(top[mj::key<"nested">][mj::key<"a b">][0].element(), 0) == 7, "");
+#endif
+
+        // hash matches the one stored in dictionary tables
+        sput_fail_unless(mjson_get_member_hashed(top_element, "width", 5, mj::hash_key("width", 5)) == mjson_get_member(top_element, "width"), "");
+    }
+}
+
+// Views must visit the same elements as C iteration
+static void compare_views(mj::value element)
+{
+    mjson_element_t item, key, value;
+
+    if (mjson_get_type(element.element()) == MJSON_ID_ARRAY32 || mjson_get_type(element.element()) == MJSON_ID_ARRAY64)
+    {
+        item = mjson_get_element_first(element.element());
+        for (mj::value v : element.array())
+        {
+            sput_fail_unless(v.element() == item, "");
+            compare_views(v);
+            item = mjson_get_element_next(element.element(), item);
+        }
+        sput_fail_unless(item == NULL, "");
+    }
+    else if (mjson_get_type(element.element()) == MJSON_ID_DICT32 || mjson_get_type(element.element()) == MJSON_ID_DICT64)
+    {
+        key = mjson_get_member_first(element.element(), &value);
+        for (mj::member m : element.dict())
+        {
+            sput_fail_unless(key && m.key == mjson_get_string(key, NULL), "");
+            sput_fail_unless(m.val.element() == value, "");
+            compare_views(m.val);
+            key = mjson_get_member_next(element.element(), key, &value);
+        }
+        sput_fail_unless(key == NULL, "");
+    }
+    else if (mjson_get_string(element.element(), NULL))
+    {
+        // C string ends at embedded zero
+        sput_fail_unless(strcmp(element.string().data(), mjson_get_string(element.element(), NULL)) == 0, "");
+    }
+}
+
+void mjson_cpp_view_tests()
+{
+    using namespace mj::literals;
+
+    static const char* json =
+        "u = 7, s = -7, big = 5000000000, neg = -5000000000, huge = 18446744073709551615, f = 0.5, d = 0.1,\n"
+        "t = true, n = null, str = \"a\\u0000b\", empty = \"\", arr = [1, [2, {x = \"str\"}], \"str\", {}, []],\n"
+        "obj = { x = \"str\", y = [ { x = 1 } ] }";
+    static const unsigned flags[] = {
+        0,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS,
+        MJSON_PARSE_HASH_DICTS | MJSON_PARSE_INDEX_ARRAYS | MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS
+    };
+    mjson_element_t top_element;
+
+    for (int f = 0; f < ARRAY_SIZE(flags); ++f)
+    {
+        sput_fail_unless(mjson_parse_with_flags(json, strlen(json), bjson, sizeof(bjson), flags[f], &top_element), "");
+
+        mj::value top(top_element);
+
+        compare_views(top);
+
+        sput_fail_unless(top["u"_key].get<int>() == 7, "");
+        sput_fail_unless(top["u"_key].get<uint8_t>() == 7, "");
+        sput_fail_unless(top["u"_key].get<double>() == 7.0, "");
+        sput_fail_unless(top["s"_key].get<int>() == -7, "");
+        sput_fail_unless(top["s"_key].get<unsigned>(1) == 1, "");
+        sput_fail_unless(top["big"_key].get<int64_t>() == 5000000000ll, "");
+        sput_fail_unless(top["big"_key].get<int32_t>(3) == 3, "");
+        sput_fail_unless(top["neg"_key].get<int64_t>() == -5000000000ll, "");
+        sput_fail_unless(top["neg"_key].get<uint64_t>(3) == 3, "");
+        sput_fail_unless(top["huge"_key].get<uint64_t>() == 18446744073709551615ull, "");
+        sput_fail_unless(top["huge"_key].get<int64_t>(3) == 3, "");
+        sput_fail_unless(top["f"_key].get<float>() == 0.5f, "");
+        sput_fail_unless(top["d"_key].get<double>() == 0.1, "");
+        sput_fail_unless(top["d"_key].get<int>(3) == 3, "");
+        sput_fail_unless(top["t"_key].get<bool>(), "");
+        sput_fail_unless(top["t"_key].get<int>(3) == 3, "");
+        sput_fail_unless(top["n"_key].is_null() && top["missing"_key].is_null(), "");
+        sput_fail_unless(top["missing"_key].get<int>(3) == 3, "");
+
+        // length comes from entry, so embedded zero is kept
+        sput_fail_unless(top["str"_key].string() == std::string_view("a\0b", 3), "");
+        sput_fail_unless(top["empty"_key].string("x") == "", "");
+        sput_fail_unless(top["u"_key].string("x") == "x", "");
+
+        sput_fail_unless(top["arr"_key].array().size() == 5, "");
+        sput_fail_unless(top["arr"_key][1].array()[1].dict()["x"_key].string() == "str", "");
+        sput_fail_unless(top["arr"_key].array()[3].dict().empty(), "");
+        sput_fail_unless(top["arr"_key].dict().empty() && top["obj"_key].array().empty(), "");
+        sput_fail_unless(top["u"_key].array().begin() == top["u"_key].array().end(), "");
+    }
+
+    // 64 bit entries, the same blob as in mjson_wide_entry_tests
+    std::vector<uint32_t> blob;
+
+    append_u32(blob, 0x32334a42);
+    append_u32(blob, MJSON_ID_DICT64);        append_u64(blob, 56);
+    append_u32(blob, MJSON_ID_UTF8_KEY64);    append_u64(blob, 3);  append_u32(blob, 'k' | 'e' << 8 | 'y' << 16);
+    append_u32(blob, MJSON_ID_ARRAY64);       append_u64(blob, 28);
+    append_u32(blob, MJSON_ID_UTF8_STRING64); append_u64(blob, 4);  append_u32(blob, 'w' | 'i' << 8 | 'd' << 16 | 'e' << 24); append_u32(blob, 0);
+    append_u32(blob, MJSON_ID_SINT32);        append_u32(blob, 7);
+
+    mj::value wide(mjson_get_top_element(blob.data(), blob.size() * sizeof(uint32_t)));
+
+    compare_views(wide);
+    for (mj::member m : wide.dict())
+    {
+        sput_fail_unless(m.key == "key", "");
+        sput_fail_unless(m.val.array()[0].string() == "wide", "");
+        sput_fail_unless(m.val.array()[1].get<int>() == 7, "");
+    }
+}
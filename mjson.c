@@ -1,8 +1,46 @@
 /* Generated by re2c 0.13.6 on Sat Nov 09 13:49:31 2013 */
 #include <assert.h>
+#include <float.h>
 #include <memory.h>
+#include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <time.h>
+
+#if !defined(MJSON_NO_SIMD)
+#   if defined(__AVX2__)
+#       include <immintrin.h>
+#       define MJSON_AVX2 1
+#   elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#       include <emmintrin.h>
+#       define MJSON_SSE2 1
+#   elif defined(__aarch64__) || defined(_M_ARM64)
+#       include <arm_neon.h>
+#       define MJSON_NEON 1
+#   endif
+#endif
+
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+#if !defined(MJSON_NO_MMAP) && (defined(__unix__) || defined(__APPLE__))
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#   define MJSON_MMAP 1
+#endif
+
+#if !defined(MJSON_NO_THREADS) && defined(_WIN32)
+#   include <windows.h>
+#   define MJSON_THREADS 1
+#elif !defined(MJSON_NO_THREADS) && (defined(__unix__) || defined(__APPLE__))
+#   include <pthread.h>
+#   include <unistd.h>
+#   define MJSON_THREADS 1
+#endif
 
 #include "mjson.h"
 
@@ -39,6 +77,211 @@ struct _mjson_parser_t
     uint8_t* end;
     uint8_t* bjson;
     uint8_t* bjson_limit;
+    struct _mjson_index_t* index;
+    unsigned flags;
+    uint8_t* bjson_start;
+    struct _mjson_intern_t* intern;
+    int partial;
+    int hit_end;
+    const mjson_allocator_t* allocator;
+#if defined(MJSON_STATS)
+    mjson_parse_stats_t* stats;
+    int depth;
+#endif
+};
+
+// Container which is still open in the streaming parser
+enum
+{
+    FRAME_FIRST,        // at first member: value, key or closing token
+    FRAME_NEXT,         // after member: separator is allowed too
+    FRAME_AFTER_COMMA,  // value or key must follow
+    FRAME_COLON,        // dictionary key was read
+    FRAME_VALUE         // dictionary value must follow
+};
+
+struct _mjson_frame_t
+{
+    size_t    offset;       // container entry offset from blob start
+    int       is_dict;
+    int       stop_token;
+    int       state;
+};
+
+// Streaming parser, tokens split between chunks are accumulated in carry
+struct _mjson_stream_t
+{
+    struct _mjson_parser_t  context;
+    struct _mjson_intern_t* intern;
+    struct _mjson_frame_t*  stack;
+    int                     depth;
+    int                     stack_capacity;
+    uint8_t*                carry;
+    size_t                  carry_size;
+    size_t                  carry_capacity;
+    int                     done;       // top element is closed
+    int                     finished;   // end of input token was seen
+    int                     failed;
+};
+
+// Container which is still open in mjson_validate_blob
+struct _mjson_check_t
+{
+    const uint8_t*  end;        // end of container data, table follows it
+    mjson_element_t container;
+    mjson_element_t table;
+    size_t          count;      // elements seen so far
+};
+
+// Programmatic construction reuses container stack of streaming parser
+struct _mjson_builder_t
+{
+    struct _mjson_stream_t  stream;
+};
+
+#define BUILDER_INITIAL_SIZE 4096
+
+#define VALIDATE_STACK_SIZE  32
+
+#define WRITE_CHUNK_SIZE     4096
+#define WRITE_INDENT         4
+
+#if defined(MJSON_THREADS)
+struct _mjson_thread_t
+{
+#if defined(_WIN32)
+    HANDLE             handle;
+#else
+    pthread_t          handle;
+#endif
+    void             (*func)(void* arg);
+    void*              arg;
+};
+
+#if defined(_WIN32)
+typedef CRITICAL_SECTION mjson_mutex_t;
+#else
+typedef pthread_mutex_t  mjson_mutex_t;
+#endif
+#endif
+
+// Slice of top level array which mjson_parse_parallel parses on its own:
+// elements from begin up to and including separator comma at end, or up to
+// closing bracket of the array for the last one. Output holds elements
+// only, which are position independent and are copied into final blob.
+struct _mjson_segment_t
+{
+    const uint8_t*           begin;
+    const uint8_t*           end;
+    int                      last;
+    unsigned                 flags;
+    const mjson_allocator_t* allocator;
+    uint8_t*                 storage;
+    size_t                   capacity;
+    size_t                   size;
+    int                      parsed;
+};
+
+// Input per thread below which mjson_parse_parallel does not split
+#ifndef MJSON_PARALLEL_MIN_SEGMENT
+#define MJSON_PARALLEL_MIN_SEGMENT (1 << 20)
+#endif
+
+#define PARALLEL_MAX_THREADS 64
+#define PARALLEL_SCAN_WINDOW (64 << 10)
+
+#if defined(MJSON_THREADS)
+// Items [next, end) still owned by pool worker. Owner takes them from the
+// front, idle workers steal upper half from the back, so lock is contended
+// only while stealing. Padding keeps workers on separate cache lines.
+struct _mjson_worker_t
+{
+    mjson_mutex_t           lock;
+    size_t                  next;
+    size_t                  end;
+    struct _mjson_pool_t*   pool;
+    int                     index;
+    struct _mjson_thread_t  thread;
+    uint8_t                 padding[64];
+};
+
+struct _mjson_pool_t
+{
+    struct _mjson_worker_t  workers[PARALLEL_MAX_THREADS];
+    int                     count;
+    void                  (*func)(void* arg, size_t item);
+    void*                   arg;
+};
+#endif
+
+// Arguments of mjson_parse_batch shared by workers, each document is
+// written only by worker which parses it
+struct _mjson_batch_t
+{
+    mjson_document_t*        documents;
+    unsigned                 flags;
+    const mjson_allocator_t* allocator;
+};
+
+// Step of compiled path. Key is used on dictionaries and index on arrays,
+// JSON Pointer segments which are valid indices have both.
+struct _mjson_path_segment_t
+{
+    const char*        key;        // NULL for [index]
+    size_t             len;
+    uint32_t           hash;
+    int                index;      // -1 if not an index
+};
+
+// Segments and unescaped keys follow header in the same block
+struct _mjson_path_t
+{
+    size_t                        count;
+    struct _mjson_path_segment_t* segments;
+};
+
+#define PATH_MAX_INDEX_DIGITS 9
+
+// Output of mjson_write, text goes to window [buf, end) which is either
+// caller buffer or chunk handed to sink when full.
+struct _mjson_writer_t
+{
+    uint8_t*           pos;
+    uint8_t*           end;
+    uint8_t*           buf;
+    size_t             flushed;    // bytes before buf
+    mjson_write_func_t sink;
+    void*              user_data;
+    unsigned           flags;
+    int                depth;
+    int                overflow;   // caller buffer is full, only counting
+    int                failed;     // sink refused data
+    uint8_t            chunk[WRITE_CHUNK_SIZE];
+};
+
+#define INDEX_BLOCK_SIZE     64
+#define INDEX_CAPACITY       2048
+
+// Structural index state used by mjson_parse_indexed, stage one fills
+// positions of tokens starts, stage two consumes them in order.
+struct _mjson_index_t
+{
+    uint8_t*  positions[INDEX_CAPACITY];
+    int       count;
+    int       current;
+    uint8_t*  scan;
+    uint64_t  prev_in_string;
+    uint64_t  prev_escaped;
+    uint64_t  prev_scalar;
+};
+
+#define INTERN_CACHE_SIZE    1024
+#define INTERN_MAX_STRING    32
+
+// Offsets of recently emitted strings from the blob start, indexed by hash
+struct _mjson_intern_t
+{
+    size_t    offsets[INTERN_CACHE_SIZE];
 };
 
 struct _mjson_entry_t
@@ -52,622 +295,4156 @@ struct _mjson_entry_t
     };
 };
 
+// Low byte of entry id is BJSON type, container with MJSON_FLAG_TABLE set is
+// followed by BINARY32 lookup table which is not included in its val_u32.
+// String with MJSON_FLAG_REF has no data, val_u32 is backward offset to
+// identical string emitted earlier.
+#define MJSON_ID_MASK     0xff
+#define MJSON_FLAG_TABLE  0x100
+#define MJSON_FLAG_REF    0x200
+
+// Strings and containers longer than this are stored with *64 ids, 64 bit
+// size follows id directly like payload of 64 bit numbers. Such containers
+// have no lookup table. Lowered only to test these entries on small input.
+#ifndef MJSON_MAX_SIZE32
+#define MJSON_MAX_SIZE32  0xffffffffu
+#endif
+
+// *64 variant of string, binary or container id
+#define MJSON_IS_ID64(type) ((type) >= MJSON_ID_UTF8_KEY32 && ((type) & 1))
+
+// Interned string references farther back are not made, so widening of
+// enclosing containers can not overflow them
+#define INTERN_MAX_DISTANCE  0x7fffffffu
+
+#define MJSON_FOURCC      '23JB'
+
 #define RETURN_VAL_IF_FAIL(cond, val) if (!(cond)) return (val)
 #define RETURN_IF_FAIL(cond) if (!(cond)) return
 #define MAX_UTF8_CHAR_LEN 6
 #define TRUE  1
 #define FALSE 0
 
+// Parse statistics hooks, compiled out unless MJSON_STATS is defined.
+// STATS_START has to be the last declaration of the block.
+#if defined(MJSON_STATS)
+#   define STATS_START(ctx)         uint64_t stats_start = (ctx)->stats ? stats_clock() : 0
+#   define STATS_TICKS(ctx, field)  do { if ((ctx)->stats) (ctx)->stats->field += stats_clock() - stats_start; } while (0)
+#   define STATS_ADD(ctx, field, n) do { if ((ctx)->stats) (ctx)->stats->field += (n); } while (0)
+#   define STATS_ENTER(ctx)         do { if ((ctx)->stats && ++(ctx)->depth > (ctx)->stats->max_depth) (ctx)->stats->max_depth = (ctx)->depth; } while (0)
+#   define STATS_LEAVE(ctx)         do { --(ctx)->depth; } while (0)
+#else
+#   define STATS_START(ctx)
+#   define STATS_TICKS(ctx, field)  ((void)0)
+#   define STATS_ADD(ctx, field, n) ((void)0)
+#   define STATS_ENTER(ctx)         ((void)0)
+#   define STATS_LEAVE(ctx)         ((void)0)
+#endif
+
 typedef struct _mjson_parser_t  mjson_parser_t;
 typedef struct _mjson_entry_t   mjson_entry_t;
+typedef struct _mjson_index_t   mjson_index_t;
+typedef struct _mjson_intern_t  mjson_intern_t;
+typedef struct _mjson_frame_t   mjson_frame_t;
+typedef struct _mjson_check_t   mjson_check_t;
+typedef struct _mjson_writer_t  mjson_writer_t;
+typedef struct _mjson_thread_t  mjson_thread_t;
+typedef struct _mjson_segment_t mjson_segment_t;
+typedef struct _mjson_worker_t  mjson_worker_t;
+typedef struct _mjson_pool_t    mjson_pool_t;
+typedef struct _mjson_batch_t   mjson_batch_t;
+typedef struct _mjson_path_segment_t mjson_path_segment_t;
 
 static void* parsectx_allocate_output(mjson_parser_t* ctx, ptrdiff_t size);
+static void  parsectx_trim_output    (mjson_parser_t* ctx);
 
 static void parsectx_next_token    (mjson_parser_t* context);
+static void parsectx_lex_token     (mjson_parser_t* context);
 
+static int parse_document      (mjson_parser_t *context, mjson_element_t* top_element);
+static int parse_document_with_flags(mjson_parser_t *context, mjson_element_t* top_element);
+static int parse_value         (mjson_parser_t *context);
 static int parse_value_list    (mjson_parser_t *context);
 static int parse_key_value_pair(mjson_parser_t *context, int stop_token);
 
-static mjson_element_t next_element(mjson_element_t element);
-
-int mjson_parse(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, const mjson_entry_t** top_element)
-{
-    uint32_t* fourcc;
-    mjson_parser_t c = {
-        TOK_NONE, 0,
-        (uint8_t*)json_data,   (uint8_t*)json_data + json_data_size,
-        (uint8_t*)storage_buf, (uint8_t*)storage_buf + storage_buf_size
-    };
-    int stop_token = TOK_NONE;
-
-    *top_element = 0;
-
-    fourcc = (uint32_t*)parsectx_allocate_output(&c, (ptrdiff_t)sizeof(uint32_t));
+static int measure_document    (mjson_parser_t *context, size_t* size);
 
-    if (!fourcc) return 0;
-
-    *fourcc = '23JB';
-
-    parsectx_next_token(&c);
-
-    if (c.token == TOK_LEFT_BRACKET)
-    {
-        parsectx_next_token(&c);
-        if (!parse_value_list(&c))
-            return 0;
-    }
-    else
-    {
-        if (c.token == TOK_LEFT_CURLY_BRACKET)
-        {
-            stop_token = TOK_RIGHT_CURLY_BRACKET;
-            parsectx_next_token(&c);
-        }
+static int bind_object(mjson_parser_t* context, const mjson_schema_t* schema, uint8_t* out, int stop_token);
 
-        if (!parse_key_value_pair(&c, stop_token))
-            return 0;
-    }
+static int      stream_init(mjson_stream_t* stream, uint8_t* storage, size_t storage_size, unsigned flags, const mjson_allocator_t* allocator);
+static void     stream_release(mjson_stream_t* stream);
+static uint8_t* stream_lex(mjson_stream_t* stream, uint8_t* c, uint8_t* e, int partial);
+static int      stream_append_carry(mjson_stream_t* stream, const uint8_t* data, size_t size);
+static int      stream_open_container(mjson_stream_t* stream, int is_dict, int stop_token);
+static int      stream_close_container(mjson_stream_t* stream);
 
-    if (c.token != TOK_NONE)
-        return 0;
+static int builder_value (mjson_builder_t* builder, int is_container);
+static int builder_result(mjson_builder_t* builder, int result);
 
-    *top_element = (mjson_entry_t*)(fourcc + 1);
+static int  emit_id          (mjson_parser_t *context, uint32_t bjson_id);
+static int  widen_string     (mjson_parser_t *context, mjson_entry_t* entry, size_t len);
+static int  close_container  (mjson_parser_t* context, ptrdiff_t offset, int is_dict);
+static int  widen_container  (mjson_parser_t* context, ptrdiff_t offset, size_t size);
+static int  emit_number_entry(mjson_parser_t *context, uint32_t bjson_id, uint64_t payload);
+static int  emit_raw_string  (mjson_parser_t *context, uint32_t id, const uint8_t* str_src, size_t str_len);
+static int  emit_string_token(mjson_parser_t *context, uint32_t id);
+static int  integer_entry    (uint64_t magnitude, int negative, uint32_t* id, uint64_t* bits);
+static void double_entry     (double value, uint32_t* id, uint64_t* bits);
 
-    return 1;
-}
+static mjson_element_t next_element(mjson_element_t element);
+static size_t          element_size(mjson_element_t element);
+static size_t          entry_size(mjson_element_t element);
+static mjson_element_t container_table(mjson_element_t element);
+static mjson_element_t string_target(mjson_element_t element);
+static uint64_t        entry_payload_u64(mjson_element_t element);
+static const uint8_t*  entry_data(mjson_element_t element);
+static size_t          entry_length(mjson_element_t element);
+static int             is_array(mjson_element_t element);
+static int             is_dict(mjson_element_t element);
+static int             is_key(mjson_element_t element);
+static uint32_t        hash_key(const uint8_t* key, size_t len);
+static mjson_element_t find_member(mjson_element_t dictionary, const char* name, size_t len, uint32_t hash);
+static int             path_parse_pointer(mjson_path_t* path, const char* text, char* keys);
+static int             path_parse_dotted (mjson_path_t* path, const char* text, char* keys);
+static int             path_index(const char* text, size_t len);
+
+static mjson_lazy_t    lazy_value     (const mjson_parser_t* context, const char* end);
+static int             lazy_skip_value(mjson_parser_t* context);
+static uint8_t*        lazy_skip_container(uint8_t* c, uint8_t* e);
+static mjson_element_t lazy_scalar    (mjson_lazy_t element, uint32_t* entry);
+static uint8_t*        decode_string  (uint8_t* c, uint8_t* e, uint8_t* dst, uint8_t* limit);
+
+static void index_init(mjson_index_t* index, uint8_t* json_data);
+
+static size_t check_entry    (mjson_element_t element, const uint8_t* blob, const uint8_t* limit);
+static int    check_child    (mjson_check_t* check, mjson_element_t element);
+static int    check_container(const mjson_check_t* check);
+
+static void   write_element  (mjson_writer_t* writer, mjson_element_t element);
+static size_t writer_finish  (mjson_writer_t* writer);
+
+static const uint8_t* file_map  (const char* path, size_t* size, int sequential);
+static void           file_unmap(const uint8_t* data, size_t size);
+
+static int            cpu_count        (void);
+static const uint8_t* find_split       (const uint8_t* guess, const uint8_t* end);
+static void           parse_segment    (mjson_segment_t* segment);
+static void           release_segment  (mjson_segment_t* segment);
+static int            parse_segments   (mjson_segment_t* segments, int count);
+static void           pool_run         (size_t item_count, int thread_count, void (*func)(void* arg, size_t item), void* arg);
+static void           parse_batch_item (void* arg, size_t item);
+static int            is_blank_line    (const uint8_t* begin, const uint8_t* end);
+
+#if defined(MJSON_STATS)
+static uint64_t stats_clock       (void);
+static void     stats_next_token  (mjson_parser_t* context);
+static void     stats_count_output(mjson_parse_stats_t* stats, const uint8_t* blob, const uint8_t* end);
+#endif
 
-mjson_element_t mjson_get_top_element(void* storage_buf, size_t storage_buf_size)
+int mjson_parse(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, const mjson_entry_t** top_element)
 {
-    mjson_element_t top = (mjson_element_t)storage_buf;
-    
-    RETURN_VAL_IF_FAIL(top, NULL);
-    RETURN_VAL_IF_FAIL(top->id == MJSON_ID_DICT32 || top->id == MJSON_ID_ARRAY32, NULL);
-    RETURN_VAL_IF_FAIL(top->val_u32 <= storage_buf_size, NULL);
-    
-    return top;
+    return mjson_parse_with_flags(json_data, json_data_size, storage_buf, storage_buf_size, 0, top_element);
 }
 
-mjson_element_t mjson_get_element_first(mjson_element_t array)
+int mjson_parse_indexed(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, const mjson_entry_t** top_element)
 {
-    RETURN_VAL_IF_FAIL(array, NULL);
-    RETURN_VAL_IF_FAIL(array->id == MJSON_ID_ARRAY32, NULL);
-    
-    return array + 1;
+    return mjson_parse_with_flags(json_data, json_data_size, storage_buf, storage_buf_size, MJSON_PARSE_INDEXED, top_element);
 }
 
-mjson_element_t mjson_get_element_next(mjson_element_t array, mjson_element_t current_value)
+int mjson_parse_with_flags(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, unsigned flags, const mjson_entry_t** top_element)
 {
-    mjson_element_t next = NULL;
-
-    RETURN_VAL_IF_FAIL(array, NULL);
-    RETURN_VAL_IF_FAIL(current_value, NULL);
-    RETURN_VAL_IF_FAIL(array->id == MJSON_ID_ARRAY32, NULL);
-    RETURN_VAL_IF_FAIL((uint8_t*)array + array->val_u32 > (uint8_t*)current_value, NULL);
-    
-    next = next_element(current_value);
-    
-    RETURN_VAL_IF_FAIL((uint8_t*)array + array->val_u32 > (uint8_t*)next, NULL);
-    
-    return next;
-}
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data,   (uint8_t*)json_data + json_data_size,
+        (uint8_t*)storage_buf, (uint8_t*)storage_buf + storage_buf_size,
+        NULL, flags,
+        (uint8_t*)storage_buf, NULL
+    };
 
-mjson_element_t mjson_get_element(mjson_element_t array, int index)
-{
-    mjson_element_t result;
-    
-    result = mjson_get_element_first(array);
-    while (result && index--)
-        result = mjson_get_element_next(array, result);
-    
-    return result;
+    return parse_document_with_flags(&c, top_element);
 }
 
-mjson_element_t mjson_get_member_first(mjson_element_t dictionary, mjson_element_t* value)
+int mjson_parse_with_stats(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, unsigned flags, mjson_parse_stats_t* stats, mjson_element_t* top_element)
 {
-    RETURN_VAL_IF_FAIL(dictionary, NULL);
-    RETURN_VAL_IF_FAIL(dictionary->id == MJSON_ID_DICT32, NULL);
-    RETURN_VAL_IF_FAIL((dictionary+1)->id == MJSON_ID_UTF8_KEY32, NULL);
-    
-    *value = next_element(dictionary+1);
-    
-    return dictionary + 1;
-}
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data,   (uint8_t*)json_data + json_data_size,
+        (uint8_t*)storage_buf, (uint8_t*)storage_buf + storage_buf_size,
+        NULL, flags,
+        (uint8_t*)storage_buf, NULL
+    };
+    int result;
 
-mjson_element_t mjson_get_member_next(mjson_element_t dictionary, mjson_element_t current_key, mjson_element_t* next_value)
-{
-    mjson_element_t next_key = NULL;
+#if defined(MJSON_STATS)
+    c.stats        = stats;
+    stats->enabled = TRUE;
+#endif
 
-    RETURN_VAL_IF_FAIL(dictionary, NULL);
-    RETURN_VAL_IF_FAIL(dictionary->id == MJSON_ID_DICT32, NULL);
-    RETURN_VAL_IF_FAIL(current_key, NULL);
-    RETURN_VAL_IF_FAIL((uint8_t*)dictionary + dictionary->val_u32 > (uint8_t*)current_key, NULL);
-    RETURN_VAL_IF_FAIL(current_key->id == MJSON_ID_UTF8_KEY32, NULL);
-    
-    next_key = next_element(current_key);
-    next_key = next_element(next_key);
-    
-    RETURN_VAL_IF_FAIL(next_key, NULL);
-    RETURN_VAL_IF_FAIL((uint8_t*)dictionary + dictionary->val_u32 > (uint8_t*)next_key, NULL);
-    RETURN_VAL_IF_FAIL(next_key->id == MJSON_ID_UTF8_KEY32, NULL);
+    result = parse_document_with_flags(&c, top_element);
 
-    *next_value = next_element(next_key);
-   
-    return next_key;    
-}
+#if defined(MJSON_STATS)
+    if (result)
+        stats_count_output(stats, c.bjson_start + sizeof(uint32_t), c.bjson);
+#endif
 
-mjson_element_t mjson_get_member(mjson_element_t dictionary, const char* name)
-{
-    mjson_element_t key, result;
-    
-    key = mjson_get_member_first(dictionary, &result);
-    while (key && strncmp(name, (char*)(key+1), key->val_u32) != 0)
-        result = mjson_get_member_next(dictionary, key, &result);
-    
     return result;
 }
 
-int mjson_get_type(mjson_element_t element)
+static void* default_reserve(void* user_data, size_t size)
 {
-    RETURN_VAL_IF_FAIL(element, MJSON_ID_NULL);
-    
-    return element->id;
+    return malloc(size);
 }
 
-const char* mjson_get_string(mjson_element_t element, const char* fallback)
+static void* default_grow(void* user_data, void* buf, size_t old_size, size_t new_size)
 {
-    RETURN_VAL_IF_FAIL(element, fallback);
-    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_UTF8_STRING32 ||
-                       element->id == MJSON_ID_UTF8_KEY32,
-                       fallback);
-    
-    return (const char*)(element+1);
+    return realloc(buf, new_size);
 }
 
-int32_t mjson_get_int(mjson_element_t element, int32_t fallback)
+static void default_release(void* user_data, void* buf, size_t size)
 {
-    RETURN_VAL_IF_FAIL(element, fallback);
-    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_SINT32, fallback);
-    
-    return element->val_s32;
+    free(buf);
 }
 
-float mjson_get_float(mjson_element_t element, float fallback)
-{
-    RETURN_VAL_IF_FAIL(element, fallback);
-    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_FLOAT32, fallback);
-    
-    return element->val_f32;
-}
+static const mjson_allocator_t default_allocator = { default_reserve, default_grow, default_release, NULL };
 
-int mjson_get_bool(mjson_element_t element, int fallback)
+int mjson_parse_ex(const char *json_data, size_t json_data_size, unsigned flags, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, const mjson_entry_t** top_element)
 {
-    RETURN_VAL_IF_FAIL(element, fallback);
-    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_TRUE || element->id == MJSON_ID_FALSE, fallback);
-    
-    return element->id == MJSON_ID_TRUE;
-}
+    uint8_t*       buf;
+    size_t         capacity = json_data_size + 256;
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data, (uint8_t*)json_data + json_data_size,
+        NULL, NULL,
+        NULL, flags
+    };
 
-int mjson_is_null(mjson_element_t element)
-{
-    RETURN_VAL_IF_FAIL(element, TRUE);
+    *storage_buf      = NULL;
+    *storage_buf_size = 0;
+    *top_element      = NULL;
 
-    return element->id == MJSON_ID_NULL;
-}
+    if (!allocator)
+        allocator = &default_allocator;
 
-/////////////////////////////////////////////////////////////////////////////
-// API helpers
-/////////////////////////////////////////////////////////////////////////////
+    buf = (uint8_t*)allocator->reserve(allocator->user_data, capacity);
+    RETURN_VAL_IF_FAIL(buf, FALSE);
 
-static size_t element_size(mjson_element_t element)
-{
-    RETURN_VAL_IF_FAIL(element, 0);
+    c.bjson       = buf;
+    c.bjson_limit = buf + capacity;
+    c.bjson_start = buf;
+    c.allocator   = allocator;
 
-    switch(element->id)
+    if (!parse_document_with_flags(&c, top_element))
     {
-        case MJSON_ID_NULL:
-        case MJSON_ID_FALSE:
-        case MJSON_ID_EMPTY_STRING:
-        case MJSON_ID_TRUE:
-            return sizeof(uint32_t);
-
-        case MJSON_ID_UINT32:
-        case MJSON_ID_SINT32:
-        case MJSON_ID_FLOAT32:
-            return sizeof(mjson_entry_t);
+        allocator->release(allocator->user_data, c.bjson_start, c.bjson_limit - c.bjson_start);
+        *top_element = NULL;
+        return FALSE;
+    }
 
-        case MJSON_ID_UTF8_KEY32:
-        case MJSON_ID_UTF8_STRING32:
-            return sizeof(mjson_entry_t) + ((element->val_u32 + 1 + 3) & (~3));
+    parsectx_trim_output(&c);
 
-        case MJSON_ID_BINARY32:
-        case MJSON_ID_ARRAY32:
-        case MJSON_ID_DICT32:
-            return sizeof(mjson_entry_t) + ((element->val_u32 + 3) & (~3));
-    };
+    *top_element      = (mjson_entry_t*)(c.bjson_start + sizeof(uint32_t));
+    *storage_buf      = c.bjson_start;
+    *storage_buf_size = c.bjson_limit - c.bjson_start;
 
-    return 0;
+    return TRUE;
 }
 
-static mjson_element_t next_element(mjson_element_t element)
+int mjson_parse_parallel(const char *json_data, size_t json_data_size, unsigned flags, int thread_count, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element)
 {
-    size_t size;
-    
-    RETURN_VAL_IF_FAIL(element, 0);
+    mjson_segment_t* segments;
+    const uint8_t*   split;
+    const uint8_t*   end = (const uint8_t*)json_data + json_data_size;
+    uint8_t*         buf;
+    int              count, n, i, result;
+    size_t           total = 0;
+    mjson_parser_t   c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data, (uint8_t*)json_data + json_data_size,
+        NULL, NULL,
+        NULL, flags
+    };
 
-    size = element_size(element);
-    assert(size>0);
-    
-    return (mjson_element_t)((uint8_t*)element + size);
-}
+    if (!allocator)
+        allocator = &default_allocator;
 
-static void* parsectx_reserve_output(mjson_parser_t* ctx, ptrdiff_t size)
-{
-    return (ctx->bjson_limit - ctx->bjson < size) ? 0 : ctx->bjson;
-}
+    if (thread_count <= 0)
+        thread_count = cpu_count();
 
-static void parsectx_advance_output(mjson_parser_t* ctx, ptrdiff_t size)
-{
-    ctx->bjson += size;
-}
+#if !defined(MJSON_THREADS)
+    thread_count = 1;
+#endif
 
-static void* parsectx_allocate_output(mjson_parser_t* ctx, ptrdiff_t size)
-{
-    void* ptr;
+    count = (int)(json_data_size / MJSON_PARALLEL_MIN_SEGMENT);
+    count = count < thread_count ? count : thread_count;
+    count = count < PARALLEL_MAX_THREADS ? count : PARALLEL_MAX_THREADS;
 
-    if (ctx->bjson_limit - ctx->bjson < size)
-        return 0;
+    // only elements of top level array are split
+    parsectx_next_token(&c);
 
-    ptr = ctx->bjson;
-    ctx->bjson += size;
+    if (count < 2 || c.token != TOK_LEFT_BRACKET)
+        return mjson_parse_ex(json_data, json_data_size, flags, allocator, storage_buf, storage_buf_size, top_element);
 
-    return ptr;
-}
+    *storage_buf      = NULL;
+    *storage_buf_size = 0;
+    *top_element      = NULL;
 
-//TODO: what about 64 bit code????
-static void parsectx_align4_output(mjson_parser_t* ctx)
-{
-    ctx->bjson = (uint8_t*)(((ptrdiff_t)ctx->bjson + 3) & (~3));
-}
+    segments = (mjson_segment_t*)calloc(count, sizeof(mjson_segment_t));
+    RETURN_VAL_IF_FAIL(segments, FALSE);
 
-static void unicode_cp_to_utf8(uint32_t uni_cp, uint8_t* utf8char/*[6]*/, size_t* charlen)
-{
-    uint32_t first, i;
-    
-    if (uni_cp < 0x80)
+    // segments which could not be split off are merged with previous one
+    segments[0].begin = c.next;
+    for (i = 1, n = 1; i < count; ++i)
     {
-        first   = 0;
-        *charlen = 1;
+        split = find_split((const uint8_t*)json_data + json_data_size / count * i, end);
+        if (split && split > segments[n - 1].begin)
+            segments[n++].begin = split;
     }
-    else if (uni_cp < 0x800)
+    count = n;
+
+    for (i = 0; i < count; ++i)
     {
-        first   = 0xc0;
-        *charlen = 2;
+        segments[i].end       = i + 1 < count ? segments[i + 1].begin : end;
+        segments[i].last      = i + 1 == count;
+        segments[i].flags     = flags;
+        segments[i].allocator = allocator;
     }
-    else if (uni_cp < 0x10000)
+
+    result = parse_segments(segments, count);
+
+    if (!result)
     {
-        first   = 0xe0;
-        *charlen = 3;
+        for (i = 0; i < count; ++i)
+            release_segment(&segments[i]);
+        free(segments);
+
+        return mjson_parse_ex(json_data, json_data_size, flags, allocator, storage_buf, storage_buf_size, top_element);
     }
-    else if (uni_cp < 0x200000)
+
+    for (i = 0; i < count; ++i)
+        total += segments[i].size;
+
+    buf = (uint8_t*)allocator->reserve(allocator->user_data, total + 2 * sizeof(mjson_entry_t));
+
+    if (buf)
     {
-        first   = 0xf0;
-        *charlen = 4;
+        c.bjson       = buf;
+        c.bjson_limit = buf + total + 2 * sizeof(mjson_entry_t);
+        c.bjson_start = buf;
+        c.allocator   = allocator;
+
+        *(uint32_t*)parsectx_allocate_output(&c, sizeof(uint32_t)) = MJSON_FOURCC;
+        ((mjson_entry_t*)parsectx_allocate_output(&c, sizeof(mjson_entry_t)))->id = MJSON_ID_ARRAY32;
+
+        // merged segments are empty
+        for (i = 0; i < count; ++i)
+        {
+            if (segments[i].size)
+                memcpy(parsectx_allocate_output(&c, segments[i].size), segments[i].storage, segments[i].size);
+        }
+
+        if (close_container(&c, sizeof(uint32_t), FALSE))
+        {
+            parsectx_trim_output(&c);
+
+            *storage_buf      = c.bjson_start;
+            *storage_buf_size = c.bjson - c.bjson_start;
+            *top_element      = (mjson_element_t)(c.bjson_start + sizeof(uint32_t));
+        }
+        else
+        {
+            allocator->release(allocator->user_data, c.bjson_start, c.bjson_limit - c.bjson_start);
+        }
     }
-    else if (uni_cp < 0x4000000)
+
+    for (i = 0; i < count; ++i)
+        release_segment(&segments[i]);
+    free(segments);
+
+    return *top_element != NULL;
+}
+
+int mjson_parse_batch(mjson_document_t* documents, size_t document_count, unsigned flags, int thread_count, const mjson_allocator_t* allocator)
+{
+    mjson_batch_t batch;
+    size_t        i;
+    int           result = TRUE;
+
+    batch.documents = documents;
+    batch.flags     = flags;
+    batch.allocator = allocator ? allocator : &default_allocator;
+
+    pool_run(document_count, thread_count, parse_batch_item, &batch);
+
+    for (i = 0; i < document_count; ++i)
+        result &= documents[i].top_element != NULL;
+
+    return result;
+}
+
+int mjson_parse_ndjson(const char *json_data, size_t json_data_size, unsigned flags, int thread_count, const mjson_allocator_t* allocator, mjson_document_t* documents, size_t* document_count)
+{
+    const uint8_t* line = (const uint8_t*)json_data;
+    const uint8_t* end  = line + json_data_size;
+    const uint8_t* eol;
+    size_t         count = 0;
+    int            result;
+
+    while (line < end)
     {
-        first   = 0xf8;
-        *charlen = 5;
+        eol = (const uint8_t*)memchr(line, '\n', end - line);
+        eol = eol ? eol : end;
+
+        if (!is_blank_line(line, eol))
+        {
+            if (documents && count < *document_count)
+            {
+                documents[count].json_data      = (const char*)line;
+                documents[count].json_data_size = eol - line;
+                documents[count].top_element    = NULL;
+            }
+            ++count;
+        }
+
+        line = eol + 1;
     }
-    else
+
+    // without documents, or too few of them, only count is returned
+    result = documents == NULL;
+    if (documents && count <= *document_count)
+        result = mjson_parse_batch(documents, count, flags, thread_count, allocator);
+
+    *document_count = count;
+
+    return result;
+}
+
+int mjson_parse_size(const char *json_data, size_t json_data_size, size_t* storage_buf_size)
+{
+    return mjson_parse_size_with_flags(json_data, json_data_size, 0, storage_buf_size);
+}
+
+int mjson_parse_size_with_flags(const char *json_data, size_t json_data_size, unsigned flags, size_t* storage_buf_size)
+{
+    mjson_index_t  index;
+    size_t         size = sizeof(uint32_t);
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data, (uint8_t*)json_data + json_data_size,
+        NULL, NULL,
+        NULL, flags
+    };
+
+    *storage_buf_size = 0;
+
+    if (flags & MJSON_PARSE_INDEXED)
     {
-        first   = 0xfc;
-        *charlen = 6;
+        index_init(&index, (uint8_t*)json_data);
+        c.index = &index;
     }
 
-    for (i = *charlen - 1; i > 0; --i)
+    if (!measure_document(&c, &size))
+        return 0;
+
+    *storage_buf_size = size;
+
+    return 1;
+}
+
+mjson_stream_t* mjson_parser_begin(void* storage_buf, size_t storage_buf_size, unsigned flags)
+{
+    mjson_stream_t* stream;
+
+    stream = (mjson_stream_t*)calloc(1, sizeof(mjson_stream_t));
+    RETURN_VAL_IF_FAIL(stream, NULL);
+
+    if (!stream_init(stream, (uint8_t*)storage_buf, storage_buf_size, flags, NULL))
     {
-        utf8char[i] = (uni_cp & 0x3f) | 0x80;
-        uni_cp >>= 6;
+        free(stream);
+        return NULL;
     }
-    utf8char[0] = uni_cp | first;
+
+    return stream;
 }
 
-/////////////////////////////////////////////////////////////////////////////
-// Lexer+Parser code
-/////////////////////////////////////////////////////////////////////////////
+int mjson_parser_feed(mjson_stream_t* stream, const char* chunk, size_t chunk_size)
+{
+    uint8_t* c = (uint8_t*)chunk;
+    uint8_t* e = (uint8_t*)chunk + chunk_size;
+    uint8_t* rest;
+    uint8_t* carry_end;
+    size_t   probe;
+
+    RETURN_VAL_IF_FAIL(stream, FALSE);
+    RETURN_VAL_IF_FAIL(!stream->failed, FALSE);
+    RETURN_VAL_IF_FAIL(!stream->finished, TRUE);
+
+    // finish token which started in previous chunks: append growing part of
+    // the chunk to carry until the token ends inside it
+    probe = 64;
+    while (stream->carry_size > 0 && c < e)
+    {
+        if (probe < stream->carry_size)
+            probe = stream->carry_size;
+        if (probe > (size_t)(e - c))
+            probe = e - c;
 
+        if (!stream_append_carry(stream, c, probe))
+            return FALSE;
+        c += probe;
 
+        carry_end = stream->carry + stream->carry_size;
+        rest      = stream_lex(stream, stream->carry, carry_end, TRUE);
+        if (!rest)
+            return FALSE;
 
-static void parsectx_next_token(mjson_parser_t* context)
+        if (rest >= carry_end - probe || stream->finished)
+        {
+            // only bytes of this chunk remain, continue lexing in place
+            c -= carry_end - rest;
+            stream->carry_size = 0;
+        }
+        else
+        {
+            memmove(stream->carry, rest, carry_end - rest);
+            stream->carry_size = carry_end - rest;
+        }
+    }
+
+    if (c == e || stream->finished)
+        return TRUE;
+
+    rest = stream_lex(stream, c, e, TRUE);
+    if (!rest)
+        return FALSE;
+
+    return stream_append_carry(stream, rest, e - rest);
+}
+
+int mjson_parser_end(mjson_stream_t* stream, mjson_element_t* top_element)
 {
-#define YYREADINPUT(c) (c>=e?0:*c)
-#define YYCTYPE        uint8_t
-#define YYCURSOR       c
-#define YYMARKER       m
+    uint8_t empty = 0;
+    int     result;
 
-    uint8_t* c = context->next;
-    uint8_t* e = context->end;
-    uint8_t* m = NULL;
-    uint8_t* s;
-    int token = TOK_NONE;
+    *top_element = NULL;
 
-    assert(context);
-    RETURN_IF_FAIL(context->next != NULL);
+    RETURN_VAL_IF_FAIL(stream, FALSE);
 
-    while (TRUE)
+    if (!stream->failed && !stream->finished)
     {
-        s = c;
+        if (stream->carry_size > 0)
+            stream_lex(stream, stream->carry, stream->carry + stream->carry_size, FALSE);
+        else
+            stream_lex(stream, &empty, &empty, FALSE);
+    }
+
+    result = !stream->failed && stream->finished && stream->done;
+    if (result)
+        *top_element = (mjson_element_t)(stream->context.bjson_start + sizeof(uint32_t));
+
+    stream_release(stream);
+    free(stream);
+
+    return result;
+}
+
+mjson_builder_t* mjson_builder_create(void* storage_buf, size_t storage_buf_size, unsigned flags)
+{
+    mjson_builder_t* builder;
+
+    builder = (mjson_builder_t*)calloc(1, sizeof(mjson_builder_t));
+    RETURN_VAL_IF_FAIL(builder, NULL);
+
+    if (!stream_init(&builder->stream, (uint8_t*)storage_buf, storage_buf_size, flags, NULL))
+    {
+        free(builder);
+        return NULL;
+    }
+
+    return builder;
+}
+
+mjson_builder_t* mjson_builder_create_ex(unsigned flags, const mjson_allocator_t* allocator)
+{
+    mjson_builder_t* builder;
+    uint8_t*         buf;
+
+    if (!allocator)
+        allocator = &default_allocator;
+
+    builder = (mjson_builder_t*)calloc(1, sizeof(mjson_builder_t));
+    RETURN_VAL_IF_FAIL(builder, NULL);
+
+    buf = (uint8_t*)allocator->reserve(allocator->user_data, BUILDER_INITIAL_SIZE);
+
+    if (!buf || !stream_init(&builder->stream, buf, BUILDER_INITIAL_SIZE, flags, allocator))
+    {
+        if (buf)
+            allocator->release(allocator->user_data, buf, BUILDER_INITIAL_SIZE);
+        stream_release(&builder->stream);
+        free(builder);
+        return NULL;
+    }
+
+    return builder;
+}
+
+int mjson_builder_begin_dict(mjson_builder_t* builder)
+{
+    RETURN_VAL_IF_FAIL(builder_value(builder, TRUE), FALSE);
+    return builder_result(builder, stream_open_container(&builder->stream, TRUE, TOK_RIGHT_CURLY_BRACKET));
+}
+
+int mjson_builder_begin_array(mjson_builder_t* builder)
+{
+    RETURN_VAL_IF_FAIL(builder_value(builder, TRUE), FALSE);
+    return builder_result(builder, stream_open_container(&builder->stream, FALSE, TOK_RIGHT_BRACKET));
+}
+
+int mjson_builder_key(mjson_builder_t* builder, const char* key)
+{
+    mjson_stream_t* stream;
+    mjson_frame_t*  frame;
+
+    RETURN_VAL_IF_FAIL(builder && key, FALSE);
+
+    stream = &builder->stream;
+    RETURN_VAL_IF_FAIL(!stream->failed, FALSE);
+
+    frame = stream->depth > 0 ? &stream->stack[stream->depth - 1] : NULL;
+    if (!frame || !frame->is_dict || frame->state == FRAME_VALUE)
+        return builder_result(builder, FALSE);
+
+    frame->state = FRAME_VALUE;
+
+    return builder_result(builder, emit_raw_string(&stream->context, MJSON_ID_UTF8_KEY32, (const uint8_t*)key, strlen(key)));
+}
+
+int mjson_builder_end(mjson_builder_t* builder)
+{
+    mjson_stream_t* stream;
+
+    RETURN_VAL_IF_FAIL(builder, FALSE);
+
+    stream = &builder->stream;
+    RETURN_VAL_IF_FAIL(!stream->failed, FALSE);
+
+    // key without value can not be closed
+    if (stream->depth == 0 || stream->stack[stream->depth - 1].state == FRAME_VALUE)
+        return builder_result(builder, FALSE);
+
+    return builder_result(builder, stream_close_container(stream));
+}
+
+int mjson_builder_int(mjson_builder_t* builder, int64_t value)
+{
+    uint32_t id;
+    uint64_t bits;
+
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+
+    if (value < 0)
+        integer_entry(0 - (uint64_t)value, TRUE, &id, &bits);
+    else
+        integer_entry((uint64_t)value, FALSE, &id, &bits);
+
+    return builder_result(builder, emit_number_entry(&builder->stream.context, id, bits));
+}
+
+int mjson_builder_uint(mjson_builder_t* builder, uint64_t value)
+{
+    uint32_t id;
+    uint64_t bits;
+
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+
+    integer_entry(value, FALSE, &id, &bits);
+
+    return builder_result(builder, emit_number_entry(&builder->stream.context, id, bits));
+}
+
+int mjson_builder_float(mjson_builder_t* builder, double value)
+{
+    uint32_t id;
+    uint64_t bits;
+
+    // NaN has no text form
+    if (value != value)
+        return builder ? builder_result(builder, FALSE) : FALSE;
+
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+
+    double_entry(value, &id, &bits);
+
+    return builder_result(builder, emit_number_entry(&builder->stream.context, id, bits));
+}
+
+int mjson_builder_string(mjson_builder_t* builder, const char* value)
+{
+    if (!value)
+        return builder ? builder_result(builder, FALSE) : FALSE;
+
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+
+    return builder_result(builder, emit_raw_string(&builder->stream.context, MJSON_ID_UTF8_STRING32, (const uint8_t*)value, strlen(value)));
+}
+
+int mjson_builder_bool(mjson_builder_t* builder, int value)
+{
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+    return builder_result(builder, emit_id(&builder->stream.context, value ? MJSON_ID_TRUE : MJSON_ID_FALSE));
+}
+
+int mjson_builder_null(mjson_builder_t* builder)
+{
+    RETURN_VAL_IF_FAIL(builder_value(builder, FALSE), FALSE);
+    return builder_result(builder, emit_id(&builder->stream.context, MJSON_ID_NULL));
+}
+
+int mjson_builder_finish(mjson_builder_t* builder, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element)
+{
+    mjson_parser_t* context;
+    int             result;
+
+    *storage_buf      = NULL;
+    *storage_buf_size = 0;
+    *top_element      = NULL;
+
+    RETURN_VAL_IF_FAIL(builder, FALSE);
+
+    context = &builder->stream.context;
+    result  = !builder->stream.failed && builder->stream.done;
+
+    if (result)
+    {
+        parsectx_trim_output(context);
+
+        *storage_buf      = context->bjson_start;
+        *storage_buf_size = context->bjson - context->bjson_start;
+        *top_element      = (mjson_element_t)(context->bjson_start + sizeof(uint32_t));
+    }
+    else if (context->allocator)
+    {
+        context->allocator->release(context->allocator->user_data, context->bjson_start, context->bjson_limit - context->bjson_start);
+    }
+
+    stream_release(&builder->stream);
+    free(builder);
+
+    return result;
+}
+
+int mjson_load_text_file(const char* path, unsigned flags, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element)
+{
+    const uint8_t* text;
+    size_t         text_size;
+    int            result;
+
+    *storage_buf      = NULL;
+    *storage_buf_size = 0;
+    *top_element      = NULL;
+
+    text = file_map(path, &text_size, TRUE);
+    RETURN_VAL_IF_FAIL(text, FALSE);
+
+    result = mjson_parse_ex((const char*)text, text_size, flags, allocator, storage_buf, storage_buf_size, top_element);
+
+    file_unmap(text, text_size);
+
+    return result;
+}
+
+const void* mjson_map_blob_file(const char* path, size_t* blob_size, mjson_element_t* top_element)
+{
+    const uint8_t*  blob;
+    size_t          size;
+    mjson_element_t top;
+
+    *blob_size   = 0;
+    *top_element = NULL;
+
+    blob = file_map(path, &size, FALSE);
+    RETURN_VAL_IF_FAIL(blob, NULL);
+
+    top = mjson_get_top_element((void*)blob, size);
+
+    if (!top)
+    {
+        file_unmap(blob, size);
+        return NULL;
+    }
+
+    *blob_size   = size;
+    *top_element = top;
+
+    return blob;
+}
+
+void mjson_unmap_blob_file(const void* blob, size_t blob_size)
+{
+    RETURN_IF_FAIL(blob);
+
+    file_unmap((const uint8_t*)blob, blob_size);
+}
+
+mjson_element_t mjson_get_top_element(void* storage_buf, size_t storage_buf_size)
+{
+    mjson_element_t top = (mjson_element_t)storage_buf;
+    
+    RETURN_VAL_IF_FAIL(top, NULL);
+    RETURN_VAL_IF_FAIL(storage_buf_size >= sizeof(mjson_entry_t), NULL);
 
+    // blobs written by parser start with fourcc, skip it
+    if (*(const uint32_t*)storage_buf == MJSON_FOURCC)
+    {
+        top = (mjson_element_t)((const uint8_t*)storage_buf + sizeof(uint32_t));
+        storage_buf_size -= sizeof(uint32_t);
+        RETURN_VAL_IF_FAIL(storage_buf_size >= sizeof(mjson_entry_t), NULL);
+    }
+
+    RETURN_VAL_IF_FAIL(is_dict(top) || is_array(top), NULL);
+    RETURN_VAL_IF_FAIL((size_t)(entry_data(top) - (const uint8_t*)top) <= storage_buf_size, NULL);
+    RETURN_VAL_IF_FAIL(entry_length(top) <= storage_buf_size - (entry_data(top) - (const uint8_t*)top), NULL);
+    
+    return top;
+}
+
+int mjson_validate_blob(const void* blob, size_t blob_size)
+{
+    mjson_check_t   local_stack[VALIDATE_STACK_SIZE];
+    mjson_check_t*  stack    = local_stack;
+    mjson_check_t*  grown;
+    mjson_check_t*  check;
+    int             depth    = 0;
+    int             capacity = VALIDATE_STACK_SIZE;
+    int             failed   = FALSE;
+    const uint8_t*  start    = (const uint8_t*)blob;
+    const uint8_t*  end      = start + blob_size;
+    const uint8_t*  cursor;
+    mjson_element_t element;
+    size_t          size;
+
+    RETURN_VAL_IF_FAIL(blob, FALSE);
+    RETURN_VAL_IF_FAIL(((ptrdiff_t)blob & 3) == 0, FALSE);
+    RETURN_VAL_IF_FAIL(blob_size >= sizeof(uint32_t) + sizeof(mjson_entry_t), FALSE);
+    RETURN_VAL_IF_FAIL(*(const uint32_t*)blob == MJSON_FOURCC, FALSE);
+
+    cursor  = start + sizeof(uint32_t);
+    element = (mjson_element_t)cursor;
+
+    RETURN_VAL_IF_FAIL(is_dict(element) || is_array(element), FALSE);
+
+    // single pass over entries in storage order, open containers are kept on
+    // explicit stack, so nesting depth is not limited by call stack
+    do
+    {
+        check = depth ? &stack[depth - 1] : NULL;
 
+        if (check && cursor == check->end)
         {
-            YYCTYPE yych;
-            unsigned int yyaccept = 0;
+            if (!check_container(check))
+            {
+                failed = TRUE;
+                break;
+            }
 
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '<') {
-                if (yych <= '"') {
-                    if (yych <= '\f') {
-                        if (yych <= 0x00) goto yy31;
-                        if (yych <= 0x08) goto yy33;
-                        if (yych >= '\v') goto yy33;
-                    } else {
-                        if (yych <= 0x1F) {
-                            if (yych >= 0x0E) goto yy33;
-                        } else {
-                            if (yych <= ' ') goto yy2;
-                            if (yych <= '!') goto yy33;
-                            goto yy30;
-                        }
-                    }
-                } else {
-                    if (yych <= '.') {
-                        if (yych <= '+') {
-                            if (yych <= '*') goto yy33;
-                            goto yy22;
-                        } else {
-                            if (yych <= ',') goto yy18;
-                            if (yych <= '-') goto yy22;
-                            goto yy24;
-                        }
-                    } else {
-                        if (yych <= '0') {
-                            if (yych <= '/') goto yy4;
-                            goto yy20;
-                        } else {
-                            if (yych <= '9') goto yy23;
-                            if (yych <= ':') goto yy14;
-                            goto yy33;
-                        }
-                    }
-                }
-            } else {
-                if (yych <= 'e') {
-                    if (yych <= '\\') {
-                        if (yych <= '@') {
-                            if (yych <= '=') goto yy16;
-                            goto yy33;
-                        } else {
-                            if (yych <= 'Z') goto yy29;
-                            if (yych <= '[') goto yy10;
-                            goto yy33;
-                        }
-                    } else {
-                        if (yych <= '^') {
-                            if (yych <= ']') goto yy12;
-                            goto yy33;
-                        } else {
-                            if (yych == '`') goto yy33;
-                            goto yy29;
-                        }
-                    }
-                } else {
-                    if (yych <= 't') {
-                        if (yych <= 'm') {
-                            if (yych <= 'f') goto yy27;
-                            goto yy29;
-                        } else {
-                            if (yych <= 'n') goto yy28;
-                            if (yych <= 's') goto yy29;
-                            goto yy25;
-                        }
-                    } else {
-                        if (yych <= '{') {
-                            if (yych <= 'z') goto yy29;
-                            goto yy6;
-                        } else {
-                            if (yych == '}') goto yy8;
-                            goto yy33;
-                        }
-                    }
-                }
-            }
-yy2:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy126;
-yy3:
-            {
-                continue; 
-            }
-yy4:
-            yyaccept = 0;
-            ++YYCURSOR;
-            YYMARKER = YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych == '*') goto yy108;
-            if (yych == '/') goto yy110;
-yy5:
-            {
-                context->token = TOK_INVALID;
-                return;
-            }
-yy6:
-            ++YYCURSOR;
-            {
-                token = TOK_LEFT_CURLY_BRACKET;
-                goto done;
-            }
-yy8:
-            ++YYCURSOR;
-            {
-                token = TOK_RIGHT_CURLY_BRACKET;
-                goto done;
-            }
-yy10:
-            ++YYCURSOR;
-            {
-                token = TOK_LEFT_BRACKET;
-                goto done;
-            }
-yy12:
-            ++YYCURSOR;
-            {
-                token = TOK_RIGHT_BRACKET;
-                goto done;
-            }
-yy14:
-            ++YYCURSOR;
-            {
-                token = TOK_COLON;
-                goto done;
-            }
-yy16:
-            ++YYCURSOR;
-            {
-                token = TOK_EQUAL;
-                goto done;
-            }
-yy18:
-            ++YYCURSOR;
-            {
-                token = TOK_COMMA;
-                goto done;
-            }
-yy20:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 'X') {
-                if (yych <= '/') {
-                    if (yych == '.') goto yy100;
-                } else {
-                    if (yych <= '9') goto yy100;
-                    if (yych <= '@') goto yy21;
-                    if (yych <= 'W') goto yy100;
-                    goto yy104;
-                }
-            } else {
-                if (yych <= '`') {
-                    if (yych <= 'Z') goto yy100;
-                    if (yych == '_') goto yy100;
-                } else {
-                    if (yych == 'x') goto yy104;
-                    if (yych <= 'z') goto yy100;
-                }
-            }
-yy21:
-            {
-                token = TOK_DEC_NUMBER;
-                goto done;
-            }
-yy22:
-            yyaccept = 0;
-            ++YYCURSOR;
-            YYMARKER = YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '/') {
-                if (yych == '.') goto yy95;
-                goto yy5;
-            } else {
-                if (yych <= '0') goto yy92;
-                if (yych <= '9') goto yy93;
-                goto yy5;
-            }
-yy23:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy71;
-yy24:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '/') goto yy5;
-            if (yych <= '9') goto yy63;
-            goto yy5;
-yy25:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych == 'r') goto yy59;
-            goto yy49;
-yy26:
+            cursor = check->end + (check->table ? element_size(check->table) : 0);
+            --depth;
+            continue;
+        }
+
+        element = (mjson_element_t)cursor;
+        size    = check_entry(element, start, check ? check->end : end);
+
+        if (!size || (check && !check_child(check, element)))
+        {
+            failed = TRUE;
+            break;
+        }
+
+        cursor += size;
+
+        if (is_array(element) || is_dict(element))
+        {
+            if (depth == capacity)
             {
-                token = TOK_IDENTIFIER;
-                goto done;
-            }
-yy27:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych == 'a') goto yy54;
-            goto yy49;
-yy28:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych == 'u') goto yy50;
-            goto yy49;
-yy29:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy49;
-yy30:
-            yyaccept = 0;
-            ++YYCURSOR;
-            YYMARKER = YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 0x00) goto yy5;
-            goto yy35;
-yy31:
-            ++YYCURSOR;
-            { 
-                context->token = TOK_NONE;
-                return;
-            }
-yy33:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy5;
-yy34:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-yy35:
-            if (yych <= '"') {
-                if (yych <= 0x00) goto yy36;
-                if (yych <= '!') goto yy34;
-                goto yy38;
-            } else {
-                if (yych == '\\') goto yy37;
-                goto yy34;
-            }
-yy36:
-            YYCURSOR = YYMARKER;
-            if (yyaccept <= 2) {
-                if (yyaccept <= 1) {
-                    if (yyaccept == 0) {
-                        goto yy5;
-                    } else {
-                        goto yy65;
-                    }
-                } else {
-                    goto yy74;
-                }
-            } else {
-                if (yyaccept == 3) {
-                    goto yy21;
-                } else {
-                    goto yy120;
+                grown = (mjson_check_t*)realloc(stack == local_stack ? NULL : stack, sizeof(mjson_check_t) * capacity * 2);
+
+                if (!grown)
+                {
+                    failed = TRUE;
+                    break;
                 }
+
+                if (stack == local_stack)
+                    memcpy(grown, local_stack, sizeof(local_stack));
+
+                stack     = grown;
+                capacity *= 2;
             }
-yy37:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 'e') {
+
+            check = &stack[depth++];
+            check->end       = cursor + entry_length(element);
+            check->container = element;
+            check->table     = container_table(element);
+            check->count     = 0;
+        }
+    }
+    while (depth > 0);
+
+    if (stack != local_stack)
+        free(stack);
+
+    return !failed;
+}
+
+int mjson_write(mjson_element_t element, unsigned flags, char* buf, size_t buf_size, size_t* written)
+{
+    mjson_writer_t writer;
+    size_t         size;
+
+    RETURN_VAL_IF_FAIL(element, FALSE);
+    RETURN_VAL_IF_FAIL(buf || buf_size == 0, FALSE);
+
+    writer.buf       = (uint8_t*)buf;
+    writer.pos       = writer.buf;
+    writer.end       = writer.buf + buf_size;
+    writer.flushed   = 0;
+    writer.sink      = NULL;
+    writer.user_data = NULL;
+    writer.flags     = flags;
+    writer.depth     = 0;
+    writer.overflow  = FALSE;
+    writer.failed    = FALSE;
+
+    write_element(&writer, element);
+    size = writer_finish(&writer);
+
+    if (written)
+        *written = size;
+
+    if (writer.overflow || writer.failed)
+        return FALSE;
+
+    if (size < buf_size)
+        buf[size] = 0;
+
+    return TRUE;
+}
+
+int mjson_write_sink(mjson_element_t element, unsigned flags, mjson_write_func_t sink, void* user_data)
+{
+    mjson_writer_t writer;
+
+    RETURN_VAL_IF_FAIL(element, FALSE);
+    RETURN_VAL_IF_FAIL(sink, FALSE);
+
+    writer.buf       = writer.chunk;
+    writer.pos       = writer.buf;
+    writer.end       = writer.buf + WRITE_CHUNK_SIZE;
+    writer.flushed   = 0;
+    writer.sink      = sink;
+    writer.user_data = user_data;
+    writer.flags     = flags;
+    writer.depth     = 0;
+    writer.overflow  = FALSE;
+    writer.failed    = FALSE;
+
+    write_element(&writer, element);
+    writer_finish(&writer);
+
+    return !writer.failed;
+}
+
+mjson_element_t mjson_get_element_first(mjson_element_t array)
+{
+    RETURN_VAL_IF_FAIL(array, NULL);
+    RETURN_VAL_IF_FAIL(is_array(array), NULL);
+    RETURN_VAL_IF_FAIL(entry_length(array) > 0, NULL);
+    
+    return (mjson_element_t)entry_data(array);
+}
+
+mjson_element_t mjson_get_element_next(mjson_element_t array, mjson_element_t current_value)
+{
+    mjson_element_t next = NULL;
+
+    RETURN_VAL_IF_FAIL(array, NULL);
+    RETURN_VAL_IF_FAIL(current_value, NULL);
+    RETURN_VAL_IF_FAIL(is_array(array), NULL);
+    RETURN_VAL_IF_FAIL(entry_data(array) + entry_length(array) > (const uint8_t*)current_value, NULL);
+    
+    next = next_element(current_value);
+    
+    RETURN_VAL_IF_FAIL(entry_data(array) + entry_length(array) > (const uint8_t*)next, NULL);
+    
+    return next;
+}
+
+int mjson_cursor_enter(mjson_cursor_t* cursor, mjson_element_t container)
+{
+    const uint8_t* data;
+
+    cursor->key   = NULL;
+    cursor->value = NULL;
+    cursor->end   = NULL;
+
+    RETURN_VAL_IF_FAIL(container, FALSE);
+    RETURN_VAL_IF_FAIL(is_array(container) || is_dict(container), FALSE);
+
+    data          = entry_data(container);
+    cursor->end   = data + entry_length(container);
+    cursor->value = (mjson_element_t)data;
+
+    if (is_dict(container))
+    {
+        cursor->key = (mjson_element_t)data;
+        if (data < (const uint8_t*)cursor->end)
+            cursor->value = (mjson_element_t)(data + entry_size(cursor->key));
+    }
+
+    return TRUE;
+}
+
+// Key of the next member is never past end, so only value needs the check.
+void mjson_cursor_next(mjson_cursor_t* cursor)
+{
+    const uint8_t* next = (const uint8_t*)cursor->value + entry_size(cursor->value);
+
+    cursor->value = (mjson_element_t)next;
+
+    if (cursor->key)
+    {
+        cursor->key = (mjson_element_t)next;
+        if (next < (const uint8_t*)cursor->end)
+            cursor->value = (mjson_element_t)(next + entry_size(cursor->key));
+    }
+}
+
+// Accessors are also defined as macros in mjson.h, hence the parentheses.
+int (mjson_cursor_at_end)(const mjson_cursor_t* cursor)
+{
+    return (const void*)cursor->value == cursor->end;
+}
+
+mjson_element_t (mjson_cursor_key)(const mjson_cursor_t* cursor)
+{
+    return cursor->key;
+}
+
+mjson_element_t (mjson_cursor_value)(const mjson_cursor_t* cursor)
+{
+    return cursor->value;
+}
+
+mjson_element_t mjson_get_element(mjson_element_t array, int index)
+{
+    mjson_element_t result, table;
+
+    RETURN_VAL_IF_FAIL(index >= 0, NULL);
+
+    table = container_table(array);
+
+    if (table && mjson_get_type(array) == MJSON_ID_ARRAY32)
+    {
+        RETURN_VAL_IF_FAIL((uint32_t)index < table->val_u32 / sizeof(uint32_t), NULL);
+
+        return (mjson_element_t)((const uint8_t*)array + ((const uint32_t*)(table + 1))[index]);
+    }
+    
+    result = mjson_get_element_first(array);
+    while (result && index--)
+        result = mjson_get_element_next(array, result);
+    
+    return result;
+}
+
+int mjson_get_array_length(mjson_element_t array)
+{
+    mjson_element_t element, table;
+    int             length = 0;
+
+    RETURN_VAL_IF_FAIL(array, 0);
+    RETURN_VAL_IF_FAIL(is_array(array), 0);
+
+    table = container_table(array);
+    if (table)
+        return (int)(table->val_u32 / sizeof(uint32_t));
+
+    for (element = mjson_get_element_first(array); element; element = mjson_get_element_next(array, element))
+        ++length;
+
+    return length;
+}
+
+mjson_element_t mjson_get_member_first(mjson_element_t dictionary, mjson_element_t* value)
+{
+    mjson_element_t key;
+
+    RETURN_VAL_IF_FAIL(dictionary, NULL);
+    RETURN_VAL_IF_FAIL(is_dict(dictionary), NULL);
+    RETURN_VAL_IF_FAIL(entry_length(dictionary) > 0, NULL);
+
+    key = (mjson_element_t)entry_data(dictionary);
+    RETURN_VAL_IF_FAIL(is_key(key), NULL);
+    
+    *value = next_element(key);
+    
+    return key;
+}
+
+mjson_element_t mjson_get_member_next(mjson_element_t dictionary, mjson_element_t current_key, mjson_element_t* next_value)
+{
+    mjson_element_t next_key = NULL;
+
+    RETURN_VAL_IF_FAIL(dictionary, NULL);
+    RETURN_VAL_IF_FAIL(is_dict(dictionary), NULL);
+    RETURN_VAL_IF_FAIL(current_key, NULL);
+    RETURN_VAL_IF_FAIL(entry_data(dictionary) + entry_length(dictionary) > (const uint8_t*)current_key, NULL);
+    RETURN_VAL_IF_FAIL(is_key(current_key), NULL);
+    
+    next_key = next_element(current_key);
+    next_key = next_element(next_key);
+    
+    RETURN_VAL_IF_FAIL(next_key, NULL);
+    RETURN_VAL_IF_FAIL(entry_data(dictionary) + entry_length(dictionary) > (const uint8_t*)next_key, NULL);
+    RETURN_VAL_IF_FAIL(is_key(next_key), NULL);
+
+    *next_value = next_element(next_key);
+   
+    return next_key;    
+}
+
+mjson_element_t mjson_get_member(mjson_element_t dictionary, const char* name)
+{
+    size_t len;
+
+    RETURN_VAL_IF_FAIL(name, NULL);
+
+    len = strlen(name);
+
+    // hash is only needed by lookup table
+    return find_member(dictionary, name, len, container_table(dictionary) ? hash_key((const uint8_t*)name, len) : 0);
+}
+
+mjson_element_t mjson_get_member_hashed(mjson_element_t dictionary, const char* name, size_t len, uint32_t hash)
+{
+    RETURN_VAL_IF_FAIL(name || len == 0, NULL);
+
+    return find_member(dictionary, name, len, hash);
+}
+
+// Value of member with name of len bytes, hash is hash_key of name
+static mjson_element_t find_member(mjson_element_t dictionary, const char* name, size_t len, uint32_t hash)
+{
+    mjson_element_t key, result, table, str;
+    const uint32_t* slots;
+    uint32_t        mask, i;
+
+    table = container_table(dictionary);
+
+    if (table && mjson_get_type(dictionary) == MJSON_ID_DICT32)
+    {
+        // open addressing with linear probing, slot is {hash, key offset}
+        slots = (const uint32_t*)(table + 1);
+        mask  = table->val_u32 / (2 * sizeof(uint32_t)) - 1;
+
+        for (i = hash & mask; slots[2*i+1] != 0; i = (i + 1) & mask)
+        {
+            if (slots[2*i] != hash)
+                continue;
+
+            key = (mjson_element_t)((const uint8_t*)dictionary + slots[2*i+1]);
+            str = string_target(key);
+            if (entry_length(str) == len && memcmp(entry_data(str), name, len) == 0)
+                return next_element(key);
+        }
+
+        return NULL;
+    }
+
+    key = mjson_get_member_first(dictionary, &result);
+    while (key)
+    {
+        str = string_target(key);
+        if (entry_length(str) == len && memcmp(name, entry_data(str), len) == 0)
+            return result;
+        key = mjson_get_member_next(dictionary, key, &result);
+    }
+    
+    return NULL;
+}
+
+int mjson_get_type(mjson_element_t element)
+{
+    RETURN_VAL_IF_FAIL(element, MJSON_ID_NULL);
+    
+    return element->id & MJSON_ID_MASK;
+}
+
+const char* mjson_get_string(mjson_element_t element, const char* fallback)
+{
+    RETURN_VAL_IF_FAIL(element, fallback);
+    RETURN_VAL_IF_FAIL(mjson_get_type(element) == MJSON_ID_UTF8_STRING32 ||
+                       mjson_get_type(element) == MJSON_ID_UTF8_STRING64 ||
+                       is_key(element),
+                       fallback);
+    
+    return (const char*)entry_data(string_target(element));
+}
+
+int32_t mjson_get_int(mjson_element_t element, int32_t fallback)
+{
+    RETURN_VAL_IF_FAIL(element, fallback);
+    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_SINT32, fallback);
+    
+    return element->val_s32;
+}
+
+int64_t mjson_get_int64(mjson_element_t element, int64_t fallback)
+{
+    uint64_t value;
+
+    RETURN_VAL_IF_FAIL(element, fallback);
+
+    switch (element->id)
+    {
+        case MJSON_ID_SINT32:
+            return element->val_s32;
+        case MJSON_ID_UINT32:
+            return element->val_u32;
+        case MJSON_ID_SINT64:
+            return (int64_t)entry_payload_u64(element);
+        case MJSON_ID_UINT64:
+            value = entry_payload_u64(element);
+            RETURN_VAL_IF_FAIL(value <= 0x7FFFFFFFFFFFFFFFull, fallback);
+            return (int64_t)value;
+    }
+
+    return fallback;
+}
+
+uint64_t mjson_get_uint64(mjson_element_t element, uint64_t fallback)
+{
+    int64_t value;
+
+    RETURN_VAL_IF_FAIL(element, fallback);
+
+    switch (element->id)
+    {
+        case MJSON_ID_SINT32:
+            RETURN_VAL_IF_FAIL(element->val_s32 >= 0, fallback);
+            return (uint64_t)element->val_s32;
+        case MJSON_ID_UINT32:
+            return element->val_u32;
+        case MJSON_ID_SINT64:
+            value = (int64_t)entry_payload_u64(element);
+            RETURN_VAL_IF_FAIL(value >= 0, fallback);
+            return (uint64_t)value;
+        case MJSON_ID_UINT64:
+            return entry_payload_u64(element);
+    }
+
+    return fallback;
+}
+
+float mjson_get_float(mjson_element_t element, float fallback)
+{
+    RETURN_VAL_IF_FAIL(element, fallback);
+    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_FLOAT32 || element->id == MJSON_ID_FLOAT64, fallback);
+
+    if (element->id == MJSON_ID_FLOAT64)
+        return (float)mjson_get_double(element, fallback);
+
+    return element->val_f32;
+}
+
+double mjson_get_double(mjson_element_t element, double fallback)
+{
+    uint64_t bits;
+    double   value;
+
+    RETURN_VAL_IF_FAIL(element, fallback);
+    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_FLOAT32 || element->id == MJSON_ID_FLOAT64, fallback);
+
+    if (element->id == MJSON_ID_FLOAT32)
+        return element->val_f32;
+
+    bits = entry_payload_u64(element);
+    memcpy(&value, &bits, sizeof(value));
+
+    return value;
+}
+
+int mjson_get_bool(mjson_element_t element, int fallback)
+{
+    RETURN_VAL_IF_FAIL(element, fallback);
+    RETURN_VAL_IF_FAIL(element->id == MJSON_ID_TRUE || element->id == MJSON_ID_FALSE, fallback);
+    
+    return element->id == MJSON_ID_TRUE;
+}
+
+int mjson_is_null(mjson_element_t element)
+{
+    RETURN_VAL_IF_FAIL(element, TRUE);
+
+    return element->id == MJSON_ID_NULL;
+}
+
+mjson_path_t* mjson_path_compile(const char* text)
+{
+    mjson_path_t* path;
+    size_t        len;
+    int           result;
+
+    RETURN_VAL_IF_FAIL(text, NULL);
+
+    // every byte may start a segment, unescaped keys are not longer than text
+    len  = strlen(text);
+    path = (mjson_path_t*)malloc(sizeof(mjson_path_t) + (len + 1) * sizeof(mjson_path_segment_t) + len + 1);
+    RETURN_VAL_IF_FAIL(path, NULL);
+
+    path->count    = 0;
+    path->segments = (mjson_path_segment_t*)(path + 1);
+
+    if (text[0] == '/')
+        result = path_parse_pointer(path, text, (char*)(path->segments + len + 1));
+    else
+        result = path_parse_dotted(path, text, (char*)(path->segments + len + 1));
+
+    if (!result)
+    {
+        free(path);
+        return NULL;
+    }
+
+    return path;
+}
+
+void mjson_path_free(mjson_path_t* path)
+{
+    free(path);
+}
+
+mjson_lazy_t mjson_lazy_open(const char* json_data, size_t json_data_size)
+{
+    mjson_lazy_t   result = { NULL, NULL, FALSE };
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data, (uint8_t*)json_data + json_data_size,
+        NULL, NULL,
+        NULL, 0
+    };
+
+    RETURN_VAL_IF_FAIL(json_data, result);
+
+    parsectx_next_token(&c);
+
+    result.begin = json_data;
+    result.end   = json_data + json_data_size;
+    result.bare  = c.token != TOK_LEFT_BRACKET && c.token != TOK_LEFT_CURLY_BRACKET;
+
+    if (!result.bare)
+        result.begin = (const char*)c.start;
+
+    return result;
+}
+
+mjson_lazy_t mjson_lazy_get_member(mjson_lazy_t dictionary, const char* name)
+{
+    mjson_lazy_t   missing = { NULL, NULL, FALSE };
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)dictionary.begin, (uint8_t*)dictionary.end,
+        NULL, NULL,
+        NULL, 0
+    };
+    const uint8_t* key;
+    size_t         key_len, len;
+    int            stop_token = TOK_NONE;
+    int            expect_separator = FALSE;
+
+    RETURN_VAL_IF_FAIL(dictionary.begin && name, missing);
+
+    len = strlen(name);
+
+    if (!dictionary.bare)
+    {
+        parsectx_next_token(&c);
+        RETURN_VAL_IF_FAIL(c.token == TOK_LEFT_CURLY_BRACKET, missing);
+        stop_token = TOK_RIGHT_CURLY_BRACKET;
+    }
+
+    parsectx_next_token(&c);
+
+    // same grammar as parse_key_value_pair, values of other keys are skipped
+    while (c.token != stop_token)
+    {
+        if (expect_separator && c.token == TOK_COMMA)
+            parsectx_next_token(&c);
+        else
+            expect_separator = TRUE;
+
+        RETURN_VAL_IF_FAIL(c.token == TOK_IDENTIFIER || c.token == TOK_NOESC_STRING, missing);
+
+        key     = c.start + (c.token == TOK_NOESC_STRING);
+        key_len = c.next - c.start - 2 * (c.token == TOK_NOESC_STRING);
+
+        parsectx_next_token(&c);
+        RETURN_VAL_IF_FAIL(c.token == TOK_COLON || c.token == TOK_EQUAL, missing);
+        parsectx_next_token(&c);
+
+        if (key_len == len && memcmp(key, name, len) == 0)
+            return lazy_value(&c, dictionary.end);
+
+        RETURN_VAL_IF_FAIL(lazy_skip_value(&c), missing);
+    }
+
+    return missing;
+}
+
+mjson_lazy_t mjson_lazy_get_element(mjson_lazy_t array, int index)
+{
+    mjson_lazy_t   missing = { NULL, NULL, FALSE };
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)array.begin, (uint8_t*)array.end,
+        NULL, NULL,
+        NULL, 0
+    };
+    int            expect_separator = FALSE;
+
+    RETURN_VAL_IF_FAIL(array.begin && !array.bare && index >= 0, missing);
+
+    parsectx_next_token(&c);
+    RETURN_VAL_IF_FAIL(c.token == TOK_LEFT_BRACKET, missing);
+    parsectx_next_token(&c);
+
+    while (c.token != TOK_RIGHT_BRACKET)
+    {
+        if (expect_separator && c.token == TOK_COMMA)
+            parsectx_next_token(&c);
+        else
+            expect_separator = TRUE;
+
+        if (index-- == 0)
+            return lazy_value(&c, array.end);
+
+        RETURN_VAL_IF_FAIL(lazy_skip_value(&c), missing);
+    }
+
+    return missing;
+}
+
+int mjson_lazy_get_type(mjson_lazy_t element)
+{
+    uint32_t       entry[3];
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)element.begin, (uint8_t*)element.end,
+        NULL, NULL,
+        NULL, 0
+    };
+
+    RETURN_VAL_IF_FAIL(element.begin, MJSON_ID_NULL);
+    RETURN_VAL_IF_FAIL(!element.bare, MJSON_ID_DICT32);
+
+    parsectx_next_token(&c);
+
+    switch (c.token)
+    {
+        case TOK_LEFT_CURLY_BRACKET:
+            return MJSON_ID_DICT32;
+        case TOK_LEFT_BRACKET:
+            return MJSON_ID_ARRAY32;
+        case TOK_NOESC_STRING:
+        case TOK_STRING:
+            return MJSON_ID_UTF8_STRING32;
+    }
+
+    return mjson_get_type(lazy_scalar(element, entry));
+}
+
+const char* mjson_lazy_get_string(mjson_lazy_t element, char* buf, size_t buf_size, const char* fallback)
+{
+    uint8_t*       str_end;
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)element.begin, (uint8_t*)element.end,
+        NULL, NULL,
+        NULL, 0
+    };
+
+    RETURN_VAL_IF_FAIL(element.begin && !element.bare && buf, fallback);
+
+    parsectx_next_token(&c);
+
+    if (c.token == TOK_NOESC_STRING)
+    {
+        RETURN_VAL_IF_FAIL((size_t)(c.next - c.start - 2) < buf_size, fallback);
+        memcpy(buf, c.start + 1, c.next - c.start - 2);
+        buf[c.next - c.start - 2] = 0;
+        return buf;
+    }
+
+    RETURN_VAL_IF_FAIL(c.token == TOK_STRING, fallback);
+
+    str_end = decode_string(c.start + 1, c.next - 1, (uint8_t*)buf, (uint8_t*)buf + buf_size);
+    RETURN_VAL_IF_FAIL(str_end && str_end < (uint8_t*)buf + buf_size, fallback);
+    *str_end = 0;
+
+    return buf;
+}
+
+int32_t mjson_lazy_get_int(mjson_lazy_t element, int32_t fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_int(lazy_scalar(element, entry), fallback);
+}
+
+int64_t mjson_lazy_get_int64(mjson_lazy_t element, int64_t fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_int64(lazy_scalar(element, entry), fallback);
+}
+
+uint64_t mjson_lazy_get_uint64(mjson_lazy_t element, uint64_t fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_uint64(lazy_scalar(element, entry), fallback);
+}
+
+float mjson_lazy_get_float(mjson_lazy_t element, float fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_float(lazy_scalar(element, entry), fallback);
+}
+
+double mjson_lazy_get_double(mjson_lazy_t element, double fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_double(lazy_scalar(element, entry), fallback);
+}
+
+int mjson_lazy_get_bool(mjson_lazy_t element, int fallback)
+{
+    uint32_t entry[3];
+
+    return mjson_get_bool(lazy_scalar(element, entry), fallback);
+}
+
+int mjson_lazy_is_null(mjson_lazy_t element)
+{
+    uint32_t        entry[3];
+    mjson_element_t scalar;
+
+    RETURN_VAL_IF_FAIL(element.begin, TRUE);
+
+    scalar = lazy_scalar(element, entry);
+
+    return scalar && scalar->id == MJSON_ID_NULL;
+}
+
+int mjson_lazy_parse(mjson_lazy_t element, void* storage_buf, size_t storage_buf_size, unsigned flags, mjson_element_t* top_element)
+{
+    const uint8_t* end = (const uint8_t*)element.end;
+
+    *top_element = NULL;
+
+    RETURN_VAL_IF_FAIL(element.begin, FALSE);
+
+    if (!element.bare)
+    {
+        RETURN_VAL_IF_FAIL(*element.begin == '{' || *element.begin == '[', FALSE);
+        end = lazy_skip_container((uint8_t*)element.begin, (uint8_t*)element.end);
+        RETURN_VAL_IF_FAIL(end, FALSE);
+    }
+
+    return mjson_parse_with_flags(element.begin, end - (const uint8_t*)element.begin, storage_buf, storage_buf_size, flags, top_element);
+}
+
+int mjson_bind(const char *json_data, size_t json_data_size, const mjson_schema_t* schema, void* out)
+{
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)json_data, (uint8_t*)json_data + json_data_size,
+        NULL, NULL,
+        NULL, 0
+    };
+    int stop_token = TOK_NONE;
+
+    RETURN_VAL_IF_FAIL(schema && out, FALSE);
+
+    parsectx_next_token(&c);
+
+    if (c.token == TOK_LEFT_CURLY_BRACKET)
+    {
+        stop_token = TOK_RIGHT_CURLY_BRACKET;
+        parsectx_next_token(&c);
+    }
+
+    RETURN_VAL_IF_FAIL(bind_object(&c, schema, (uint8_t*)out, stop_token), FALSE);
+
+    return c.token == TOK_NONE;
+}
+
+mjson_element_t mjson_path_eval(mjson_element_t element, const mjson_path_t* path)
+{
+    const mjson_path_segment_t* segment;
+    size_t                      i;
+
+    RETURN_VAL_IF_FAIL(path, NULL);
+
+    for (i = 0; i < path->count && element; ++i)
+    {
+        segment = &path->segments[i];
+
+        if (segment->key && is_dict(element))
+            element = find_member(element, segment->key, segment->len, segment->hash);
+        else if (segment->index >= 0 && is_array(element))
+            element = mjson_get_element(element, segment->index);
+        else
+            element = NULL;
+    }
+
+    return element;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// API helpers
+/////////////////////////////////////////////////////////////////////////////
+
+static size_t element_size(mjson_element_t element)
+{
+    RETURN_VAL_IF_FAIL(element, 0);
+
+    return entry_size(element);
+}
+
+// element_size without checks, for cursors over valid blobs
+static size_t entry_size(mjson_element_t element)
+{
+    static const uint8_t scalar_size[MJSON_ID_UTF8_KEY32] = { 4, 4, 4, 4, 8, 12, 8, 12, 8, 12 };
+    mjson_element_t      table;
+
+    // scalars never have flags, so id is their type
+    if (element->id < MJSON_ID_UTF8_KEY32)
+        return scalar_size[element->id];
+
+    switch(element->id & MJSON_ID_MASK)
+    {
+        case MJSON_ID_NULL:
+        case MJSON_ID_FALSE:
+        case MJSON_ID_EMPTY_STRING:
+        case MJSON_ID_TRUE:
+            return sizeof(uint32_t);
+
+        case MJSON_ID_UINT32:
+        case MJSON_ID_SINT32:
+        case MJSON_ID_FLOAT32:
+            return sizeof(mjson_entry_t);
+
+        case MJSON_ID_UINT64:
+        case MJSON_ID_SINT64:
+        case MJSON_ID_FLOAT64:
+            return sizeof(uint32_t) + sizeof(uint64_t);
+
+        case MJSON_ID_UTF8_KEY32:
+        case MJSON_ID_UTF8_STRING32:
+            if (element->id & MJSON_FLAG_REF)
+                return sizeof(mjson_entry_t);
+            return sizeof(mjson_entry_t) + ((element->val_u32 + 1 + 3) & (~3));
+
+        case MJSON_ID_UTF8_KEY64:
+        case MJSON_ID_UTF8_STRING64:
+            return sizeof(uint32_t) + sizeof(uint64_t) + ((entry_length(element) + 1 + 3) & (~(size_t)3));
+
+        case MJSON_ID_BINARY32:
+            return sizeof(mjson_entry_t) + ((element->val_u32 + 3) & (~3));
+
+        case MJSON_ID_BINARY64:
+            return sizeof(uint32_t) + sizeof(uint64_t) + ((entry_length(element) + 3) & (~(size_t)3));
+
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_DICT32:
+            if (!(element->id & MJSON_FLAG_TABLE))
+                return sizeof(mjson_entry_t) + element->val_u32;
+            table = (mjson_element_t)((const uint8_t*)(element + 1) + element->val_u32);
+            return sizeof(mjson_entry_t) + element->val_u32 + sizeof(mjson_entry_t) + ((table->val_u32 + 3) & (~3));
+
+        case MJSON_ID_ARRAY64:
+        case MJSON_ID_DICT64:
+            return sizeof(uint32_t) + sizeof(uint64_t) + entry_length(element);
+    };
+
+    return 0;
+}
+
+// Lookup table which follows container or NULL if there is none
+static mjson_element_t container_table(mjson_element_t element)
+{
+    RETURN_VAL_IF_FAIL(element, NULL);
+    RETURN_VAL_IF_FAIL(element->id & MJSON_FLAG_TABLE, NULL);
+
+    return (mjson_element_t)(entry_data(element) + entry_length(element));
+}
+
+// String which holds data of possibly interned string element
+static mjson_element_t string_target(mjson_element_t element)
+{
+    if (element->id & MJSON_FLAG_REF)
+        return (mjson_element_t)((const uint8_t*)element - element->val_u32);
+
+    return element;
+}
+
+// RFC 6901: "/a/0/b~1c", ~0 and ~1 stand for ~ and /
+static int path_parse_pointer(mjson_path_t* path, const char* text, char* keys)
+{
+    mjson_path_segment_t* segment;
+
+    while (*text == '/')
+    {
+        segment      = &path->segments[path->count++];
+        segment->key = keys;
+
+        for (++text; *text && *text != '/'; ++text)
+        {
+            if (*text == '~')
+            {
+                ++text;
+                RETURN_VAL_IF_FAIL(*text == '0' || *text == '1', FALSE);
+                *keys++ = *text == '0' ? '~' : '/';
+            }
+            else
+            {
+                *keys++ = *text;
+            }
+        }
+
+        segment->len   = keys - segment->key;
+        segment->hash  = hash_key((const uint8_t*)segment->key, segment->len);
+        segment->index = path_index(segment->key, segment->len);
+    }
+
+    return TRUE;
+}
+
+// "a.b[3].c", keys can not contain dots or brackets and are not empty
+static int path_parse_dotted(mjson_path_t* path, const char* text, char* keys)
+{
+    mjson_path_segment_t* segment;
+    const char*           begin;
+
+    while (*text)
+    {
+        segment = &path->segments[path->count++];
+
+        if (*text == '[')
+        {
+            for (begin = ++text; *text >= '0' && *text <= '9'; ++text);
+            RETURN_VAL_IF_FAIL(*text == ']', FALSE);
+
+            segment->key   = NULL;
+            segment->len   = 0;
+            segment->hash  = 0;
+            segment->index = path_index(begin, text - begin);
+            RETURN_VAL_IF_FAIL(segment->index >= 0, FALSE);
+            ++text;
+        }
+        else
+        {
+            for (segment->key = keys; *text && *text != '.' && *text != '[' && *text != ']'; ++text)
+                *keys++ = *text;
+
+            segment->len   = keys - segment->key;
+            segment->hash  = hash_key((const uint8_t*)segment->key, segment->len);
+            segment->index = -1;
+            RETURN_VAL_IF_FAIL(segment->len > 0, FALSE);
+        }
+
+        if (*text == '.')
+        {
+            ++text;
+            RETURN_VAL_IF_FAIL(*text && *text != '[', FALSE);
+        }
+        else
+        {
+            RETURN_VAL_IF_FAIL(*text == '\0' || *text == '[', FALSE);
+        }
+    }
+
+    return TRUE;
+}
+
+// Decimal without leading zeros or -1, limited to what fits in int
+static int path_index(const char* text, size_t len)
+{
+    int    index = 0;
+    size_t i;
+
+    RETURN_VAL_IF_FAIL(len > 0 && len <= PATH_MAX_INDEX_DIGITS, -1);
+    RETURN_VAL_IF_FAIL(text[0] != '0' || len == 1, -1);
+
+    for (i = 0; i < len; ++i)
+    {
+        RETURN_VAL_IF_FAIL(text[i] >= '0' && text[i] <= '9', -1);
+        index = index * 10 + (text[i] - '0');
+    }
+
+    return index;
+}
+
+// FNV-1a
+static uint32_t hash_key(const uint8_t* key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    while (len--)
+        hash = (hash ^ *key++) * 16777619u;
+
+    return hash;
+}
+
+static uint64_t entry_payload_u64(mjson_element_t element)
+{
+    uint64_t value;
+
+    // 64 bit payload is only 4 byte aligned
+    memcpy(&value, (const uint8_t*)element + sizeof(uint32_t), sizeof(value));
+
+    return value;
+}
+
+// Data of string, binary or container, after 32 or 64 bit size
+static const uint8_t* entry_data(mjson_element_t element)
+{
+    if (MJSON_IS_ID64(mjson_get_type(element)))
+        return (const uint8_t*)element + sizeof(uint32_t) + sizeof(uint64_t);
+
+    return (const uint8_t*)(element + 1);
+}
+
+static size_t entry_length(mjson_element_t element)
+{
+    if (MJSON_IS_ID64(mjson_get_type(element)))
+        return (size_t)entry_payload_u64(element);
+
+    return element->val_u32;
+}
+
+static int is_array(mjson_element_t element)
+{
+    return mjson_get_type(element) == MJSON_ID_ARRAY32 || mjson_get_type(element) == MJSON_ID_ARRAY64;
+}
+
+static int is_dict(mjson_element_t element)
+{
+    return mjson_get_type(element) == MJSON_ID_DICT32 || mjson_get_type(element) == MJSON_ID_DICT64;
+}
+
+static int is_key(mjson_element_t element)
+{
+    return mjson_get_type(element) == MJSON_ID_UTF8_KEY32 || mjson_get_type(element) == MJSON_ID_UTF8_KEY64;
+}
+
+static mjson_element_t next_element(mjson_element_t element)
+{
+    size_t size;
+    
+    RETURN_VAL_IF_FAIL(element, 0);
+
+    size = element_size(element);
+    assert(size>0);
+    
+    return (mjson_element_t)((uint8_t*)element + size);
+}
+
+static void parsectx_advance_output(mjson_parser_t* ctx, ptrdiff_t size)
+{
+    ctx->bjson += size;
+}
+
+// Makes sure size bytes are available at ctx->bjson, growing the storage
+// with allocator if there is one. Storage may move, so parser keeps offsets
+// from bjson_start across calls which allocate output.
+static int parsectx_reserve_output(mjson_parser_t* ctx, ptrdiff_t size)
+{
+    uint8_t* buf;
+    size_t   used, capacity;
+
+    if (ctx->bjson_limit - ctx->bjson >= size)
+        return 1;
+
+    if (!ctx->allocator)
+        return 0;
+
+    used     = ctx->bjson       - ctx->bjson_start;
+    capacity = ctx->bjson_limit - ctx->bjson_start;
+    capacity = capacity * 2 > used + size ? capacity * 2 : used + size;
+
+    buf = (uint8_t*)ctx->allocator->grow(ctx->allocator->user_data, ctx->bjson_start, ctx->bjson_limit - ctx->bjson_start, capacity);
+
+    if (!buf) return 0;
+
+    ctx->bjson_start = buf;
+    ctx->bjson       = buf + used;
+    ctx->bjson_limit = buf + capacity;
+
+    return 1;
+}
+
+// Shrinks growable storage to used size once output is complete
+static void parsectx_trim_output(mjson_parser_t* ctx)
+{
+    uint8_t* buf;
+    size_t   used = ctx->bjson - ctx->bjson_start;
+
+    if (!ctx->allocator || used == (size_t)(ctx->bjson_limit - ctx->bjson_start))
+        return;
+
+    buf = (uint8_t*)ctx->allocator->grow(ctx->allocator->user_data, ctx->bjson_start, ctx->bjson_limit - ctx->bjson_start, used);
+
+    if (!buf) return;
+
+    ctx->bjson_start = buf;
+    ctx->bjson       = buf + used;
+    ctx->bjson_limit = buf + used;
+}
+
+static void* parsectx_allocate_output(mjson_parser_t* ctx, ptrdiff_t size)
+{
+    void* ptr;
+
+    if (!parsectx_reserve_output(ctx, size))
+        return 0;
+
+    ptr = ctx->bjson;
+    ctx->bjson += size;
+
+    return ptr;
+}
+
+// Entries are 4 byte aligned in 32 and 64 bit builds alike, 64 bit sizes
+// and payloads inside them are accessed with memcpy
+static int parsectx_align4_output(mjson_parser_t* ctx)
+{
+    ptrdiff_t padding = (4 - ((ptrdiff_t)ctx->bjson & 3)) & 3;
+
+    if (!parsectx_reserve_output(ctx, padding))
+        return 0;
+
+    // zero padding, so blob contents do not depend on storage contents
+    while (padding--)
+        *ctx->bjson++ = 0;
+
+    return 1;
+}
+
+static void unicode_cp_to_utf8(uint32_t uni_cp, uint8_t* utf8char/*[6]*/, size_t* charlen)
+{
+    uint32_t first, i;
+    
+    if (uni_cp < 0x80)
+    {
+        first   = 0;
+        *charlen = 1;
+    }
+    else if (uni_cp < 0x800)
+    {
+        first   = 0xc0;
+        *charlen = 2;
+    }
+    else if (uni_cp < 0x10000)
+    {
+        first   = 0xe0;
+        *charlen = 3;
+    }
+    else if (uni_cp < 0x200000)
+    {
+        first   = 0xf0;
+        *charlen = 4;
+    }
+    else if (uni_cp < 0x4000000)
+    {
+        first   = 0xf8;
+        *charlen = 5;
+    }
+    else
+    {
+        first   = 0xfc;
+        *charlen = 6;
+    }
+
+    for (i = *charlen - 1; i > 0; --i)
+    {
+        utf8char[i] = (uni_cp & 0x3f) | 0x80;
+        uni_cp >>= 6;
+    }
+    utf8char[0] = uni_cp | first;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Number decoding
+/////////////////////////////////////////////////////////////////////////////
+
+#define NUM_MAX_FAST_DIGITS   19
+#define NUM_MAX_SLOW_DIGITS   780
+#define NUM_MIN_POWER_OF_TEN  (-342)
+#define NUM_MAX_POWER_OF_TEN  308
+#define NUM_BIGINT_LIMBS      160
+
+// 128 most significant bits of 5^q for q in [-342, 308], used by Eisel-Lemire algorithm
+static const uint64_t power_of_five_128[][2] =
+{
+    {0xeef453d6923bd65aull, 0x113faa2906a13b3full}, // 5^-342
+    {0x9558b4661b6565f8ull, 0x4ac7ca59a424c507ull}, // 5^-341
+    {0xbaaee17fa23ebf76ull, 0x5d79bcf00d2df649ull}, // 5^-340
+    {0xe95a99df8ace6f53ull, 0xf4d82c2c107973dcull}, // 5^-339
+    {0x91d8a02bb6c10594ull, 0x79071b9b8a4be869ull}, // 5^-338
+    {0xb64ec836a47146f9ull, 0x9748e2826cdee284ull}, // 5^-337
+    {0xe3e27a444d8d98b7ull, 0xfd1b1b2308169b25ull}, // 5^-336
+    {0x8e6d8c6ab0787f72ull, 0xfe30f0f5e50e20f7ull}, // 5^-335
+    {0xb208ef855c969f4full, 0xbdbd2d335e51a935ull}, // 5^-334
+    {0xde8b2b66b3bc4723ull, 0xad2c788035e61382ull}, // 5^-333
+    {0x8b16fb203055ac76ull, 0x4c3bcb5021afcc31ull}, // 5^-332
+    {0xaddcb9e83c6b1793ull, 0xdf4abe242a1bbf3dull}, // 5^-331
+    {0xd953e8624b85dd78ull, 0xd71d6dad34a2af0dull}, // 5^-330
+    {0x87d4713d6f33aa6bull, 0x8672648c40e5ad68ull}, // 5^-329
+    {0xa9c98d8ccb009506ull, 0x680efdaf511f18c2ull}, // 5^-328
+    {0xd43bf0effdc0ba48ull, 0x0212bd1b2566def2ull}, // 5^-327
+    {0x84a57695fe98746dull, 0x014bb630f7604b57ull}, // 5^-326
+    {0xa5ced43b7e3e9188ull, 0x419ea3bd35385e2dull}, // 5^-325
+    {0xcf42894a5dce35eaull, 0x52064cac828675b9ull}, // 5^-324
+    {0x818995ce7aa0e1b2ull, 0x7343efebd1940993ull}, // 5^-323
+    {0xa1ebfb4219491a1full, 0x1014ebe6c5f90bf8ull}, // 5^-322
+    {0xca66fa129f9b60a6ull, 0xd41a26e077774ef6ull}, // 5^-321
+    {0xfd00b897478238d0ull, 0x8920b098955522b4ull}, // 5^-320
+    {0x9e20735e8cb16382ull, 0x55b46e5f5d5535b0ull}, // 5^-319
+    {0xc5a890362fddbc62ull, 0xeb2189f734aa831dull}, // 5^-318
+    {0xf712b443bbd52b7bull, 0xa5e9ec7501d523e4ull}, // 5^-317
+    {0x9a6bb0aa55653b2dull, 0x47b233c92125366eull}, // 5^-316
+    {0xc1069cd4eabe89f8ull, 0x999ec0bb696e840aull}, // 5^-315
+    {0xf148440a256e2c76ull, 0xc00670ea43ca250dull}, // 5^-314
+    {0x96cd2a865764dbcaull, 0x380406926a5e5728ull}, // 5^-313
+    {0xbc807527ed3e12bcull, 0xc605083704f5ecf2ull}, // 5^-312
+    {0xeba09271e88d976bull, 0xf7864a44c633682eull}, // 5^-311
+    {0x93445b8731587ea3ull, 0x7ab3ee6afbe0211dull}, // 5^-310
+    {0xb8157268fdae9e4cull, 0x5960ea05bad82964ull}, // 5^-309
+    {0xe61acf033d1a45dfull, 0x6fb92487298e33bdull}, // 5^-308
+    {0x8fd0c16206306babull, 0xa5d3b6d479f8e056ull}, // 5^-307
+    {0xb3c4f1ba87bc8696ull, 0x8f48a4899877186cull}, // 5^-306
+    {0xe0b62e2929aba83cull, 0x331acdabfe94de87ull}, // 5^-305
+    {0x8c71dcd9ba0b4925ull, 0x9ff0c08b7f1d0b14ull}, // 5^-304
+    {0xaf8e5410288e1b6full, 0x07ecf0ae5ee44dd9ull}, // 5^-303
+    {0xdb71e91432b1a24aull, 0xc9e82cd9f69d6150ull}, // 5^-302
+    {0x892731ac9faf056eull, 0xbe311c083a225cd2ull}, // 5^-301
+    {0xab70fe17c79ac6caull, 0x6dbd630a48aaf406ull}, // 5^-300
+    {0xd64d3d9db981787dull, 0x092cbbccdad5b108ull}, // 5^-299
+    {0x85f0468293f0eb4eull, 0x25bbf56008c58ea5ull}, // 5^-298
+    {0xa76c582338ed2621ull, 0xaf2af2b80af6f24eull}, // 5^-297
+    {0xd1476e2c07286faaull, 0x1af5af660db4aee1ull}, // 5^-296
+    {0x82cca4db847945caull, 0x50d98d9fc890ed4dull}, // 5^-295
+    {0xa37fce126597973cull, 0xe50ff107bab528a0ull}, // 5^-294
+    {0xcc5fc196fefd7d0cull, 0x1e53ed49a96272c8ull}, // 5^-293
+    {0xff77b1fcbebcdc4full, 0x25e8e89c13bb0f7aull}, // 5^-292
+    {0x9faacf3df73609b1ull, 0x77b191618c54e9acull}, // 5^-291
+    {0xc795830d75038c1dull, 0xd59df5b9ef6a2417ull}, // 5^-290
+    {0xf97ae3d0d2446f25ull, 0x4b0573286b44ad1dull}, // 5^-289
+    {0x9becce62836ac577ull, 0x4ee367f9430aec32ull}, // 5^-288
+    {0xc2e801fb244576d5ull, 0x229c41f793cda73full}, // 5^-287
+    {0xf3a20279ed56d48aull, 0x6b43527578c1110full}, // 5^-286
+    {0x9845418c345644d6ull, 0x830a13896b78aaa9ull}, // 5^-285
+    {0xbe5691ef416bd60cull, 0x23cc986bc656d553ull}, // 5^-284
+    {0xedec366b11c6cb8full, 0x2cbfbe86b7ec8aa8ull}, // 5^-283
+    {0x94b3a202eb1c3f39ull, 0x7bf7d71432f3d6a9ull}, // 5^-282
+    {0xb9e08a83a5e34f07ull, 0xdaf5ccd93fb0cc53ull}, // 5^-281
+    {0xe858ad248f5c22c9ull, 0xd1b3400f8f9cff68ull}, // 5^-280
+    {0x91376c36d99995beull, 0x23100809b9c21fa1ull}, // 5^-279
+    {0xb58547448ffffb2dull, 0xabd40a0c2832a78aull}, // 5^-278
+    {0xe2e69915b3fff9f9ull, 0x16c90c8f323f516cull}, // 5^-277
+    {0x8dd01fad907ffc3bull, 0xae3da7d97f6792e3ull}, // 5^-276
+    {0xb1442798f49ffb4aull, 0x99cd11cfdf41779cull}, // 5^-275
+    {0xdd95317f31c7fa1dull, 0x40405643d711d583ull}, // 5^-274
+    {0x8a7d3eef7f1cfc52ull, 0x482835ea666b2572ull}, // 5^-273
+    {0xad1c8eab5ee43b66ull, 0xda3243650005eecfull}, // 5^-272
+    {0xd863b256369d4a40ull, 0x90bed43e40076a82ull}, // 5^-271
+    {0x873e4f75e2224e68ull, 0x5a7744a6e804a291ull}, // 5^-270
+    {0xa90de3535aaae202ull, 0x711515d0a205cb36ull}, // 5^-269
+    {0xd3515c2831559a83ull, 0x0d5a5b44ca873e03ull}, // 5^-268
+    {0x8412d9991ed58091ull, 0xe858790afe9486c2ull}, // 5^-267
+    {0xa5178fff668ae0b6ull, 0x626e974dbe39a872ull}, // 5^-266
+    {0xce5d73ff402d98e3ull, 0xfb0a3d212dc8128full}, // 5^-265
+    {0x80fa687f881c7f8eull, 0x7ce66634bc9d0b99ull}, // 5^-264
+    {0xa139029f6a239f72ull, 0x1c1fffc1ebc44e80ull}, // 5^-263
+    {0xc987434744ac874eull, 0xa327ffb266b56220ull}, // 5^-262
+    {0xfbe9141915d7a922ull, 0x4bf1ff9f0062baa8ull}, // 5^-261
+    {0x9d71ac8fada6c9b5ull, 0x6f773fc3603db4a9ull}, // 5^-260
+    {0xc4ce17b399107c22ull, 0xcb550fb4384d21d3ull}, // 5^-259
+    {0xf6019da07f549b2bull, 0x7e2a53a146606a48ull}, // 5^-258
+    {0x99c102844f94e0fbull, 0x2eda7444cbfc426dull}, // 5^-257
+    {0xc0314325637a1939ull, 0xfa911155fefb5308ull}, // 5^-256
+    {0xf03d93eebc589f88ull, 0x793555ab7eba27caull}, // 5^-255
+    {0x96267c7535b763b5ull, 0x4bc1558b2f3458deull}, // 5^-254
+    {0xbbb01b9283253ca2ull, 0x9eb1aaedfb016f16ull}, // 5^-253
+    {0xea9c227723ee8bcbull, 0x465e15a979c1cadcull}, // 5^-252
+    {0x92a1958a7675175full, 0x0bfacd89ec191ec9ull}, // 5^-251
+    {0xb749faed14125d36ull, 0xcef980ec671f667bull}, // 5^-250
+    {0xe51c79a85916f484ull, 0x82b7e12780e7401aull}, // 5^-249
+    {0x8f31cc0937ae58d2ull, 0xd1b2ecb8b0908810ull}, // 5^-248
+    {0xb2fe3f0b8599ef07ull, 0x861fa7e6dcb4aa15ull}, // 5^-247
+    {0xdfbdcece67006ac9ull, 0x67a791e093e1d49aull}, // 5^-246
+    {0x8bd6a141006042bdull, 0xe0c8bb2c5c6d24e0ull}, // 5^-245
+    {0xaecc49914078536dull, 0x58fae9f773886e18ull}, // 5^-244
+    {0xda7f5bf590966848ull, 0xaf39a475506a899eull}, // 5^-243
+    {0x888f99797a5e012dull, 0x6d8406c952429603ull}, // 5^-242
+    {0xaab37fd7d8f58178ull, 0xc8e5087ba6d33b83ull}, // 5^-241
+    {0xd5605fcdcf32e1d6ull, 0xfb1e4a9a90880a64ull}, // 5^-240
+    {0x855c3be0a17fcd26ull, 0x5cf2eea09a55067full}, // 5^-239
+    {0xa6b34ad8c9dfc06full, 0xf42faa48c0ea481eull}, // 5^-238
+    {0xd0601d8efc57b08bull, 0xf13b94daf124da26ull}, // 5^-237
+    {0x823c12795db6ce57ull, 0x76c53d08d6b70858ull}, // 5^-236
+    {0xa2cb1717b52481edull, 0x54768c4b0c64ca6eull}, // 5^-235
+    {0xcb7ddcdda26da268ull, 0xa9942f5dcf7dfd09ull}, // 5^-234
+    {0xfe5d54150b090b02ull, 0xd3f93b35435d7c4cull}, // 5^-233
+    {0x9efa548d26e5a6e1ull, 0xc47bc5014a1a6dafull}, // 5^-232
+    {0xc6b8e9b0709f109aull, 0x359ab6419ca1091bull}, // 5^-231
+    {0xf867241c8cc6d4c0ull, 0xc30163d203c94b62ull}, // 5^-230
+    {0x9b407691d7fc44f8ull, 0x79e0de63425dcf1dull}, // 5^-229
+    {0xc21094364dfb5636ull, 0x985915fc12f542e4ull}, // 5^-228
+    {0xf294b943e17a2bc4ull, 0x3e6f5b7b17b2939dull}, // 5^-227
+    {0x979cf3ca6cec5b5aull, 0xa705992ceecf9c42ull}, // 5^-226
+    {0xbd8430bd08277231ull, 0x50c6ff782a838353ull}, // 5^-225
+    {0xece53cec4a314ebdull, 0xa4f8bf5635246428ull}, // 5^-224
+    {0x940f4613ae5ed136ull, 0x871b7795e136be99ull}, // 5^-223
+    {0xb913179899f68584ull, 0x28e2557b59846e3full}, // 5^-222
+    {0xe757dd7ec07426e5ull, 0x331aeada2fe589cfull}, // 5^-221
+    {0x9096ea6f3848984full, 0x3ff0d2c85def7621ull}, // 5^-220
+    {0xb4bca50b065abe63ull, 0x0fed077a756b53a9ull}, // 5^-219
+    {0xe1ebce4dc7f16dfbull, 0xd3e8495912c62894ull}, // 5^-218
+    {0x8d3360f09cf6e4bdull, 0x64712dd7abbbd95cull}, // 5^-217
+    {0xb080392cc4349decull, 0xbd8d794d96aacfb3ull}, // 5^-216
+    {0xdca04777f541c567ull, 0xecf0d7a0fc5583a0ull}, // 5^-215
+    {0x89e42caaf9491b60ull, 0xf41686c49db57244ull}, // 5^-214
+    {0xac5d37d5b79b6239ull, 0x311c2875c522ced5ull}, // 5^-213
+    {0xd77485cb25823ac7ull, 0x7d633293366b828bull}, // 5^-212
+    {0x86a8d39ef77164bcull, 0xae5dff9c02033197ull}, // 5^-211
+    {0xa8530886b54dbdebull, 0xd9f57f830283fdfcull}, // 5^-210
+    {0xd267caa862a12d66ull, 0xd072df63c324fd7bull}, // 5^-209
+    {0x8380dea93da4bc60ull, 0x4247cb9e59f71e6dull}, // 5^-208
+    {0xa46116538d0deb78ull, 0x52d9be85f074e608ull}, // 5^-207
+    {0xcd795be870516656ull, 0x67902e276c921f8bull}, // 5^-206
+    {0x806bd9714632dff6ull, 0x00ba1cd8a3db53b6ull}, // 5^-205
+    {0xa086cfcd97bf97f3ull, 0x80e8a40eccd228a4ull}, // 5^-204
+    {0xc8a883c0fdaf7df0ull, 0x6122cd128006b2cdull}, // 5^-203
+    {0xfad2a4b13d1b5d6cull, 0x796b805720085f81ull}, // 5^-202
+    {0x9cc3a6eec6311a63ull, 0xcbe3303674053bb0ull}, // 5^-201
+    {0xc3f490aa77bd60fcull, 0xbedbfc4411068a9cull}, // 5^-200
+    {0xf4f1b4d515acb93bull, 0xee92fb5515482d44ull}, // 5^-199
+    {0x991711052d8bf3c5ull, 0x751bdd152d4d1c4aull}, // 5^-198
+    {0xbf5cd54678eef0b6ull, 0xd262d45a78a0635dull}, // 5^-197
+    {0xef340a98172aace4ull, 0x86fb897116c87c34ull}, // 5^-196
+    {0x9580869f0e7aac0eull, 0xd45d35e6ae3d4da0ull}, // 5^-195
+    {0xbae0a846d2195712ull, 0x8974836059cca109ull}, // 5^-194
+    {0xe998d258869facd7ull, 0x2bd1a438703fc94bull}, // 5^-193
+    {0x91ff83775423cc06ull, 0x7b6306a34627ddcfull}, // 5^-192
+    {0xb67f6455292cbf08ull, 0x1a3bc84c17b1d542ull}, // 5^-191
+    {0xe41f3d6a7377eecaull, 0x20caba5f1d9e4a93ull}, // 5^-190
+    {0x8e938662882af53eull, 0x547eb47b7282ee9cull}, // 5^-189
+    {0xb23867fb2a35b28dull, 0xe99e619a4f23aa43ull}, // 5^-188
+    {0xdec681f9f4c31f31ull, 0x6405fa00e2ec94d4ull}, // 5^-187
+    {0x8b3c113c38f9f37eull, 0xde83bc408dd3dd04ull}, // 5^-186
+    {0xae0b158b4738705eull, 0x9624ab50b148d445ull}, // 5^-185
+    {0xd98ddaee19068c76ull, 0x3badd624dd9b0957ull}, // 5^-184
+    {0x87f8a8d4cfa417c9ull, 0xe54ca5d70a80e5d6ull}, // 5^-183
+    {0xa9f6d30a038d1dbcull, 0x5e9fcf4ccd211f4cull}, // 5^-182
+    {0xd47487cc8470652bull, 0x7647c3200069671full}, // 5^-181
+    {0x84c8d4dfd2c63f3bull, 0x29ecd9f40041e073ull}, // 5^-180
+    {0xa5fb0a17c777cf09ull, 0xf468107100525890ull}, // 5^-179
+    {0xcf79cc9db955c2ccull, 0x7182148d4066eeb4ull}, // 5^-178
+    {0x81ac1fe293d599bfull, 0xc6f14cd848405530ull}, // 5^-177
+    {0xa21727db38cb002full, 0xb8ada00e5a506a7cull}, // 5^-176
+    {0xca9cf1d206fdc03bull, 0xa6d90811f0e4851cull}, // 5^-175
+    {0xfd442e4688bd304aull, 0x908f4a166d1da663ull}, // 5^-174
+    {0x9e4a9cec15763e2eull, 0x9a598e4e043287feull}, // 5^-173
+    {0xc5dd44271ad3cdbaull, 0x40eff1e1853f29fdull}, // 5^-172
+    {0xf7549530e188c128ull, 0xd12bee59e68ef47cull}, // 5^-171
+    {0x9a94dd3e8cf578b9ull, 0x82bb74f8301958ceull}, // 5^-170
+    {0xc13a148e3032d6e7ull, 0xe36a52363c1faf01ull}, // 5^-169
+    {0xf18899b1bc3f8ca1ull, 0xdc44e6c3cb279ac1ull}, // 5^-168
+    {0x96f5600f15a7b7e5ull, 0x29ab103a5ef8c0b9ull}, // 5^-167
+    {0xbcb2b812db11a5deull, 0x7415d448f6b6f0e7ull}, // 5^-166
+    {0xebdf661791d60f56ull, 0x111b495b3464ad21ull}, // 5^-165
+    {0x936b9fcebb25c995ull, 0xcab10dd900beec34ull}, // 5^-164
+    {0xb84687c269ef3bfbull, 0x3d5d514f40eea742ull}, // 5^-163
+    {0xe65829b3046b0afaull, 0x0cb4a5a3112a5112ull}, // 5^-162
+    {0x8ff71a0fe2c2e6dcull, 0x47f0e785eaba72abull}, // 5^-161
+    {0xb3f4e093db73a093ull, 0x59ed216765690f56ull}, // 5^-160
+    {0xe0f218b8d25088b8ull, 0x306869c13ec3532cull}, // 5^-159
+    {0x8c974f7383725573ull, 0x1e414218c73a13fbull}, // 5^-158
+    {0xafbd2350644eeacfull, 0xe5d1929ef90898faull}, // 5^-157
+    {0xdbac6c247d62a583ull, 0xdf45f746b74abf39ull}, // 5^-156
+    {0x894bc396ce5da772ull, 0x6b8bba8c328eb783ull}, // 5^-155
+    {0xab9eb47c81f5114full, 0x066ea92f3f326564ull}, // 5^-154
+    {0xd686619ba27255a2ull, 0xc80a537b0efefebdull}, // 5^-153
+    {0x8613fd0145877585ull, 0xbd06742ce95f5f36ull}, // 5^-152
+    {0xa798fc4196e952e7ull, 0x2c48113823b73704ull}, // 5^-151
+    {0xd17f3b51fca3a7a0ull, 0xf75a15862ca504c5ull}, // 5^-150
+    {0x82ef85133de648c4ull, 0x9a984d73dbe722fbull}, // 5^-149
+    {0xa3ab66580d5fdaf5ull, 0xc13e60d0d2e0ebbaull}, // 5^-148
+    {0xcc963fee10b7d1b3ull, 0x318df905079926a8ull}, // 5^-147
+    {0xffbbcfe994e5c61full, 0xfdf17746497f7052ull}, // 5^-146
+    {0x9fd561f1fd0f9bd3ull, 0xfeb6ea8bedefa633ull}, // 5^-145
+    {0xc7caba6e7c5382c8ull, 0xfe64a52ee96b8fc0ull}, // 5^-144
+    {0xf9bd690a1b68637bull, 0x3dfdce7aa3c673b0ull}, // 5^-143
+    {0x9c1661a651213e2dull, 0x06bea10ca65c084eull}, // 5^-142
+    {0xc31bfa0fe5698db8ull, 0x486e494fcff30a62ull}, // 5^-141
+    {0xf3e2f893dec3f126ull, 0x5a89dba3c3efccfaull}, // 5^-140
+    {0x986ddb5c6b3a76b7ull, 0xf89629465a75e01cull}, // 5^-139
+    {0xbe89523386091465ull, 0xf6bbb397f1135823ull}, // 5^-138
+    {0xee2ba6c0678b597full, 0x746aa07ded582e2cull}, // 5^-137
+    {0x94db483840b717efull, 0xa8c2a44eb4571cdcull}, // 5^-136
+    {0xba121a4650e4ddebull, 0x92f34d62616ce413ull}, // 5^-135
+    {0xe896a0d7e51e1566ull, 0x77b020baf9c81d17ull}, // 5^-134
+    {0x915e2486ef32cd60ull, 0x0ace1474dc1d122eull}, // 5^-133
+    {0xb5b5ada8aaff80b8ull, 0x0d819992132456baull}, // 5^-132
+    {0xe3231912d5bf60e6ull, 0x10e1fff697ed6c69ull}, // 5^-131
+    {0x8df5efabc5979c8full, 0xca8d3ffa1ef463c1ull}, // 5^-130
+    {0xb1736b96b6fd83b3ull, 0xbd308ff8a6b17cb2ull}, // 5^-129
+    {0xddd0467c64bce4a0ull, 0xac7cb3f6d05ddbdeull}, // 5^-128
+    {0x8aa22c0dbef60ee4ull, 0x6bcdf07a423aa96bull}, // 5^-127
+    {0xad4ab7112eb3929dull, 0x86c16c98d2c953c6ull}, // 5^-126
+    {0xd89d64d57a607744ull, 0xe871c7bf077ba8b7ull}, // 5^-125
+    {0x87625f056c7c4a8bull, 0x11471cd764ad4972ull}, // 5^-124
+    {0xa93af6c6c79b5d2dull, 0xd598e40d3dd89bcfull}, // 5^-123
+    {0xd389b47879823479ull, 0x4aff1d108d4ec2c3ull}, // 5^-122
+    {0x843610cb4bf160cbull, 0xcedf722a585139baull}, // 5^-121
+    {0xa54394fe1eedb8feull, 0xc2974eb4ee658828ull}, // 5^-120
+    {0xce947a3da6a9273eull, 0x733d226229feea32ull}, // 5^-119
+    {0x811ccc668829b887ull, 0x0806357d5a3f525full}, // 5^-118
+    {0xa163ff802a3426a8ull, 0xca07c2dcb0cf26f7ull}, // 5^-117
+    {0xc9bcff6034c13052ull, 0xfc89b393dd02f0b5ull}, // 5^-116
+    {0xfc2c3f3841f17c67ull, 0xbbac2078d443ace2ull}, // 5^-115
+    {0x9d9ba7832936edc0ull, 0xd54b944b84aa4c0dull}, // 5^-114
+    {0xc5029163f384a931ull, 0x0a9e795e65d4df11ull}, // 5^-113
+    {0xf64335bcf065d37dull, 0x4d4617b5ff4a16d5ull}, // 5^-112
+    {0x99ea0196163fa42eull, 0x504bced1bf8e4e45ull}, // 5^-111
+    {0xc06481fb9bcf8d39ull, 0xe45ec2862f71e1d6ull}, // 5^-110
+    {0xf07da27a82c37088ull, 0x5d767327bb4e5a4cull}, // 5^-109
+    {0x964e858c91ba2655ull, 0x3a6a07f8d510f86full}, // 5^-108
+    {0xbbe226efb628afeaull, 0x890489f70a55368bull}, // 5^-107
+    {0xeadab0aba3b2dbe5ull, 0x2b45ac74ccea842eull}, // 5^-106
+    {0x92c8ae6b464fc96full, 0x3b0b8bc90012929dull}, // 5^-105
+    {0xb77ada0617e3bbcbull, 0x09ce6ebb40173744ull}, // 5^-104
+    {0xe55990879ddcaabdull, 0xcc420a6a101d0515ull}, // 5^-103
+    {0x8f57fa54c2a9eab6ull, 0x9fa946824a12232dull}, // 5^-102
+    {0xb32df8e9f3546564ull, 0x47939822dc96abf9ull}, // 5^-101
+    {0xdff9772470297ebdull, 0x59787e2b93bc56f7ull}, // 5^-100
+    {0x8bfbea76c619ef36ull, 0x57eb4edb3c55b65aull}, // 5^-99
+    {0xaefae51477a06b03ull, 0xede622920b6b23f1ull}, // 5^-98
+    {0xdab99e59958885c4ull, 0xe95fab368e45ecedull}, // 5^-97
+    {0x88b402f7fd75539bull, 0x11dbcb0218ebb414ull}, // 5^-96
+    {0xaae103b5fcd2a881ull, 0xd652bdc29f26a119ull}, // 5^-95
+    {0xd59944a37c0752a2ull, 0x4be76d3346f0495full}, // 5^-94
+    {0x857fcae62d8493a5ull, 0x6f70a4400c562ddbull}, // 5^-93
+    {0xa6dfbd9fb8e5b88eull, 0xcb4ccd500f6bb952ull}, // 5^-92
+    {0xd097ad07a71f26b2ull, 0x7e2000a41346a7a7ull}, // 5^-91
+    {0x825ecc24c873782full, 0x8ed400668c0c28c8ull}, // 5^-90
+    {0xa2f67f2dfa90563bull, 0x728900802f0f32faull}, // 5^-89
+    {0xcbb41ef979346bcaull, 0x4f2b40a03ad2ffb9ull}, // 5^-88
+    {0xfea126b7d78186bcull, 0xe2f610c84987bfa8ull}, // 5^-87
+    {0x9f24b832e6b0f436ull, 0x0dd9ca7d2df4d7c9ull}, // 5^-86
+    {0xc6ede63fa05d3143ull, 0x91503d1c79720dbbull}, // 5^-85
+    {0xf8a95fcf88747d94ull, 0x75a44c6397ce912aull}, // 5^-84
+    {0x9b69dbe1b548ce7cull, 0xc986afbe3ee11abaull}, // 5^-83
+    {0xc24452da229b021bull, 0xfbe85badce996168ull}, // 5^-82
+    {0xf2d56790ab41c2a2ull, 0xfae27299423fb9c3ull}, // 5^-81
+    {0x97c560ba6b0919a5ull, 0xdccd879fc967d41aull}, // 5^-80
+    {0xbdb6b8e905cb600full, 0x5400e987bbc1c920ull}, // 5^-79
+    {0xed246723473e3813ull, 0x290123e9aab23b68ull}, // 5^-78
+    {0x9436c0760c86e30bull, 0xf9a0b6720aaf6521ull}, // 5^-77
+    {0xb94470938fa89bceull, 0xf808e40e8d5b3e69ull}, // 5^-76
+    {0xe7958cb87392c2c2ull, 0xb60b1d1230b20e04ull}, // 5^-75
+    {0x90bd77f3483bb9b9ull, 0xb1c6f22b5e6f48c2ull}, // 5^-74
+    {0xb4ecd5f01a4aa828ull, 0x1e38aeb6360b1af3ull}, // 5^-73
+    {0xe2280b6c20dd5232ull, 0x25c6da63c38de1b0ull}, // 5^-72
+    {0x8d590723948a535full, 0x579c487e5a38ad0eull}, // 5^-71
+    {0xb0af48ec79ace837ull, 0x2d835a9df0c6d851ull}, // 5^-70
+    {0xdcdb1b2798182244ull, 0xf8e431456cf88e65ull}, // 5^-69
+    {0x8a08f0f8bf0f156bull, 0x1b8e9ecb641b58ffull}, // 5^-68
+    {0xac8b2d36eed2dac5ull, 0xe272467e3d222f3full}, // 5^-67
+    {0xd7adf884aa879177ull, 0x5b0ed81dcc6abb0full}, // 5^-66
+    {0x86ccbb52ea94baeaull, 0x98e947129fc2b4e9ull}, // 5^-65
+    {0xa87fea27a539e9a5ull, 0x3f2398d747b36224ull}, // 5^-64
+    {0xd29fe4b18e88640eull, 0x8eec7f0d19a03aadull}, // 5^-63
+    {0x83a3eeeef9153e89ull, 0x1953cf68300424acull}, // 5^-62
+    {0xa48ceaaab75a8e2bull, 0x5fa8c3423c052dd7ull}, // 5^-61
+    {0xcdb02555653131b6ull, 0x3792f412cb06794dull}, // 5^-60
+    {0x808e17555f3ebf11ull, 0xe2bbd88bbee40bd0ull}, // 5^-59
+    {0xa0b19d2ab70e6ed6ull, 0x5b6aceaeae9d0ec4ull}, // 5^-58
+    {0xc8de047564d20a8bull, 0xf245825a5a445275ull}, // 5^-57
+    {0xfb158592be068d2eull, 0xeed6e2f0f0d56712ull}, // 5^-56
+    {0x9ced737bb6c4183dull, 0x55464dd69685606bull}, // 5^-55
+    {0xc428d05aa4751e4cull, 0xaa97e14c3c26b886ull}, // 5^-54
+    {0xf53304714d9265dfull, 0xd53dd99f4b3066a8ull}, // 5^-53
+    {0x993fe2c6d07b7fabull, 0xe546a8038efe4029ull}, // 5^-52
+    {0xbf8fdb78849a5f96ull, 0xde98520472bdd033ull}, // 5^-51
+    {0xef73d256a5c0f77cull, 0x963e66858f6d4440ull}, // 5^-50
+    {0x95a8637627989aadull, 0xdde7001379a44aa8ull}, // 5^-49
+    {0xbb127c53b17ec159ull, 0x5560c018580d5d52ull}, // 5^-48
+    {0xe9d71b689dde71afull, 0xaab8f01e6e10b4a6ull}, // 5^-47
+    {0x9226712162ab070dull, 0xcab3961304ca70e8ull}, // 5^-46
+    {0xb6b00d69bb55c8d1ull, 0x3d607b97c5fd0d22ull}, // 5^-45
+    {0xe45c10c42a2b3b05ull, 0x8cb89a7db77c506aull}, // 5^-44
+    {0x8eb98a7a9a5b04e3ull, 0x77f3608e92adb242ull}, // 5^-43
+    {0xb267ed1940f1c61cull, 0x55f038b237591ed3ull}, // 5^-42
+    {0xdf01e85f912e37a3ull, 0x6b6c46dec52f6688ull}, // 5^-41
+    {0x8b61313bbabce2c6ull, 0x2323ac4b3b3da015ull}, // 5^-40
+    {0xae397d8aa96c1b77ull, 0xabec975e0a0d081aull}, // 5^-39
+    {0xd9c7dced53c72255ull, 0x96e7bd358c904a21ull}, // 5^-38
+    {0x881cea14545c7575ull, 0x7e50d64177da2e54ull}, // 5^-37
+    {0xaa242499697392d2ull, 0xdde50bd1d5d0b9e9ull}, // 5^-36
+    {0xd4ad2dbfc3d07787ull, 0x955e4ec64b44e864ull}, // 5^-35
+    {0x84ec3c97da624ab4ull, 0xbd5af13bef0b113eull}, // 5^-34
+    {0xa6274bbdd0fadd61ull, 0xecb1ad8aeacdd58eull}, // 5^-33
+    {0xcfb11ead453994baull, 0x67de18eda5814af2ull}, // 5^-32
+    {0x81ceb32c4b43fcf4ull, 0x80eacf948770ced7ull}, // 5^-31
+    {0xa2425ff75e14fc31ull, 0xa1258379a94d028dull}, // 5^-30
+    {0xcad2f7f5359a3b3eull, 0x096ee45813a04330ull}, // 5^-29
+    {0xfd87b5f28300ca0dull, 0x8bca9d6e188853fcull}, // 5^-28
+    {0x9e74d1b791e07e48ull, 0x775ea264cf55347eull}, // 5^-27
+    {0xc612062576589ddaull, 0x95364afe032a819eull}, // 5^-26
+    {0xf79687aed3eec551ull, 0x3a83ddbd83f52205ull}, // 5^-25
+    {0x9abe14cd44753b52ull, 0xc4926a9672793543ull}, // 5^-24
+    {0xc16d9a0095928a27ull, 0x75b7053c0f178294ull}, // 5^-23
+    {0xf1c90080baf72cb1ull, 0x5324c68b12dd6339ull}, // 5^-22
+    {0x971da05074da7beeull, 0xd3f6fc16ebca5e04ull}, // 5^-21
+    {0xbce5086492111aeaull, 0x88f4bb1ca6bcf585ull}, // 5^-20
+    {0xec1e4a7db69561a5ull, 0x2b31e9e3d06c32e6ull}, // 5^-19
+    {0x9392ee8e921d5d07ull, 0x3aff322e62439fd0ull}, // 5^-18
+    {0xb877aa3236a4b449ull, 0x09befeb9fad487c3ull}, // 5^-17
+    {0xe69594bec44de15bull, 0x4c2ebe687989a9b4ull}, // 5^-16
+    {0x901d7cf73ab0acd9ull, 0x0f9d37014bf60a11ull}, // 5^-15
+    {0xb424dc35095cd80full, 0x538484c19ef38c95ull}, // 5^-14
+    {0xe12e13424bb40e13ull, 0x2865a5f206b06fbaull}, // 5^-13
+    {0x8cbccc096f5088cbull, 0xf93f87b7442e45d4ull}, // 5^-12
+    {0xafebff0bcb24aafeull, 0xf78f69a51539d749ull}, // 5^-11
+    {0xdbe6fecebdedd5beull, 0xb573440e5a884d1cull}, // 5^-10
+    {0x89705f4136b4a597ull, 0x31680a88f8953031ull}, // 5^-9
+    {0xabcc77118461cefcull, 0xfdc20d2b36ba7c3eull}, // 5^-8
+    {0xd6bf94d5e57a42bcull, 0x3d32907604691b4dull}, // 5^-7
+    {0x8637bd05af6c69b5ull, 0xa63f9a49c2c1b110ull}, // 5^-6
+    {0xa7c5ac471b478423ull, 0x0fcf80dc33721d54ull}, // 5^-5
+    {0xd1b71758e219652bull, 0xd3c36113404ea4a9ull}, // 5^-4
+    {0x83126e978d4fdf3bull, 0x645a1cac083126eaull}, // 5^-3
+    {0xa3d70a3d70a3d70aull, 0x3d70a3d70a3d70a4ull}, // 5^-2
+    {0xccccccccccccccccull, 0xcccccccccccccccdull}, // 5^-1
+    {0x8000000000000000ull, 0x0000000000000000ull}, // 5^0
+    {0xa000000000000000ull, 0x0000000000000000ull}, // 5^1
+    {0xc800000000000000ull, 0x0000000000000000ull}, // 5^2
+    {0xfa00000000000000ull, 0x0000000000000000ull}, // 5^3
+    {0x9c40000000000000ull, 0x0000000000000000ull}, // 5^4
+    {0xc350000000000000ull, 0x0000000000000000ull}, // 5^5
+    {0xf424000000000000ull, 0x0000000000000000ull}, // 5^6
+    {0x9896800000000000ull, 0x0000000000000000ull}, // 5^7
+    {0xbebc200000000000ull, 0x0000000000000000ull}, // 5^8
+    {0xee6b280000000000ull, 0x0000000000000000ull}, // 5^9
+    {0x9502f90000000000ull, 0x0000000000000000ull}, // 5^10
+    {0xba43b74000000000ull, 0x0000000000000000ull}, // 5^11
+    {0xe8d4a51000000000ull, 0x0000000000000000ull}, // 5^12
+    {0x9184e72a00000000ull, 0x0000000000000000ull}, // 5^13
+    {0xb5e620f480000000ull, 0x0000000000000000ull}, // 5^14
+    {0xe35fa931a0000000ull, 0x0000000000000000ull}, // 5^15
+    {0x8e1bc9bf04000000ull, 0x0000000000000000ull}, // 5^16
+    {0xb1a2bc2ec5000000ull, 0x0000000000000000ull}, // 5^17
+    {0xde0b6b3a76400000ull, 0x0000000000000000ull}, // 5^18
+    {0x8ac7230489e80000ull, 0x0000000000000000ull}, // 5^19
+    {0xad78ebc5ac620000ull, 0x0000000000000000ull}, // 5^20
+    {0xd8d726b7177a8000ull, 0x0000000000000000ull}, // 5^21
+    {0x878678326eac9000ull, 0x0000000000000000ull}, // 5^22
+    {0xa968163f0a57b400ull, 0x0000000000000000ull}, // 5^23
+    {0xd3c21bcecceda100ull, 0x0000000000000000ull}, // 5^24
+    {0x84595161401484a0ull, 0x0000000000000000ull}, // 5^25
+    {0xa56fa5b99019a5c8ull, 0x0000000000000000ull}, // 5^26
+    {0xcecb8f27f4200f3aull, 0x0000000000000000ull}, // 5^27
+    {0x813f3978f8940984ull, 0x4000000000000000ull}, // 5^28
+    {0xa18f07d736b90be5ull, 0x5000000000000000ull}, // 5^29
+    {0xc9f2c9cd04674edeull, 0xa400000000000000ull}, // 5^30
+    {0xfc6f7c4045812296ull, 0x4d00000000000000ull}, // 5^31
+    {0x9dc5ada82b70b59dull, 0xf020000000000000ull}, // 5^32
+    {0xc5371912364ce305ull, 0x6c28000000000000ull}, // 5^33
+    {0xf684df56c3e01bc6ull, 0xc732000000000000ull}, // 5^34
+    {0x9a130b963a6c115cull, 0x3c7f400000000000ull}, // 5^35
+    {0xc097ce7bc90715b3ull, 0x4b9f100000000000ull}, // 5^36
+    {0xf0bdc21abb48db20ull, 0x1e86d40000000000ull}, // 5^37
+    {0x96769950b50d88f4ull, 0x1314448000000000ull}, // 5^38
+    {0xbc143fa4e250eb31ull, 0x17d955a000000000ull}, // 5^39
+    {0xeb194f8e1ae525fdull, 0x5dcfab0800000000ull}, // 5^40
+    {0x92efd1b8d0cf37beull, 0x5aa1cae500000000ull}, // 5^41
+    {0xb7abc627050305adull, 0xf14a3d9e40000000ull}, // 5^42
+    {0xe596b7b0c643c719ull, 0x6d9ccd05d0000000ull}, // 5^43
+    {0x8f7e32ce7bea5c6full, 0xe4820023a2000000ull}, // 5^44
+    {0xb35dbf821ae4f38bull, 0xdda2802c8a800000ull}, // 5^45
+    {0xe0352f62a19e306eull, 0xd50b2037ad200000ull}, // 5^46
+    {0x8c213d9da502de45ull, 0x4526f422cc340000ull}, // 5^47
+    {0xaf298d050e4395d6ull, 0x9670b12b7f410000ull}, // 5^48
+    {0xdaf3f04651d47b4cull, 0x3c0cdd765f114000ull}, // 5^49
+    {0x88d8762bf324cd0full, 0xa5880a69fb6ac800ull}, // 5^50
+    {0xab0e93b6efee0053ull, 0x8eea0d047a457a00ull}, // 5^51
+    {0xd5d238a4abe98068ull, 0x72a4904598d6d880ull}, // 5^52
+    {0x85a36366eb71f041ull, 0x47a6da2b7f864750ull}, // 5^53
+    {0xa70c3c40a64e6c51ull, 0x999090b65f67d924ull}, // 5^54
+    {0xd0cf4b50cfe20765ull, 0xfff4b4e3f741cf6dull}, // 5^55
+    {0x82818f1281ed449full, 0xbff8f10e7a8921a4ull}, // 5^56
+    {0xa321f2d7226895c7ull, 0xaff72d52192b6a0dull}, // 5^57
+    {0xcbea6f8ceb02bb39ull, 0x9bf4f8a69f764490ull}, // 5^58
+    {0xfee50b7025c36a08ull, 0x02f236d04753d5b4ull}, // 5^59
+    {0x9f4f2726179a2245ull, 0x01d762422c946590ull}, // 5^60
+    {0xc722f0ef9d80aad6ull, 0x424d3ad2b7b97ef5ull}, // 5^61
+    {0xf8ebad2b84e0d58bull, 0xd2e0898765a7deb2ull}, // 5^62
+    {0x9b934c3b330c8577ull, 0x63cc55f49f88eb2full}, // 5^63
+    {0xc2781f49ffcfa6d5ull, 0x3cbf6b71c76b25fbull}, // 5^64
+    {0xf316271c7fc3908aull, 0x8bef464e3945ef7aull}, // 5^65
+    {0x97edd871cfda3a56ull, 0x97758bf0e3cbb5acull}, // 5^66
+    {0xbde94e8e43d0c8ecull, 0x3d52eeed1cbea317ull}, // 5^67
+    {0xed63a231d4c4fb27ull, 0x4ca7aaa863ee4bddull}, // 5^68
+    {0x945e455f24fb1cf8ull, 0x8fe8caa93e74ef6aull}, // 5^69
+    {0xb975d6b6ee39e436ull, 0xb3e2fd538e122b44ull}, // 5^70
+    {0xe7d34c64a9c85d44ull, 0x60dbbca87196b616ull}, // 5^71
+    {0x90e40fbeea1d3a4aull, 0xbc8955e946fe31cdull}, // 5^72
+    {0xb51d13aea4a488ddull, 0x6babab6398bdbe41ull}, // 5^73
+    {0xe264589a4dcdab14ull, 0xc696963c7eed2dd1ull}, // 5^74
+    {0x8d7eb76070a08aecull, 0xfc1e1de5cf543ca2ull}, // 5^75
+    {0xb0de65388cc8ada8ull, 0x3b25a55f43294bcbull}, // 5^76
+    {0xdd15fe86affad912ull, 0x49ef0eb713f39ebeull}, // 5^77
+    {0x8a2dbf142dfcc7abull, 0x6e3569326c784337ull}, // 5^78
+    {0xacb92ed9397bf996ull, 0x49c2c37f07965404ull}, // 5^79
+    {0xd7e77a8f87daf7fbull, 0xdc33745ec97be906ull}, // 5^80
+    {0x86f0ac99b4e8dafdull, 0x69a028bb3ded71a3ull}, // 5^81
+    {0xa8acd7c0222311bcull, 0xc40832ea0d68ce0cull}, // 5^82
+    {0xd2d80db02aabd62bull, 0xf50a3fa490c30190ull}, // 5^83
+    {0x83c7088e1aab65dbull, 0x792667c6da79e0faull}, // 5^84
+    {0xa4b8cab1a1563f52ull, 0x577001b891185938ull}, // 5^85
+    {0xcde6fd5e09abcf26ull, 0xed4c0226b55e6f86ull}, // 5^86
+    {0x80b05e5ac60b6178ull, 0x544f8158315b05b4ull}, // 5^87
+    {0xa0dc75f1778e39d6ull, 0x696361ae3db1c721ull}, // 5^88
+    {0xc913936dd571c84cull, 0x03bc3a19cd1e38e9ull}, // 5^89
+    {0xfb5878494ace3a5full, 0x04ab48a04065c723ull}, // 5^90
+    {0x9d174b2dcec0e47bull, 0x62eb0d64283f9c76ull}, // 5^91
+    {0xc45d1df942711d9aull, 0x3ba5d0bd324f8394ull}, // 5^92
+    {0xf5746577930d6500ull, 0xca8f44ec7ee36479ull}, // 5^93
+    {0x9968bf6abbe85f20ull, 0x7e998b13cf4e1ecbull}, // 5^94
+    {0xbfc2ef456ae276e8ull, 0x9e3fedd8c321a67eull}, // 5^95
+    {0xefb3ab16c59b14a2ull, 0xc5cfe94ef3ea101eull}, // 5^96
+    {0x95d04aee3b80ece5ull, 0xbba1f1d158724a12ull}, // 5^97
+    {0xbb445da9ca61281full, 0x2a8a6e45ae8edc97ull}, // 5^98
+    {0xea1575143cf97226ull, 0xf52d09d71a3293bdull}, // 5^99
+    {0x924d692ca61be758ull, 0x593c2626705f9c56ull}, // 5^100
+    {0xb6e0c377cfa2e12eull, 0x6f8b2fb00c77836cull}, // 5^101
+    {0xe498f455c38b997aull, 0x0b6dfb9c0f956447ull}, // 5^102
+    {0x8edf98b59a373fecull, 0x4724bd4189bd5eacull}, // 5^103
+    {0xb2977ee300c50fe7ull, 0x58edec91ec2cb657ull}, // 5^104
+    {0xdf3d5e9bc0f653e1ull, 0x2f2967b66737e3edull}, // 5^105
+    {0x8b865b215899f46cull, 0xbd79e0d20082ee74ull}, // 5^106
+    {0xae67f1e9aec07187ull, 0xecd8590680a3aa11ull}, // 5^107
+    {0xda01ee641a708de9ull, 0xe80e6f4820cc9495ull}, // 5^108
+    {0x884134fe908658b2ull, 0x3109058d147fdcddull}, // 5^109
+    {0xaa51823e34a7eedeull, 0xbd4b46f0599fd415ull}, // 5^110
+    {0xd4e5e2cdc1d1ea96ull, 0x6c9e18ac7007c91aull}, // 5^111
+    {0x850fadc09923329eull, 0x03e2cf6bc604ddb0ull}, // 5^112
+    {0xa6539930bf6bff45ull, 0x84db8346b786151cull}, // 5^113
+    {0xcfe87f7cef46ff16ull, 0xe612641865679a63ull}, // 5^114
+    {0x81f14fae158c5f6eull, 0x4fcb7e8f3f60c07eull}, // 5^115
+    {0xa26da3999aef7749ull, 0xe3be5e330f38f09dull}, // 5^116
+    {0xcb090c8001ab551cull, 0x5cadf5bfd3072cc5ull}, // 5^117
+    {0xfdcb4fa002162a63ull, 0x73d9732fc7c8f7f6ull}, // 5^118
+    {0x9e9f11c4014dda7eull, 0x2867e7fddcdd9afaull}, // 5^119
+    {0xc646d63501a1511dull, 0xb281e1fd541501b8ull}, // 5^120
+    {0xf7d88bc24209a565ull, 0x1f225a7ca91a4226ull}, // 5^121
+    {0x9ae757596946075full, 0x3375788de9b06958ull}, // 5^122
+    {0xc1a12d2fc3978937ull, 0x0052d6b1641c83aeull}, // 5^123
+    {0xf209787bb47d6b84ull, 0xc0678c5dbd23a49aull}, // 5^124
+    {0x9745eb4d50ce6332ull, 0xf840b7ba963646e0ull}, // 5^125
+    {0xbd176620a501fbffull, 0xb650e5a93bc3d898ull}, // 5^126
+    {0xec5d3fa8ce427affull, 0xa3e51f138ab4cebeull}, // 5^127
+    {0x93ba47c980e98cdfull, 0xc66f336c36b10137ull}, // 5^128
+    {0xb8a8d9bbe123f017ull, 0xb80b0047445d4184ull}, // 5^129
+    {0xe6d3102ad96cec1dull, 0xa60dc059157491e5ull}, // 5^130
+    {0x9043ea1ac7e41392ull, 0x87c89837ad68db2full}, // 5^131
+    {0xb454e4a179dd1877ull, 0x29babe4598c311fbull}, // 5^132
+    {0xe16a1dc9d8545e94ull, 0xf4296dd6fef3d67aull}, // 5^133
+    {0x8ce2529e2734bb1dull, 0x1899e4a65f58660cull}, // 5^134
+    {0xb01ae745b101e9e4ull, 0x5ec05dcff72e7f8full}, // 5^135
+    {0xdc21a1171d42645dull, 0x76707543f4fa1f73ull}, // 5^136
+    {0x899504ae72497ebaull, 0x6a06494a791c53a8ull}, // 5^137
+    {0xabfa45da0edbde69ull, 0x0487db9d17636892ull}, // 5^138
+    {0xd6f8d7509292d603ull, 0x45a9d2845d3c42b6ull}, // 5^139
+    {0x865b86925b9bc5c2ull, 0x0b8a2392ba45a9b2ull}, // 5^140
+    {0xa7f26836f282b732ull, 0x8e6cac7768d7141eull}, // 5^141
+    {0xd1ef0244af2364ffull, 0x3207d795430cd926ull}, // 5^142
+    {0x8335616aed761f1full, 0x7f44e6bd49e807b8ull}, // 5^143
+    {0xa402b9c5a8d3a6e7ull, 0x5f16206c9c6209a6ull}, // 5^144
+    {0xcd036837130890a1ull, 0x36dba887c37a8c0full}, // 5^145
+    {0x802221226be55a64ull, 0xc2494954da2c9789ull}, // 5^146
+    {0xa02aa96b06deb0fdull, 0xf2db9baa10b7bd6cull}, // 5^147
+    {0xc83553c5c8965d3dull, 0x6f92829494e5acc7ull}, // 5^148
+    {0xfa42a8b73abbf48cull, 0xcb772339ba1f17f9ull}, // 5^149
+    {0x9c69a97284b578d7ull, 0xff2a760414536efbull}, // 5^150
+    {0xc38413cf25e2d70dull, 0xfef5138519684abaull}, // 5^151
+    {0xf46518c2ef5b8cd1ull, 0x7eb258665fc25d69ull}, // 5^152
+    {0x98bf2f79d5993802ull, 0xef2f773ffbd97a61ull}, // 5^153
+    {0xbeeefb584aff8603ull, 0xaafb550ffacfd8faull}, // 5^154
+    {0xeeaaba2e5dbf6784ull, 0x95ba2a53f983cf38ull}, // 5^155
+    {0x952ab45cfa97a0b2ull, 0xdd945a747bf26183ull}, // 5^156
+    {0xba756174393d88dfull, 0x94f971119aeef9e4ull}, // 5^157
+    {0xe912b9d1478ceb17ull, 0x7a37cd5601aab85dull}, // 5^158
+    {0x91abb422ccb812eeull, 0xac62e055c10ab33aull}, // 5^159
+    {0xb616a12b7fe617aaull, 0x577b986b314d6009ull}, // 5^160
+    {0xe39c49765fdf9d94ull, 0xed5a7e85fda0b80bull}, // 5^161
+    {0x8e41ade9fbebc27dull, 0x14588f13be847307ull}, // 5^162
+    {0xb1d219647ae6b31cull, 0x596eb2d8ae258fc8ull}, // 5^163
+    {0xde469fbd99a05fe3ull, 0x6fca5f8ed9aef3bbull}, // 5^164
+    {0x8aec23d680043beeull, 0x25de7bb9480d5854ull}, // 5^165
+    {0xada72ccc20054ae9ull, 0xaf561aa79a10ae6aull}, // 5^166
+    {0xd910f7ff28069da4ull, 0x1b2ba1518094da04ull}, // 5^167
+    {0x87aa9aff79042286ull, 0x90fb44d2f05d0842ull}, // 5^168
+    {0xa99541bf57452b28ull, 0x353a1607ac744a53ull}, // 5^169
+    {0xd3fa922f2d1675f2ull, 0x42889b8997915ce8ull}, // 5^170
+    {0x847c9b5d7c2e09b7ull, 0x69956135febada11ull}, // 5^171
+    {0xa59bc234db398c25ull, 0x43fab9837e699095ull}, // 5^172
+    {0xcf02b2c21207ef2eull, 0x94f967e45e03f4bbull}, // 5^173
+    {0x8161afb94b44f57dull, 0x1d1be0eebac278f5ull}, // 5^174
+    {0xa1ba1ba79e1632dcull, 0x6462d92a69731732ull}, // 5^175
+    {0xca28a291859bbf93ull, 0x7d7b8f7503cfdcfeull}, // 5^176
+    {0xfcb2cb35e702af78ull, 0x5cda735244c3d43eull}, // 5^177
+    {0x9defbf01b061adabull, 0x3a0888136afa64a7ull}, // 5^178
+    {0xc56baec21c7a1916ull, 0x088aaa1845b8fdd0ull}, // 5^179
+    {0xf6c69a72a3989f5bull, 0x8aad549e57273d45ull}, // 5^180
+    {0x9a3c2087a63f6399ull, 0x36ac54e2f678864bull}, // 5^181
+    {0xc0cb28a98fcf3c7full, 0x84576a1bb416a7ddull}, // 5^182
+    {0xf0fdf2d3f3c30b9full, 0x656d44a2a11c51d5ull}, // 5^183
+    {0x969eb7c47859e743ull, 0x9f644ae5a4b1b325ull}, // 5^184
+    {0xbc4665b596706114ull, 0x873d5d9f0dde1feeull}, // 5^185
+    {0xeb57ff22fc0c7959ull, 0xa90cb506d155a7eaull}, // 5^186
+    {0x9316ff75dd87cbd8ull, 0x09a7f12442d588f2ull}, // 5^187
+    {0xb7dcbf5354e9beceull, 0x0c11ed6d538aeb2full}, // 5^188
+    {0xe5d3ef282a242e81ull, 0x8f1668c8a86da5faull}, // 5^189
+    {0x8fa475791a569d10ull, 0xf96e017d694487bcull}, // 5^190
+    {0xb38d92d760ec4455ull, 0x37c981dcc395a9acull}, // 5^191
+    {0xe070f78d3927556aull, 0x85bbe253f47b1417ull}, // 5^192
+    {0x8c469ab843b89562ull, 0x93956d7478ccec8eull}, // 5^193
+    {0xaf58416654a6babbull, 0x387ac8d1970027b2ull}, // 5^194
+    {0xdb2e51bfe9d0696aull, 0x06997b05fcc0319eull}, // 5^195
+    {0x88fcf317f22241e2ull, 0x441fece3bdf81f03ull}, // 5^196
+    {0xab3c2fddeeaad25aull, 0xd527e81cad7626c3ull}, // 5^197
+    {0xd60b3bd56a5586f1ull, 0x8a71e223d8d3b074ull}, // 5^198
+    {0x85c7056562757456ull, 0xf6872d5667844e49ull}, // 5^199
+    {0xa738c6bebb12d16cull, 0xb428f8ac016561dbull}, // 5^200
+    {0xd106f86e69d785c7ull, 0xe13336d701beba52ull}, // 5^201
+    {0x82a45b450226b39cull, 0xecc0024661173473ull}, // 5^202
+    {0xa34d721642b06084ull, 0x27f002d7f95d0190ull}, // 5^203
+    {0xcc20ce9bd35c78a5ull, 0x31ec038df7b441f4ull}, // 5^204
+    {0xff290242c83396ceull, 0x7e67047175a15271ull}, // 5^205
+    {0x9f79a169bd203e41ull, 0x0f0062c6e984d386ull}, // 5^206
+    {0xc75809c42c684dd1ull, 0x52c07b78a3e60868ull}, // 5^207
+    {0xf92e0c3537826145ull, 0xa7709a56ccdf8a82ull}, // 5^208
+    {0x9bbcc7a142b17ccbull, 0x88a66076400bb691ull}, // 5^209
+    {0xc2abf989935ddbfeull, 0x6acff893d00ea435ull}, // 5^210
+    {0xf356f7ebf83552feull, 0x0583f6b8c4124d43ull}, // 5^211
+    {0x98165af37b2153deull, 0xc3727a337a8b704aull}, // 5^212
+    {0xbe1bf1b059e9a8d6ull, 0x744f18c0592e4c5cull}, // 5^213
+    {0xeda2ee1c7064130cull, 0x1162def06f79df73ull}, // 5^214
+    {0x9485d4d1c63e8be7ull, 0x8addcb5645ac2ba8ull}, // 5^215
+    {0xb9a74a0637ce2ee1ull, 0x6d953e2bd7173692ull}, // 5^216
+    {0xe8111c87c5c1ba99ull, 0xc8fa8db6ccdd0437ull}, // 5^217
+    {0x910ab1d4db9914a0ull, 0x1d9c9892400a22a2ull}, // 5^218
+    {0xb54d5e4a127f59c8ull, 0x2503beb6d00cab4bull}, // 5^219
+    {0xe2a0b5dc971f303aull, 0x2e44ae64840fd61dull}, // 5^220
+    {0x8da471a9de737e24ull, 0x5ceaecfed289e5d2ull}, // 5^221
+    {0xb10d8e1456105dadull, 0x7425a83e872c5f47ull}, // 5^222
+    {0xdd50f1996b947518ull, 0xd12f124e28f77719ull}, // 5^223
+    {0x8a5296ffe33cc92full, 0x82bd6b70d99aaa6full}, // 5^224
+    {0xace73cbfdc0bfb7bull, 0x636cc64d1001550bull}, // 5^225
+    {0xd8210befd30efa5aull, 0x3c47f7e05401aa4eull}, // 5^226
+    {0x8714a775e3e95c78ull, 0x65acfaec34810a71ull}, // 5^227
+    {0xa8d9d1535ce3b396ull, 0x7f1839a741a14d0dull}, // 5^228
+    {0xd31045a8341ca07cull, 0x1ede48111209a050ull}, // 5^229
+    {0x83ea2b892091e44dull, 0x934aed0aab460432ull}, // 5^230
+    {0xa4e4b66b68b65d60ull, 0xf81da84d5617853full}, // 5^231
+    {0xce1de40642e3f4b9ull, 0x36251260ab9d668eull}, // 5^232
+    {0x80d2ae83e9ce78f3ull, 0xc1d72b7c6b426019ull}, // 5^233
+    {0xa1075a24e4421730ull, 0xb24cf65b8612f81full}, // 5^234
+    {0xc94930ae1d529cfcull, 0xdee033f26797b627ull}, // 5^235
+    {0xfb9b7cd9a4a7443cull, 0x169840ef017da3b1ull}, // 5^236
+    {0x9d412e0806e88aa5ull, 0x8e1f289560ee864eull}, // 5^237
+    {0xc491798a08a2ad4eull, 0xf1a6f2bab92a27e2ull}, // 5^238
+    {0xf5b5d7ec8acb58a2ull, 0xae10af696774b1dbull}, // 5^239
+    {0x9991a6f3d6bf1765ull, 0xacca6da1e0a8ef29ull}, // 5^240
+    {0xbff610b0cc6edd3full, 0x17fd090a58d32af3ull}, // 5^241
+    {0xeff394dcff8a948eull, 0xddfc4b4cef07f5b0ull}, // 5^242
+    {0x95f83d0a1fb69cd9ull, 0x4abdaf101564f98eull}, // 5^243
+    {0xbb764c4ca7a4440full, 0x9d6d1ad41abe37f1ull}, // 5^244
+    {0xea53df5fd18d5513ull, 0x84c86189216dc5edull}, // 5^245
+    {0x92746b9be2f8552cull, 0x32fd3cf5b4e49bb4ull}, // 5^246
+    {0xb7118682dbb66a77ull, 0x3fbc8c33221dc2a1ull}, // 5^247
+    {0xe4d5e82392a40515ull, 0x0fabaf3feaa5334aull}, // 5^248
+    {0x8f05b1163ba6832dull, 0x29cb4d87f2a7400eull}, // 5^249
+    {0xb2c71d5bca9023f8ull, 0x743e20e9ef511012ull}, // 5^250
+    {0xdf78e4b2bd342cf6ull, 0x914da9246b255416ull}, // 5^251
+    {0x8bab8eefb6409c1aull, 0x1ad089b6c2f7548eull}, // 5^252
+    {0xae9672aba3d0c320ull, 0xa184ac2473b529b1ull}, // 5^253
+    {0xda3c0f568cc4f3e8ull, 0xc9e5d72d90a2741eull}, // 5^254
+    {0x8865899617fb1871ull, 0x7e2fa67c7a658892ull}, // 5^255
+    {0xaa7eebfb9df9de8dull, 0xddbb901b98feeab7ull}, // 5^256
+    {0xd51ea6fa85785631ull, 0x552a74227f3ea565ull}, // 5^257
+    {0x8533285c936b35deull, 0xd53a88958f87275full}, // 5^258
+    {0xa67ff273b8460356ull, 0x8a892abaf368f137ull}, // 5^259
+    {0xd01fef10a657842cull, 0x2d2b7569b0432d85ull}, // 5^260
+    {0x8213f56a67f6b29bull, 0x9c3b29620e29fc73ull}, // 5^261
+    {0xa298f2c501f45f42ull, 0x8349f3ba91b47b8full}, // 5^262
+    {0xcb3f2f7642717713ull, 0x241c70a936219a73ull}, // 5^263
+    {0xfe0efb53d30dd4d7ull, 0xed238cd383aa0110ull}, // 5^264
+    {0x9ec95d1463e8a506ull, 0xf4363804324a40aaull}, // 5^265
+    {0xc67bb4597ce2ce48ull, 0xb143c6053edcd0d5ull}, // 5^266
+    {0xf81aa16fdc1b81daull, 0xdd94b7868e94050aull}, // 5^267
+    {0x9b10a4e5e9913128ull, 0xca7cf2b4191c8326ull}, // 5^268
+    {0xc1d4ce1f63f57d72ull, 0xfd1c2f611f63a3f0ull}, // 5^269
+    {0xf24a01a73cf2dccfull, 0xbc633b39673c8cecull}, // 5^270
+    {0x976e41088617ca01ull, 0xd5be0503e085d813ull}, // 5^271
+    {0xbd49d14aa79dbc82ull, 0x4b2d8644d8a74e18ull}, // 5^272
+    {0xec9c459d51852ba2ull, 0xddf8e7d60ed1219eull}, // 5^273
+    {0x93e1ab8252f33b45ull, 0xcabb90e5c942b503ull}, // 5^274
+    {0xb8da1662e7b00a17ull, 0x3d6a751f3b936243ull}, // 5^275
+    {0xe7109bfba19c0c9dull, 0x0cc512670a783ad4ull}, // 5^276
+    {0x906a617d450187e2ull, 0x27fb2b80668b24c5ull}, // 5^277
+    {0xb484f9dc9641e9daull, 0xb1f9f660802dedf6ull}, // 5^278
+    {0xe1a63853bbd26451ull, 0x5e7873f8a0396973ull}, // 5^279
+    {0x8d07e33455637eb2ull, 0xdb0b487b6423e1e8ull}, // 5^280
+    {0xb049dc016abc5e5full, 0x91ce1a9a3d2cda62ull}, // 5^281
+    {0xdc5c5301c56b75f7ull, 0x7641a140cc7810fbull}, // 5^282
+    {0x89b9b3e11b6329baull, 0xa9e904c87fcb0a9dull}, // 5^283
+    {0xac2820d9623bf429ull, 0x546345fa9fbdcd44ull}, // 5^284
+    {0xd732290fbacaf133ull, 0xa97c177947ad4095ull}, // 5^285
+    {0x867f59a9d4bed6c0ull, 0x49ed8eabcccc485dull}, // 5^286
+    {0xa81f301449ee8c70ull, 0x5c68f256bfff5a74ull}, // 5^287
+    {0xd226fc195c6a2f8cull, 0x73832eec6fff3111ull}, // 5^288
+    {0x83585d8fd9c25db7ull, 0xc831fd53c5ff7eabull}, // 5^289
+    {0xa42e74f3d032f525ull, 0xba3e7ca8b77f5e55ull}, // 5^290
+    {0xcd3a1230c43fb26full, 0x28ce1bd2e55f35ebull}, // 5^291
+    {0x80444b5e7aa7cf85ull, 0x7980d163cf5b81b3ull}, // 5^292
+    {0xa0555e361951c366ull, 0xd7e105bcc332621full}, // 5^293
+    {0xc86ab5c39fa63440ull, 0x8dd9472bf3fefaa7ull}, // 5^294
+    {0xfa856334878fc150ull, 0xb14f98f6f0feb951ull}, // 5^295
+    {0x9c935e00d4b9d8d2ull, 0x6ed1bf9a569f33d3ull}, // 5^296
+    {0xc3b8358109e84f07ull, 0x0a862f80ec4700c8ull}, // 5^297
+    {0xf4a642e14c6262c8ull, 0xcd27bb612758c0faull}, // 5^298
+    {0x98e7e9cccfbd7dbdull, 0x8038d51cb897789cull}, // 5^299
+    {0xbf21e44003acdd2cull, 0xe0470a63e6bd56c3ull}, // 5^300
+    {0xeeea5d5004981478ull, 0x1858ccfce06cac74ull}, // 5^301
+    {0x95527a5202df0ccbull, 0x0f37801e0c43ebc8ull}, // 5^302
+    {0xbaa718e68396cffdull, 0xd30560258f54e6baull}, // 5^303
+    {0xe950df20247c83fdull, 0x47c6b82ef32a2069ull}, // 5^304
+    {0x91d28b7416cdd27eull, 0x4cdc331d57fa5441ull}, // 5^305
+    {0xb6472e511c81471dull, 0xe0133fe4adf8e952ull}, // 5^306
+    {0xe3d8f9e563a198e5ull, 0x58180fddd97723a6ull}, // 5^307
+    {0x8e679c2f5e44ff8full, 0x570f09eaa7ea7648ull}, // 5^308
+};
+
+static const double exact_powers_of_ten[] =
+{
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+typedef struct
+{
+    uint32_t limbs[NUM_BIGINT_LIMBS];
+    int      count;
+} num_bigint_t;
+
+static unsigned count_leading_zeros64(uint64_t x)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanReverse64(&index, x);
+    return 63 - (unsigned)index;
+#elif defined(__GNUC__)
+    return (unsigned)__builtin_clzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 0x8000000000000000ull))
+    {
+        x <<= 1;
+        ++n;
+    }
+    return n;
+#endif
+}
+
+// Full 64x64 -> 128 bit product, returns low half
+static uint64_t mul_64x64_128(uint64_t a, uint64_t b, uint64_t* hi)
+{
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = (__uint128_t)a * b;
+    *hi = (uint64_t)(r >> 64);
+    return (uint64_t)r;
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, hi);
+#else
+    uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+    uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+    uint64_t ll = a_lo * b_lo, lh = a_lo * b_hi, hl = a_hi * b_lo, hh = a_hi * b_hi;
+    uint64_t mid = (ll >> 32) + (uint32_t)lh + (uint32_t)hl;
+    *hi = hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+    return (mid << 32) | (uint32_t)ll;
+#endif
+}
+
+static double bits_to_double(uint64_t bits)
+{
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+}
+
+static uint64_t double_to_bits(double d)
+{
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+}
+
+// Eisel-Lemire: correctly rounded w * 10^q for w < 2^64, result is an unsigned double bit pattern
+static uint64_t eisel_lemire(uint64_t w, int q)
+{
+    const uint64_t* pow5;
+    uint64_t lo, hi, lo2, hi2, mantissa;
+    unsigned lz, upperbit, shift;
+    int      power2;
+
+    if (w == 0 || q < NUM_MIN_POWER_OF_TEN)
+        return 0;
+    if (q > NUM_MAX_POWER_OF_TEN)
+        return 0x7FF0000000000000ull;
+
+    lz = count_leading_zeros64(w);
+    w <<= lz;
+
+    pow5 = power_of_five_128[q - NUM_MIN_POWER_OF_TEN];
+    lo   = mul_64x64_128(w, pow5[0], &hi);
+    if ((hi & 0x1FF) == 0x1FF)
+    {
+        mul_64x64_128(w, pow5[1], &hi2);
+        lo2 = lo + hi2;
+        if (lo2 < lo)
+            ++hi;
+        lo = lo2;
+    }
+
+    upperbit = (unsigned)(hi >> 63);
+    shift    = upperbit + 64 - 52 - 3;
+    mantissa = hi >> shift;
+    power2   = (int)(((152170 + 65536) * q) >> 16) + 63 + (int)upperbit - (int)lz + 1023;
+
+    if (power2 <= 0)
+    {
+        if (-power2 + 1 >= 64)
+            return 0;
+
+        mantissa >>= -power2 + 1;
+        mantissa  += mantissa & 1;
+        mantissa >>= 1;
+        power2     = mantissa < (1ull << 52) ? 0 : 1;
+
+        return mantissa | ((uint64_t)power2 << 52);
+    }
+
+    // exactly halfway between two doubles, round to even
+    if (lo <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1)
+    {
+        if ((mantissa << shift) == hi)
+            mantissa &= ~1ull;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ull << 52))
+    {
+        mantissa = 1ull << 52;
+        ++power2;
+    }
+    mantissa &= ~(1ull << 52);
+
+    if (power2 >= 0x7FF)
+        return 0x7FF0000000000000ull;
+
+    return mantissa | ((uint64_t)power2 << 52);
+}
+
+static void bigint_mul_add(num_bigint_t* n, uint32_t mul, uint32_t add)
+{
+    uint64_t carry = add;
+    int      i;
+
+    for (i = 0; i < n->count; ++i)
+    {
+        carry       += (uint64_t)n->limbs[i] * mul;
+        n->limbs[i]  = (uint32_t)carry;
+        carry      >>= 32;
+    }
+
+    if (carry && n->count < NUM_BIGINT_LIMBS)
+        n->limbs[n->count++] = (uint32_t)carry;
+}
+
+static void bigint_mul_pow5(num_bigint_t* n, int exp)
+{
+    for (; exp >= 13; exp -= 13)
+        bigint_mul_add(n, 1220703125u, 0);
+    for (; exp > 0; --exp)
+        bigint_mul_add(n, 5, 0);
+}
+
+static void bigint_shl(num_bigint_t* n, int bits)
+{
+    int words = bits / 32, i;
+
+    bits %= 32;
+    if (bits)
+    {
+        bigint_mul_add(n, 1u << bits, 0);
+    }
+    if (words && n->count)
+    {
+        for (i = n->count - 1; i >= 0; --i)
+            n->limbs[i + words] = n->limbs[i];
+        for (i = 0; i < words; ++i)
+            n->limbs[i] = 0;
+        n->count += words;
+    }
+}
+
+static int bigint_compare(const num_bigint_t* a, const num_bigint_t* b)
+{
+    int i;
+
+    if (a->count != b->count)
+        return a->count < b->count ? -1 : 1;
+
+    for (i = a->count - 1; i >= 0; --i)
+    {
+        if (a->limbs[i] != b->limbs[i])
+            return a->limbs[i] < b->limbs[i] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+// Decides between candidate and the next double up by comparing the exact decimal
+// value digits * 10^exp10 against the halfway point between them.
+static uint64_t round_by_digit_comparison(uint64_t candidate, const uint8_t* digits, int num_digits, int exp10, int sticky)
+{
+    num_bigint_t decimal, halfway;
+    uint64_t     mantissa = candidate & ((1ull << 52) - 1);
+    int          biased   = (int)(candidate >> 52);
+    int          exp2, cmp, i;
+
+    if (biased)
+    {
+        mantissa |= 1ull << 52;
+        exp2      = biased - 1075;
+    }
+    else
+    {
+        exp2 = -1074;
+    }
+
+    // halfway = (2 * mantissa + 1) * 2^(exp2 - 1)
+    mantissa = 2 * mantissa + 1;
+    --exp2;
+
+    decimal.count = 0;
+    for (i = 0; i < num_digits; ++i)
+        bigint_mul_add(&decimal, 10, digits[i] - '0');
+    if (!decimal.count)
+        decimal.limbs[decimal.count++] = 0;
+
+    halfway.limbs[0] = (uint32_t)mantissa;
+    halfway.limbs[1] = (uint32_t)(mantissa >> 32);
+    halfway.count    = halfway.limbs[1] ? 2 : 1;
+
+    // compare digits * 5^exp10 * 2^exp10 against halfway * 2^exp2
+    if (exp10 >= 0)
+        bigint_mul_pow5(&decimal, exp10);
+    else
+        bigint_mul_pow5(&halfway, -exp10);
+
+    if (exp10 > exp2)
+        bigint_shl(&decimal, exp10 - exp2);
+    else
+        bigint_shl(&halfway, exp2 - exp10);
+
+    cmp = bigint_compare(&decimal, &halfway);
+    if (cmp == 0 && sticky)
+        cmp = 1;
+
+    if (cmp > 0 || (cmp == 0 && (candidate & 1)))
+        return candidate + 1;
+
+    return candidate;
+}
+
+// Decodes FLOAT_NUMBER or DEC_NUMBER token into correctly rounded double, locale independent
+static double decode_double(const uint8_t* c, const uint8_t* e)
+{
+    const uint8_t* digits_start;
+    const uint8_t* int_end;
+    uint8_t        digits[NUM_MAX_SLOW_DIGITS];
+    uint64_t       w = 0, bits, bits_up;
+    int            negative = FALSE, num_digits = 0, num_fast = 0, sticky = FALSE;
+    int            exp10 = 0, exp_value = 0, exp_negative = FALSE, q, i;
+
+    if (c < e && (*c == '-' || *c == '+'))
+        negative = *c++ == '-';
+
+    // skip leading zeros, they do not contribute to the significand
+    while (c < e && *c == '0')
+        ++c;
+
+    digits_start = c;
+    for (; c < e && (*c >= '0' && *c <= '9'); ++c)
+    {
+        if (num_digits < NUM_MAX_SLOW_DIGITS)
+            digits[num_digits++] = *c;
+        else
+        {
+            sticky |= *c != '0';
+            ++exp10;
+        }
+    }
+    int_end = c;
+
+    if (c < e && *c == '.')
+    {
+        ++c;
+        if (digits_start == int_end)
+        {
+            // no significant integer digits, skip fraction leading zeros too
+            while (c < e && *c == '0')
+            {
+                --exp10;
+                ++c;
+            }
+        }
+        for (; c < e && (*c >= '0' && *c <= '9'); ++c)
+        {
+            if (num_digits < NUM_MAX_SLOW_DIGITS)
+            {
+                digits[num_digits++] = *c;
+                --exp10;
+            }
+            else
+            {
+                sticky |= *c != '0';
+            }
+        }
+    }
+
+    if (c < e && (*c == 'e' || *c == 'E'))
+    {
+        ++c;
+        if (c < e && (*c == '-' || *c == '+'))
+            exp_negative = *c++ == '-';
+        for (; c < e && (*c >= '0' && *c <= '9'); ++c)
+        {
+            if (exp_value < 100000)
+                exp_value = exp_value * 10 + (*c - '0');
+        }
+    }
+    exp10 += exp_negative ? -exp_value : exp_value;
+
+    // trailing zeros do not change the value
+    while (num_digits > 0 && digits[num_digits - 1] == '0')
+    {
+        --num_digits;
+        ++exp10;
+    }
+
+    if (num_digits == 0)
+        return negative ? -0.0 : 0.0;
+
+    num_fast = num_digits < NUM_MAX_FAST_DIGITS ? num_digits : NUM_MAX_FAST_DIGITS;
+    for (i = 0; i < num_fast; ++i)
+        w = w * 10 + (digits[i] - '0');
+    q = exp10 + (num_digits - num_fast);
+
+#if !defined(FLT_EVAL_METHOD) || FLT_EVAL_METHOD == 0
+    // Clinger's fast path: both operands are exact, so is the single rounding
+    if (num_fast == num_digits && !sticky && w <= (1ull << 53) && q >= -22 && q <= 22)
+    {
+        double d = (double)w;
+        d = q < 0 ? d / exact_powers_of_ten[-q] : d * exact_powers_of_ten[q];
+        return negative ? -d : d;
+    }
+#endif
+
+    bits = eisel_lemire(w, q);
+    if (num_fast != num_digits || sticky)
+    {
+        // significand was truncated, the true value lies in [w, w + 1) * 10^q
+        bits_up = eisel_lemire(w + 1, q);
+        if (bits != bits_up)
+            bits = round_by_digit_comparison(bits, digits, num_digits, exp10, sticky);
+    }
+
+    return bits_to_double(bits | ((uint64_t)negative << 63));
+}
+
+// Decodes integer token, returns FALSE if the value does not fit into 64 bits
+static int decode_integer(int token, const uint8_t* c, const uint8_t* e, uint64_t* magnitude, int* negative)
+{
+    uint64_t value = 0;
+    uint32_t digit, base = 10;
+
+    *negative = FALSE;
+
+    switch (token)
+    {
+        case TOK_HEX_NUMBER:
+            base = 16;
+            c   += 2;
+            break;
+        case TOK_OCT_NUMBER:
+            base = 8;
+            c   += 1;
+            break;
+        default:
+            if (*c == '-' || *c == '+')
+                *negative = *c++ == '-';
+            break;
+    }
+
+    for (; c < e; ++c)
+    {
+        if (*c <= '9')
+            digit = *c - '0';
+        else
+            digit = (*c | 0x20) - 'a' + 10;
+
+        if (value > (0xFFFFFFFFFFFFFFFFull - digit) / base)
+            return FALSE;
+
+        value = value * base + digit;
+    }
+
+    *magnitude = value;
+
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SIMD helpers
+/////////////////////////////////////////////////////////////////////////////
+
+#if defined(MJSON_AVX2)
+#   define SIMD_WIDTH 32
+#elif defined(MJSON_SSE2) || defined(MJSON_NEON)
+#   define SIMD_WIDTH 16
+#endif
+
+#if defined(SIMD_WIDTH) || defined(_MSC_VER)
+static unsigned bit_scan_forward(uint32_t mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(mask);
+#endif
+}
+#endif
+
+#if defined(MJSON_NEON)
+static uint32_t neon_movemask(uint8x16_t v)
+{
+    static const uint8_t weights[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t bits = vandq_u8(v, vld1q_u8(weights));
+
+    return (uint32_t)vaddv_u8(vget_low_u8(bits)) | ((uint32_t)vaddv_u8(vget_high_u8(bits)) << 8);
+}
+#endif
+
+#if defined(SIMD_WIDTH)
+// Bit i is set if p[i] is one of [ \t\n\r]
+static uint32_t simd_whitespace_mask(const uint8_t* p)
+{
+#if defined(MJSON_AVX2)
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i m = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(' ')),  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\t'))),
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\n')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\r')))
+    );
+    return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(MJSON_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),  _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'))),
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\r')))
+    );
+    return (uint32_t)_mm_movemask_epi8(m);
+#else
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t m = vorrq_u8(
+        vorrq_u8(vceqq_u8(v, vdupq_n_u8(' ')),  vceqq_u8(v, vdupq_n_u8('\t'))),
+        vorrq_u8(vceqq_u8(v, vdupq_n_u8('\n')), vceqq_u8(v, vdupq_n_u8('\r')))
+    );
+    return neon_movemask(m);
+#endif
+}
+
+// Bit i is set if p[i] is either a or b
+static uint32_t simd_match2_mask(const uint8_t* p, uint8_t a, uint8_t b)
+{
+#if defined(MJSON_AVX2)
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i m = _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)a)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)b)));
+    return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(MJSON_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)a)), _mm_cmpeq_epi8(v, _mm_set1_epi8((char)b)));
+    return (uint32_t)_mm_movemask_epi8(m);
+#else
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t m = vorrq_u8(vceqq_u8(v, vdupq_n_u8(a)), vceqq_u8(v, vdupq_n_u8(b)));
+    return neon_movemask(m);
+#endif
+}
+
+// Bit i is set if p[i] is one of a, b or c
+static uint32_t simd_match3_mask(const uint8_t* p, uint8_t a, uint8_t b, uint8_t c)
+{
+#if defined(MJSON_AVX2)
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i m = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)a)), _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)b))),
+        _mm256_cmpeq_epi8(v, _mm256_set1_epi8((char)c))
+    );
+    return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(MJSON_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)a)), _mm_cmpeq_epi8(v, _mm_set1_epi8((char)b))),
+        _mm_cmpeq_epi8(v, _mm_set1_epi8((char)c))
+    );
+    return (uint32_t)_mm_movemask_epi8(m);
+#else
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8(a)), vceqq_u8(v, vdupq_n_u8(b))), vceqq_u8(v, vdupq_n_u8(c)));
+    return neon_movemask(m);
+#endif
+}
+
+// Bit i is set if p[i] has to be escaped in JSON string: '"', '\\' or control
+static uint32_t simd_escape_mask(const uint8_t* p)
+{
+#if defined(MJSON_AVX2)
+    __m256i v = _mm256_loadu_si256((const __m256i*)p);
+    __m256i m = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\'))),
+        _mm256_cmpeq_epi8(_mm256_max_epu8(v, _mm256_set1_epi8(0x1f)), _mm256_set1_epi8(0x1f))
+    );
+    return (uint32_t)_mm256_movemask_epi8(m);
+#elif defined(MJSON_SSE2)
+    __m128i v = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))),
+        _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(0x1f)), _mm_set1_epi8(0x1f))
+    );
+    return (uint32_t)_mm_movemask_epi8(m);
+#else
+    uint8x16_t v = vld1q_u8(p);
+    uint8x16_t m = vorrq_u8(vorrq_u8(vceqq_u8(v, vdupq_n_u8('"')), vceqq_u8(v, vdupq_n_u8('\\'))), vcltq_u8(v, vdupq_n_u8(0x20)));
+    return neon_movemask(m);
+#endif
+}
+#endif
+
+static int is_whitespace(uint8_t ch)
+{
+    return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+static uint8_t* skip_whitespace(uint8_t* c, uint8_t* e)
+{
+#if defined(SIMD_WIDTH)
+    uint32_t mask;
+
+    while (e - c >= SIMD_WIDTH)
+    {
+        mask = ~simd_whitespace_mask(c);
+#if SIMD_WIDTH < 32
+        mask &= (1u << SIMD_WIDTH) - 1;
+#endif
+        if (mask)
+            return c + bit_scan_forward(mask);
+        c += SIMD_WIDTH;
+    }
+#endif
+
+    while (c < e && is_whitespace(*c))
+        ++c;
+
+    return c;
+}
+
+// Returns pointer to the first byte equal to a or b, or e if there is none
+static uint8_t* find_byte2(uint8_t* c, uint8_t* e, uint8_t a, uint8_t b)
+{
+#if defined(SIMD_WIDTH)
+    uint32_t mask;
+
+    while (e - c >= SIMD_WIDTH)
+    {
+        mask = simd_match2_mask(c, a, b);
+        if (mask)
+            return c + bit_scan_forward(mask);
+        c += SIMD_WIDTH;
+    }
+#endif
+
+    while (c < e && *c != a && *c != b)
+        ++c;
+
+    return c;
+}
+
+// Returns pointer to the first byte equal to a, b or c, or e if there is none
+static uint8_t* find_byte3(uint8_t* p, uint8_t* e, uint8_t a, uint8_t b, uint8_t c)
+{
+#if defined(SIMD_WIDTH)
+    uint32_t mask;
+
+    while (e - p >= SIMD_WIDTH)
+    {
+        mask = simd_match3_mask(p, a, b, c);
+        if (mask)
+            return p + bit_scan_forward(mask);
+        p += SIMD_WIDTH;
+    }
+#endif
+
+    while (p < e && *p != a && *p != b && *p != c)
+        ++p;
+
+    return p;
+}
+
+// Skips whitespace and comments in bulk before the lexer DFA runs.
+// Anything unusual (unterminated comment, embedded zero) is left in place,
+// so the DFA still makes the final decision about it. With partial input
+// comment which might extend past e is left in place too.
+static uint8_t* skip_whitespace_and_comments(uint8_t* c, uint8_t* e, int partial)
+{
+    uint8_t* p;
+    uint8_t* q;
+    uint8_t* last;
+
+    while (c < e)
+    {
+        if (is_whitespace(*c))
+            c = skip_whitespace(c + 1, e);
+
+        if (e - c < 2 || c[0] != '/')
+            break;
+
+        if (c[1] == '/')
+        {
+            p = find_byte2(c + 2, e, '\n', 0);
+            if (p == e || *p != '\n')
+                break;
+            c = p + 1;
+        }
+        else if (c[1] == '*')
+        {
+            // MULTILINE_COMMENT is matched greedily: "/" after two or more
+            // stars may be skipped over if the comment closes again later,
+            // only "/" after a single star always closes it.
+            last = NULL;
+            p    = c + 2;
+            while (TRUE)
+            {
+                p = find_byte2(p, e, '*', 0);
+                if (p == e || *p == 0)
+                    break;
+
+                q = p;
+                while (q < e && *q == '*')
+                    ++q;
+
+                if (q < e && *q == '/')
+                {
+                    last = q + 1;
+                    if (q - p == 1)
+                        break;
+                }
+                p = q;
+            }
+
+            if (!last || (partial && p == e))
+                break;
+            c = last;
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    return c;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Structural index
+/////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t whitespace;
+    uint64_t op;
+    uint64_t slash;
+} index_block_t;
+
+static unsigned bit_scan_forward64(uint64_t mask)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return (unsigned)index;
+#elif defined(_MSC_VER)
+    return (uint32_t)mask ? bit_scan_forward((uint32_t)mask) : 32 + bit_scan_forward((uint32_t)(mask >> 32));
+#else
+    return (unsigned)__builtin_ctzll(mask);
+#endif
+}
+
+// Classifies 64 bytes at p into bitmasks, bit i corresponds to p[i]
+static void index_classify_block(const uint8_t* p, index_block_t* block)
+{
+#if defined(SIMD_WIDTH)
+    int i;
+
+    block->quote = block->backslash = block->whitespace = block->op = block->slash = 0;
+
+    for (i = 0; i < INDEX_BLOCK_SIZE; i += SIMD_WIDTH)
+    {
+        uint64_t quote, backslash, whitespace, op, slash;
+#if defined(MJSON_AVX2)
+        __m256i v  = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i lv = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+        quote      = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        backslash  = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        slash      = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+        whitespace = simd_whitespace_mask(p + i);
+        // '{' '}' and '[' ']' differ only in bit 5
+        op = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(
+            _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(lv, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lv, _mm256_set1_epi8('}'))),
+                _mm256_cmpeq_epi8(v, _mm256_set1_epi8(':'))
+            ),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(',')), _mm256_cmpeq_epi8(v, _mm256_set1_epi8('=')))
+        ));
+#elif defined(MJSON_SSE2)
+        __m128i v  = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i lv = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+        quote      = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        backslash  = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        slash      = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+        whitespace = simd_whitespace_mask(p + i);
+        // '{' '}' and '[' ']' differ only in bit 5
+        op = (uint32_t)_mm_movemask_epi8(_mm_or_si128(
+            _mm_or_si128(
+                _mm_or_si128(_mm_cmpeq_epi8(lv, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lv, _mm_set1_epi8('}'))),
+                _mm_cmpeq_epi8(v, _mm_set1_epi8(':'))
+            ),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(',')), _mm_cmpeq_epi8(v, _mm_set1_epi8('=')))
+        ));
+#else
+        uint8x16_t v  = vld1q_u8(p + i);
+        uint8x16_t lv = vorrq_u8(v, vdupq_n_u8(0x20));
+
+        quote      = neon_movemask(vceqq_u8(v, vdupq_n_u8('"')));
+        backslash  = neon_movemask(vceqq_u8(v, vdupq_n_u8('\\')));
+        slash      = neon_movemask(vceqq_u8(v, vdupq_n_u8('/')));
+        whitespace = simd_whitespace_mask(p + i);
+        // '{' '}' and '[' ']' differ only in bit 5
+        op = neon_movemask(vorrq_u8(
+            vorrq_u8(
+                vorrq_u8(vceqq_u8(lv, vdupq_n_u8('{')), vceqq_u8(lv, vdupq_n_u8('}'))),
+                vceqq_u8(v, vdupq_n_u8(':'))
+            ),
+            vorrq_u8(vceqq_u8(v, vdupq_n_u8(',')), vceqq_u8(v, vdupq_n_u8('=')))
+        ));
+#endif
+        block->quote      |= quote      << i;
+        block->backslash  |= backslash  << i;
+        block->whitespace |= whitespace << i;
+        block->op         |= op         << i;
+        block->slash      |= slash      << i;
+    }
+#else
+    int      i;
+    uint64_t bit;
+
+    block->quote = block->backslash = block->whitespace = block->op = block->slash = 0;
+
+    for (i = 0; i < INDEX_BLOCK_SIZE; ++i)
+    {
+        bit = 1ull << i;
+        if (p[i] == '"')          block->quote      |= bit;
+        if (p[i] == '\\')         block->backslash  |= bit;
+        if (p[i] == '/')          block->slash      |= bit;
+        if (is_whitespace(p[i]))  block->whitespace |= bit;
+        if (p[i] == '{' || p[i] == '}' || p[i] == '[' || p[i] == ']' ||
+            p[i] == ':' || p[i] == ',' || p[i] == '=')
+                                  block->op         |= bit;
+    }
+#endif
+}
+
+// Lighter index_classify_block for skipping containers: op marks brackets
+// only and whitespace is not computed
+static void index_classify_brackets(const uint8_t* p, index_block_t* block)
+{
+#if defined(SIMD_WIDTH)
+    int i;
+
+    block->quote = block->backslash = block->whitespace = block->op = block->slash = 0;
+
+    for (i = 0; i < INDEX_BLOCK_SIZE; i += SIMD_WIDTH)
+    {
+        uint64_t quote, backslash, op, slash;
+#if defined(MJSON_AVX2)
+        __m256i v  = _mm256_loadu_si256((const __m256i*)(p + i));
+        __m256i lv = _mm256_or_si256(v, _mm256_set1_epi8(0x20));
+
+        quote     = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+        backslash = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+        slash     = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('/')));
+        op        = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_cmpeq_epi8(lv, _mm256_set1_epi8('{')), _mm256_cmpeq_epi8(lv, _mm256_set1_epi8('}'))));
+#elif defined(MJSON_SSE2)
+        __m128i v  = _mm_loadu_si128((const __m128i*)(p + i));
+        __m128i lv = _mm_or_si128(v, _mm_set1_epi8(0x20));
+
+        quote     = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+        backslash = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+        slash     = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('/')));
+        op        = (uint32_t)_mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(lv, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lv, _mm_set1_epi8('}'))));
+#else
+        uint8x16_t v  = vld1q_u8(p + i);
+        uint8x16_t lv = vorrq_u8(v, vdupq_n_u8(0x20));
+
+        quote     = neon_movemask(vceqq_u8(v, vdupq_n_u8('"')));
+        backslash = neon_movemask(vceqq_u8(v, vdupq_n_u8('\\')));
+        slash     = neon_movemask(vceqq_u8(v, vdupq_n_u8('/')));
+        op        = neon_movemask(vorrq_u8(vceqq_u8(lv, vdupq_n_u8('{')), vceqq_u8(lv, vdupq_n_u8('}'))));
+#endif
+        block->quote     |= quote     << i;
+        block->backslash |= backslash << i;
+        block->op        |= op        << i;
+        block->slash     |= slash     << i;
+    }
+#else
+    int      i;
+    uint64_t bit;
+
+    block->quote = block->backslash = block->whitespace = block->op = block->slash = 0;
+
+    for (i = 0; i < INDEX_BLOCK_SIZE; ++i)
+    {
+        bit = 1ull << i;
+        if (p[i] == '"')  block->quote     |= bit;
+        if (p[i] == '\\') block->backslash |= bit;
+        if (p[i] == '/')  block->slash     |= bit;
+        if (p[i] == '{' || p[i] == '}' || p[i] == '[' || p[i] == ']')
+                          block->op        |= bit;
+    }
+#endif
+}
+
+static uint64_t prefix_xor(uint64_t x)
+{
+    x ^= x << 1;
+    x ^= x << 2;
+    x ^= x << 4;
+    x ^= x << 8;
+    x ^= x << 16;
+    x ^= x << 32;
+    return x;
+}
+
+// Mask of characters escaped by odd length backslash sequences, prev_escaped
+// carries escape over to the next block
+static uint64_t index_escaped_chars(uint64_t* prev_escaped, uint64_t backslash)
+{
+    const uint64_t even_bits = 0x5555555555555555ull;
+    uint64_t follows_escape, odd_starts, sequences_on_even;
+
+    backslash        &= ~*prev_escaped;
+    follows_escape    = (backslash << 1) | *prev_escaped;
+    odd_starts        = backslash & ~even_bits & ~follows_escape;
+    sequences_on_even = odd_starts + backslash;
+
+    *prev_escaped = sequences_on_even < odd_starts;
+
+    return (even_bits ^ (sequences_on_even << 1)) & follows_escape;
+}
+
+static void index_init(mjson_index_t* index, uint8_t* json_data)
+{
+    index->count          = 0;
+    index->current        = 0;
+    index->scan           = json_data;
+    index->prev_in_string = 0;
+    index->prev_escaped   = 0;
+    index->prev_scalar    = 0;
+}
+
+// Stage one: fills index with positions of tokens starts and string ends
+static void index_fill(mjson_index_t* index, uint8_t* e)
+{
+    uint8_t       padded[INDEX_BLOCK_SIZE];
+    index_block_t block;
+    uint8_t*      c = index->scan;
+    uint8_t*      block_end;
+    uint8_t*      comment_end;
+    uint8_t**     out;
+    uint64_t      quote, in_string, scalar, starts, valid, slash, prev_scalar;
+    ptrdiff_t     len;
+    unsigned      slash_pos = 0;
+
+    index->count   = 0;
+    index->current = 0;
+
+    while (c < e && INDEX_CAPACITY - index->count > INDEX_BLOCK_SIZE)
+    {
+        len = e - c;
+        if (len >= INDEX_BLOCK_SIZE)
+        {
+            index_classify_block(c, &block);
+            valid     = ~0ull;
+            block_end = c + INDEX_BLOCK_SIZE;
+        }
+        else
+        {
+            memset(padded, ' ', sizeof(padded));
+            memcpy(padded, c, len);
+            index_classify_block(padded, &block);
+            valid     = (1ull << len) - 1;
+            block_end = e;
+        }
+
+        quote     = block.quote & ~index_escaped_chars(&index->prev_escaped, block.backslash);
+        in_string = prefix_xor(quote) ^ index->prev_in_string;
+
+        // block is processed only up to the first slash outside of strings,
+        // comment after it would invalidate string state computed for the rest
+        slash = block.slash & ~in_string & valid;
+        if (slash)
+        {
+            slash_pos = bit_scan_forward64(slash);
+            valid    &= (1ull << slash_pos) - 1;
+        }
+
+        scalar = ~(block.whitespace | block.op | quote | in_string);
+        starts = (block.op & ~in_string) | quote | (scalar & ~((scalar << 1) | index->prev_scalar));
+        starts &= valid;
+
+        out = index->positions + index->count;
+        while (starts)
+        {
+            *out++  = c + bit_scan_forward64(starts);
+            starts &= starts - 1;
+        }
+
+        if (slash)
+        {
+            prev_scalar = slash_pos ? (scalar >> (slash_pos - 1)) & 1 : index->prev_scalar;
+            c          += slash_pos;
+
+            comment_end = c;
+            if (e - c >= 2 && (c[1] == '/' || c[1] == '*'))
+                comment_end = skip_whitespace_and_comments(c, e, FALSE);
+
+            index->prev_in_string = 0;
+            index->prev_escaped   = 0;
+
+            if (comment_end == c)
+            {
+                // not a comment or unterminated one, lexer will report it
+                if (!prev_scalar)
+                    *out++ = c;
+                index->prev_scalar = 1;
+                ++c;
+            }
+            else
+            {
+                index->prev_scalar = 0;
+                c = comment_end;
+            }
+        }
+        else
+        {
+            index->prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+            index->prev_scalar    = scalar >> 63;
+            c = block_end;
+        }
+
+        index->count = (int)(out - index->positions);
+    }
+
+    index->scan = c < e ? c : e;
+}
+
+static int is_digit(uint8_t ch)
+{
+    return ch >= '0' && ch <= '9';
+}
+
+static int is_hex_digit(uint8_t ch)
+{
+    return is_digit(ch) || ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'f');
+}
+
+// Lexes string starting at quote c, returns pointer past closing quote or
+// NULL if the DFA should decide (invalid escape, embedded zero, no end).
+static uint8_t* lex_string(uint8_t* c, uint8_t* e, int* token)
+{
+    *token = TOK_NOESC_STRING;
+
+    ++c;
+    while (TRUE)
+    {
+        c = find_byte3(c, e, '"', '\\', 0);
+
+        if (c == e || *c == 0)
+            return NULL;
+
+        if (*c == '"')
+            return c + 1;
+
+        *token = TOK_STRING;
+
+        if (e - c < 2)
+            return NULL;
+
+        switch (c[1])
+        {
+            case '"': case '\\': case '/':
+            case 'b': case 'f': case 'n': case 'r': case 't':
+                c += 2;
+                break;
+
+            case 'u':
+                if (e - c < 6 || !is_hex_digit(c[2]) || !is_hex_digit(c[3]) || !is_hex_digit(c[4]) || !is_hex_digit(c[5]))
+                    return NULL;
+                c += 6;
+                break;
+
+            default:
+                return NULL;
+        }
+    }
+}
+
+static int is_ident_char(uint8_t ch)
+{
+    return is_digit(ch) || ((ch | 0x20) >= 'a' && (ch | 0x20) <= 'z') || ch == '_';
+}
+
+// Lexes common identifiers and numbers without the DFA, returns token end
+// or NULL if DFA should decide.
+static uint8_t* index_lex_scalar(uint8_t* c, uint8_t* e, int* token)
+{
+    uint8_t* s = c;
+    uint8_t* d;
+
+    if (is_ident_char(*c) && !is_digit(*c))
+    {
+        while (c < e && is_ident_char(*c))
+            ++c;
+
+        *token = TOK_IDENTIFIER;
+        if      (c - s == 4 && memcmp(s, "true",  4) == 0) *token = TOK_TRUE;
+        else if (c - s == 5 && memcmp(s, "false", 5) == 0) *token = TOK_FALSE;
+        else if (c - s == 4 && memcmp(s, "null",  4) == 0) *token = TOK_NULL;
+
+        return c;
+    }
+
+    if (*c == '-' || *c == '+')
+        ++c;
+
+    d = c;
+    while (c < e && is_digit(*c))
+        ++c;
+
+    if (c == d || (*d == '0' && c - d > 1))
+        return NULL;
+
+    *token = TOK_DEC_NUMBER;
+    if (c < e && *c == '.')
+    {
+        d = ++c;
+        while (c < e && is_digit(*c))
+            ++c;
+        if (c == d)
+            return NULL;
+        *token = TOK_FLOAT_NUMBER;
+    }
+
+    // exponents, hex, octal and oddities like "1.2.3" are left to the DFA
+    if (c < e && (is_ident_char(*c) || *c == '.'))
+        return NULL;
+
+    return c;
+}
+
+// Stage two: produces next token from the index. Returns FALSE when token
+// has to be lexed by the DFA starting at context->next.
+static int parsectx_next_indexed_token(mjson_parser_t* context)
+{
+    mjson_index_t* index = context->index;
+    uint8_t*       c     = context->next;
+    uint8_t*       t;
+    uint8_t*       close;
+
+    // skip positions consumed by the DFA
+    while (TRUE)
+    {
+        if (index->current == index->count)
+        {
+            if (index->scan == context->end)
+            {
+                t = context->end;
+                break;
+            }
+            index_fill(index, context->end);
+            continue;
+        }
+
+        t = index->positions[index->current];
+        if (t >= c)
+            break;
+        ++index->current;
+    }
+
+    // only whitespace may be skipped, anything else is left to the DFA
+    if (c != t && !is_whitespace(*c))
+        return FALSE;
+
+    if (t == context->end)
+    {
+        context->token = TOK_NONE;
+        return TRUE;
+    }
+
+    ++index->current;
+
+    switch (*t)
+    {
+        case '{': context->token = TOK_LEFT_CURLY_BRACKET;  break;
+        case '}': context->token = TOK_RIGHT_CURLY_BRACKET; break;
+        case '[': context->token = TOK_LEFT_BRACKET;        break;
+        case ']': context->token = TOK_RIGHT_BRACKET;       break;
+        case ':': context->token = TOK_COLON;               break;
+        case '=': context->token = TOK_EQUAL;               break;
+        case ',': context->token = TOK_COMMA;               break;
+
+        case '"':
+            if (index->current == index->count && index->scan != context->end)
+                index_fill(index, context->end);
+
+            if (index->current == index->count)
+            {
+                context->next = t;
+                return FALSE;
+            }
+
+            close = index->positions[index->current];
+            if (!memchr(t + 1, '\\', close - t - 1) && !memchr(t + 1, 0, close - t - 1))
+            {
+                ++index->current;
+                context->token = TOK_NOESC_STRING;
+                context->start = t;
+                context->next  = close + 1;
+                return TRUE;
+            }
+
+            context->next = lex_string(t, context->end, &context->token);
+            if (!context->next)
+            {
+                context->next = t;
+                return FALSE;
+            }
+            context->start = t;
+            return TRUE;
+
+        default:
+            context->next = index_lex_scalar(t, context->end, &context->token);
+            if (!context->next)
+            {
+                context->next = t;
+                return FALSE;
+            }
+            context->start = t;
+            return TRUE;
+    }
+
+    context->start = t;
+    context->next  = t + 1;
+
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Lexer+Parser code
+/////////////////////////////////////////////////////////////////////////////
+
+
+
+static void parsectx_next_token(mjson_parser_t* context)
+{
+#if defined(MJSON_STATS)
+    if (context->stats)
+    {
+        stats_next_token(context);
+        return;
+    }
+#endif
+
+    parsectx_lex_token(context);
+}
+
+static void parsectx_lex_token(mjson_parser_t* context)
+{
+// hit_end is only tracked for partial input of the streaming parser and
+// only written once the end is reached, serial parsing reads no flag per byte
+#define YYREADINPUT(c) (c>=e?(context->partial?(context->hit_end=TRUE,0):0):*c)
+#define YYCTYPE        uint8_t
+#define YYCURSOR       c
+#define YYMARKER       m
+
+    uint8_t* c = context->next;
+    uint8_t* e = context->end;
+    uint8_t* m = NULL;
+    uint8_t* s;
+    int token = TOK_NONE;
+
+    assert(context);
+    RETURN_IF_FAIL(context->next != NULL);
+
+    if (context->partial)
+        context->hit_end = FALSE;
+
+    if (context->index)
+    {
+        if (parsectx_next_indexed_token(context))
+            return;
+        c = context->next;
+    }
+
+    while (TRUE)
+    {
+        c = skip_whitespace_and_comments(c, e, context->partial);
+        s = c;
+
+        if (c < e && *c == '"')
+        {
+            c = lex_string(s, e, &token);
+            if (c)
+                goto done;
+            c = s;
+        }
+
+
+        {
+            YYCTYPE yych;
+            unsigned int yyaccept = 0;
+
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '<') {
+                if (yych <= '"') {
+                    if (yych <= '\f') {
+                        if (yych <= 0x00) goto yy31;
+                        if (yych <= 0x08) goto yy33;
+                        if (yych >= '\v') goto yy33;
+                    } else {
+                        if (yych <= 0x1F) {
+                            if (yych >= 0x0E) goto yy33;
+                        } else {
+                            if (yych <= ' ') goto yy2;
+                            if (yych <= '!') goto yy33;
+                            goto yy30;
+                        }
+                    }
+                } else {
+                    if (yych <= '.') {
+                        if (yych <= '+') {
+                            if (yych <= '*') goto yy33;
+                            goto yy22;
+                        } else {
+                            if (yych <= ',') goto yy18;
+                            if (yych <= '-') goto yy22;
+                            goto yy24;
+                        }
+                    } else {
+                        if (yych <= '0') {
+                            if (yych <= '/') goto yy4;
+                            goto yy20;
+                        } else {
+                            if (yych <= '9') goto yy23;
+                            if (yych <= ':') goto yy14;
+                            goto yy33;
+                        }
+                    }
+                }
+            } else {
+                if (yych <= 'e') {
+                    if (yych <= '\\') {
+                        if (yych <= '@') {
+                            if (yych <= '=') goto yy16;
+                            goto yy33;
+                        } else {
+                            if (yych <= 'Z') goto yy29;
+                            if (yych <= '[') goto yy10;
+                            goto yy33;
+                        }
+                    } else {
+                        if (yych <= '^') {
+                            if (yych <= ']') goto yy12;
+                            goto yy33;
+                        } else {
+                            if (yych == '`') goto yy33;
+                            goto yy29;
+                        }
+                    }
+                } else {
+                    if (yych <= 't') {
+                        if (yych <= 'm') {
+                            if (yych <= 'f') goto yy27;
+                            goto yy29;
+                        } else {
+                            if (yych <= 'n') goto yy28;
+                            if (yych <= 's') goto yy29;
+                            goto yy25;
+                        }
+                    } else {
+                        if (yych <= '{') {
+                            if (yych <= 'z') goto yy29;
+                            goto yy6;
+                        } else {
+                            if (yych == '}') goto yy8;
+                            goto yy33;
+                        }
+                    }
+                }
+            }
+yy2:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            goto yy126;
+yy3:
+            {
+                continue; 
+            }
+yy4:
+            yyaccept = 0;
+            ++YYCURSOR;
+            YYMARKER = YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych == '*') goto yy108;
+            if (yych == '/') goto yy110;
+yy5:
+            {
+                context->token = TOK_INVALID;
+                return;
+            }
+yy6:
+            ++YYCURSOR;
+            {
+                token = TOK_LEFT_CURLY_BRACKET;
+                goto done;
+            }
+yy8:
+            ++YYCURSOR;
+            {
+                token = TOK_RIGHT_CURLY_BRACKET;
+                goto done;
+            }
+yy10:
+            ++YYCURSOR;
+            {
+                token = TOK_LEFT_BRACKET;
+                goto done;
+            }
+yy12:
+            ++YYCURSOR;
+            {
+                token = TOK_RIGHT_BRACKET;
+                goto done;
+            }
+yy14:
+            ++YYCURSOR;
+            {
+                token = TOK_COLON;
+                goto done;
+            }
+yy16:
+            ++YYCURSOR;
+            {
+                token = TOK_EQUAL;
+                goto done;
+            }
+yy18:
+            ++YYCURSOR;
+            {
+                token = TOK_COMMA;
+                goto done;
+            }
+yy20:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 'X') {
+                if (yych <= '/') {
+                    if (yych == '.') goto yy100;
+                } else {
+                    if (yych <= '9') goto yy100;
+                    if (yych <= '@') goto yy21;
+                    if (yych <= 'W') goto yy100;
+                    goto yy104;
+                }
+            } else {
+                if (yych <= '`') {
+                    if (yych <= 'Z') goto yy100;
+                    if (yych == '_') goto yy100;
+                } else {
+                    if (yych == 'x') goto yy104;
+                    if (yych <= 'z') goto yy100;
+                }
+            }
+yy21:
+            {
+                token = TOK_DEC_NUMBER;
+                goto done;
+            }
+yy22:
+            yyaccept = 0;
+            ++YYCURSOR;
+            YYMARKER = YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '/') {
+                if (yych == '.') goto yy95;
+                goto yy5;
+            } else {
+                if (yych <= '0') goto yy92;
+                if (yych <= '9') goto yy93;
+                goto yy5;
+            }
+yy23:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            goto yy71;
+yy24:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '/') goto yy5;
+            if (yych <= '9') goto yy63;
+            goto yy5;
+yy25:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych == 'r') goto yy59;
+            goto yy49;
+yy26:
+            {
+                token = TOK_IDENTIFIER;
+                goto done;
+            }
+yy27:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych == 'a') goto yy54;
+            goto yy49;
+yy28:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych == 'u') goto yy50;
+            goto yy49;
+yy29:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            goto yy49;
+yy30:
+            yyaccept = 0;
+            ++YYCURSOR;
+            YYMARKER = YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 0x00) goto yy5;
+            goto yy35;
+yy31:
+            ++YYCURSOR;
+            { 
+                context->token = TOK_NONE;
+                return;
+            }
+yy33:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            goto yy5;
+yy34:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+yy35:
+            if (yych <= '"') {
+                if (yych <= 0x00) goto yy36;
+                if (yych <= '!') goto yy34;
+                goto yy38;
+            } else {
+                if (yych == '\\') goto yy37;
+                goto yy34;
+            }
+yy36:
+            YYCURSOR = YYMARKER;
+            if (yyaccept <= 2) {
+                if (yyaccept <= 1) {
+                    if (yyaccept == 0) {
+                        goto yy5;
+                    } else {
+                        goto yy65;
+                    }
+                } else {
+                    goto yy74;
+                }
+            } else {
+                if (yyaccept == 3) {
+                    goto yy21;
+                } else {
+                    goto yy120;
+                }
+            }
+yy37:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 'e') {
                 if (yych <= '/') {
                     if (yych == '"') goto yy41;
                     if (yych <= '.') goto yy36;
@@ -1164,617 +4941,3519 @@ yy100:
             }
 yy101:
             {
-                token = TOK_OCT_NUMBER;
-                goto done;
+                token = TOK_OCT_NUMBER;
+                goto done;
+            }
+yy102:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 'E') {
+                if (yych <= '/') {
+                    if (yych == '.') goto yy76;
+                    goto yy74;
+                } else {
+                    if (yych <= '9') goto yy102;
+                    if (yych <= '@') goto yy74;
+                    if (yych <= 'D') goto yy72;
+                    goto yy75;
+                }
+            } else {
+                if (yych <= '`') {
+                    if (yych <= 'Z') goto yy72;
+                    if (yych == '_') goto yy72;
+                    goto yy74;
+                } else {
+                    if (yych == 'e') goto yy75;
+                    if (yych <= 'z') goto yy72;
+                    goto yy74;
+                }
+            }
+yy104:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 'Z') {
+                if (yych <= '/') goto yy74;
+                if (yych <= '9') goto yy106;
+                if (yych <= '@') goto yy74;
+                goto yy106;
+            } else {
+                if (yych <= '_') {
+                    if (yych <= '^') goto yy74;
+                    goto yy106;
+                } else {
+                    if (yych <= '`') goto yy74;
+                    if (yych <= 'z') goto yy106;
+                    goto yy74;
+                }
+            }
+yy105:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+yy106:
+            if (yych <= 'Z') {
+                if (yych <= '9') {
+                    if (yych >= '0') goto yy105;
+                } else {
+                    if (yych <= '@') goto yy107;
+                    if (yych <= 'F') goto yy105;
+                    goto yy72;
+                }
+            } else {
+                if (yych <= '`') {
+                    if (yych == '_') goto yy72;
+                } else {
+                    if (yych <= 'f') goto yy105;
+                    if (yych <= 'z') goto yy72;
+                }
+            }
+yy107:
+            {
+                token = TOK_HEX_NUMBER;
+                goto done;
+            }
+yy108:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 0x00) goto yy36;
+            if (yych == '*') goto yy114;
+            goto yy108;
+yy110:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 0x00) goto yy36;
+            if (yych != '\n') goto yy110;
+            ++YYCURSOR;
+            {
+                continue; 
+            }
+yy114:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych == '*') goto yy117;
+            if (yych == '/') goto yy119;
+            goto yy116;
+yy115:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+yy116:
+            if (yych <= 0x00) goto yy36;
+            if (yych == '*') goto yy122;
+            goto yy115;
+yy117:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '*') {
+                if (yych <= 0x00) goto yy36;
+                if (yych <= ')') goto yy115;
+                goto yy117;
+            } else {
+                if (yych == '/') goto yy121;
+                goto yy115;
+            }
+yy119:
+            ++YYCURSOR;
+yy120:
+            {
+                continue; 
+            }
+yy121:
+            yyaccept = 4;
+            ++YYCURSOR;
+            YYMARKER = YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= 0x00) goto yy120;
+            if (yych != '*') goto yy115;
+yy122:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '*') {
+                if (yych <= 0x00) goto yy36;
+                if (yych <= ')') goto yy115;
+            } else {
+                if (yych == '/') goto yy119;
+                goto yy115;
+            }
+yy123:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+            if (yych <= '*') {
+                if (yych <= 0x00) goto yy36;
+                if (yych <= ')') goto yy115;
+                goto yy123;
+            } else {
+                if (yych == '/') goto yy121;
+                goto yy115;
+            }
+yy125:
+            ++YYCURSOR;
+            yych = YYREADINPUT(YYCURSOR);
+yy126:
+            if (yych <= '\f') {
+                if (yych <= 0x08) goto yy3;
+                if (yych <= '\n') goto yy125;
+                goto yy3;
+            } else {
+                if (yych <= '\r') goto yy125;
+                if (yych == ' ') goto yy125;
+                goto yy3;
+            }
+        }
+
+    }
+
+done:
+    context->token = token;
+    context->start = s;
+    context->next  = c;
+
+#undef YYREADINPUT
+#undef YYCTYPE           
+#undef YYCURSOR          
+#undef YYMARKER          
+}
+
+// Chooses BJSON type and payload for number token
+// Floating point values are stored as FLOAT32 when it keeps them exact
+static void double_entry(double value, uint32_t* id, uint64_t* bits)
+{
+    float value_f32 = (float)value;
+
+    if ((double)value_f32 == value)
+    {
+        *id   = MJSON_ID_FLOAT32;
+        *bits = 0;
+        memcpy(bits, &value_f32, sizeof(value_f32));
+    }
+    else
+    {
+        *id   = MJSON_ID_FLOAT64;
+        *bits = double_to_bits(value);
+    }
+}
+
+// Smallest entry for integer, fails for negative values below INT64_MIN
+static int integer_entry(uint64_t magnitude, int negative, uint32_t* id, uint64_t* bits)
+{
+    if (negative)
+    {
+        if (magnitude > 0x8000000000000000ull)
+            return 0;
+
+        *id   = magnitude <= 0x80000000u ? MJSON_ID_SINT32 : MJSON_ID_SINT64;
+        *bits = 0 - magnitude;
+    }
+    else
+    {
+        if (magnitude <= 0x7FFFFFFFu)
+            *id = MJSON_ID_SINT32;
+        else if (magnitude <= 0x7FFFFFFFFFFFFFFFull)
+            *id = MJSON_ID_SINT64;
+        else
+            *id = MJSON_ID_UINT64;
+        *bits = magnitude;
+    }
+
+    return 1;
+}
+
+static int decode_number(mjson_parser_t *context, uint32_t* id, uint64_t* bits)
+{
+    uint32_t       bjson_id;
+    uint64_t       magnitude, payload;
+    int            negative;
+    double         value;
+
+    if (context->token == TOK_FLOAT_NUMBER ||
+        !decode_integer(context->token, context->start, context->next, &magnitude, &negative))
+    {
+        // decimal integers which do not fit into 64 bits are kept as floating point
+        if (context->token != TOK_FLOAT_NUMBER && context->token != TOK_DEC_NUMBER)
+            return 0;
+
+        value = decode_double(context->start, context->next);
+
+        double_entry(value, &bjson_id, &payload);
+    }
+    else if (!integer_entry(magnitude, negative, &bjson_id, &payload))
+    {
+        bjson_id = MJSON_ID_FLOAT64;
+        payload  = double_to_bits(decode_double(context->start, context->next));
+    }
+
+    *id   = bjson_id;
+    *bits = payload;
+
+    return 1;
+}
+
+// Size of number entry, 64 bit payload follows id directly
+static ptrdiff_t number_entry_size(uint32_t bjson_id)
+{
+    return (ptrdiff_t)sizeof(uint32_t) + ((bjson_id == MJSON_ID_SINT32 || bjson_id == MJSON_ID_FLOAT32) ? sizeof(uint32_t) : sizeof(uint64_t));
+}
+
+static int emit_number(mjson_parser_t *context)
+{
+    uint32_t       bjson_id;
+    uint64_t       payload;
+    int            result;
+    STATS_START(context);
+
+    result = decode_number(context, &bjson_id, &payload) &&
+             emit_number_entry(context, bjson_id, payload);
+
+    STATS_TICKS(context, number_ticks);
+
+    return result;
+}
+
+static int emit_number_entry(mjson_parser_t *context, uint32_t bjson_id, uint64_t payload)
+{
+    uint8_t*       bdata;
+    ptrdiff_t      payload_size;
+
+    payload_size = number_entry_size(bjson_id) - (ptrdiff_t)sizeof(uint32_t);
+
+    bdata = (uint8_t*)parsectx_allocate_output(context, (ptrdiff_t)sizeof(uint32_t) + payload_size);
+
+    if (!bdata) return 0;
+
+    memcpy(bdata, &bjson_id, sizeof(uint32_t));
+    if (payload_size == sizeof(uint32_t))
+    {
+        uint32_t payload_u32 = (uint32_t)payload;
+        memcpy(bdata + sizeof(uint32_t), &payload_u32, sizeof(uint32_t));
+    }
+    else
+    {
+        memcpy(bdata + sizeof(uint32_t), &payload, sizeof(uint64_t));
+    }
+
+    return 1;
+}
+
+// Values of hex digits, digits are already validated by the lexer
+static const uint8_t hex_digit_value[256] = {
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9,  0,  0,  0,  0,  0,  0,
+     0, 10, 11, 12, 13, 14, 15,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0, 10, 11, 12, 13, 14, 15,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0
+};
+
+static uint32_t decode_hex4(const uint8_t* c)
+{
+    return ((uint32_t)hex_digit_value[c[0]] << 12) | ((uint32_t)hex_digit_value[c[1]] << 8) |
+           ((uint32_t)hex_digit_value[c[2]] <<  4) |  (uint32_t)hex_digit_value[c[3]];
+}
+
+// Length of code point in UTF-8 as written by unicode_cp_to_utf8
+static size_t utf8_length(uint32_t ch)
+{
+    return ch < 0x80 ? 1 : ch < 0x800 ? 2 : ch < 0x10000 ? 3 : 4;
+}
+
+// Returns pointer to the first backslash, or e if there is none
+static uint8_t* find_backslash(uint8_t* c, uint8_t* e)
+{
+    uint8_t* p = (uint8_t*)memchr(c, '\\', e - c);
+
+    return p ? p : e;
+}
+
+// Decodes \\uXXXX escape at c, surrogate pair is combined into single code
+// point, lone surrogates are kept as is. Returns end of the escape.
+static uint8_t* decode_unicode_escape(uint8_t* c, uint8_t* e, uint32_t* cp)
+{
+    uint32_t ch, low;
+
+    ch = decode_hex4(c + 2);
+    c += 6;
+
+    if (ch >= 0xD800 && ch < 0xDC00 && e - c >= 6 && c[0] == '\\' && c[1] == 'u')
+    {
+        low = decode_hex4(c + 2);
+        if (low >= 0xDC00 && low < 0xE000)
+        {
+            ch = 0x10000 + ((ch - 0xD800) << 10) + (low - 0xDC00);
+            c += 6;
+        }
+    }
+
+    *cp = ch;
+
+    return c;
+}
+
+// Length of escaped string contents [c, e) after decode_string
+static size_t decoded_string_length(uint8_t* c, uint8_t* e)
+{
+    size_t   len = 0;
+    uint8_t* s;
+    uint32_t ch;
+
+    while (TRUE)
+    {
+        s = c;
+        c = find_backslash(c, e);
+        len += c - s;
+
+        if (c == e)
+            return len;
+
+        if (c[1] != 'u')
+        {
+            ++len;
+            c += 2;
+            continue;
+        }
+
+        c = decode_unicode_escape(c, e, &ch);
+        len += utf8_length(ch);
+    }
+}
+
+// Decodes escaped string contents [c, e) validated by the lexer into dst,
+// returns end of decoded data or NULL if it does not fit before limit.
+static uint8_t* decode_string(uint8_t* c, uint8_t* e, uint8_t* dst, uint8_t* limit)
+{
+    uint8_t* s;
+    uint32_t ch;
+    size_t   len;
+
+    while (TRUE)
+    {
+        s = c;
+        c = find_backslash(c, e);
+
+        if (limit - dst < c - s)
+            return NULL;
+
+        memcpy(dst, s, c - s);
+        dst += c - s;
+
+        if (c == e)
+            return dst;
+
+        if (c[1] != 'u')
+        {
+            if (dst == limit)
+                return NULL;
+
+            switch (c[1])
+            {
+                case 'b': *dst++ = '\b'; break;
+                case 'f': *dst++ = '\f'; break;
+                case 'n': *dst++ = '\n'; break;
+                case 'r': *dst++ = '\r'; break;
+                case 't': *dst++ = '\t'; break;
+                default:  *dst++ = c[1];  break;
             }
-yy102:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 'E') {
-                if (yych <= '/') {
-                    if (yych == '.') goto yy76;
-                    goto yy74;
-                } else {
-                    if (yych <= '9') goto yy102;
-                    if (yych <= '@') goto yy74;
-                    if (yych <= 'D') goto yy72;
-                    goto yy75;
-                }
-            } else {
-                if (yych <= '`') {
-                    if (yych <= 'Z') goto yy72;
-                    if (yych == '_') goto yy72;
-                    goto yy74;
-                } else {
-                    if (yych == 'e') goto yy75;
-                    if (yych <= 'z') goto yy72;
-                    goto yy74;
-                }
+
+            c += 2;
+            continue;
+        }
+
+        c = decode_unicode_escape(c, e, &ch);
+
+        if ((size_t)(limit - dst) < utf8_length(ch))
+            return NULL;
+
+        unicode_cp_to_utf8(ch, dst, &len);
+        dst += len;
+    }
+}
+
+// Replaces string just emitted at entry with reference to identical string
+// emitted earlier, if it is still in the cache.
+static void intern_string(mjson_parser_t* context, mjson_entry_t* entry)
+{
+    mjson_entry_t* original;
+    uint32_t       len = entry->val_u32;
+    size_t*        slot;
+
+    if (!context->intern || (entry->id != MJSON_ID_UTF8_KEY32 && entry->id != MJSON_ID_UTF8_STRING32))
+        return;
+
+    if (entry->id == MJSON_ID_UTF8_KEY32 && !(context->flags & MJSON_PARSE_INTERN_KEYS))
+        return;
+
+    if (entry->id == MJSON_ID_UTF8_STRING32 && (!(context->flags & MJSON_PARSE_INTERN_STRINGS) || len > INTERN_MAX_STRING))
+        return;
+
+    slot = &context->intern->offsets[hash_key((const uint8_t*)(entry + 1), len) & (INTERN_CACHE_SIZE - 1)];
+
+    if (*slot)
+    {
+        original = (mjson_entry_t*)(context->bjson_start + *slot);
+        if (original->val_u32 == len && memcmp(original + 1, entry + 1, len) == 0 &&
+            (size_t)((uint8_t*)entry - (uint8_t*)original) <= INTERN_MAX_DISTANCE)
+        {
+            entry->id     |= MJSON_FLAG_REF;
+            entry->val_u32 = (uint32_t)((uint8_t*)entry - (uint8_t*)original);
+            context->bjson = (uint8_t*)(entry + 1);
+            return;
+        }
+    }
+
+    *slot = (uint8_t*)entry - context->bjson_start;
+}
+
+// String which needs no decoding
+static int emit_raw_string(mjson_parser_t *context, uint32_t id, const uint8_t* str_src, size_t str_len)
+{
+    mjson_entry_t* bdata;
+    uint8_t*       str_dst;
+    uint64_t       len64 = str_len;
+    ptrdiff_t      offset;
+
+    if (str_len > MJSON_MAX_SIZE32)
+    {
+        bdata = (mjson_entry_t*)parsectx_allocate_output(context, (ptrdiff_t)(sizeof(uint32_t) + sizeof(uint64_t) + str_len + 1));
+
+        if (!bdata) return 0;
+
+        bdata->id = id + 1;
+        memcpy(&bdata->val_u32, &len64, sizeof(len64));
+        str_dst   = (uint8_t*)bdata + sizeof(uint32_t) + sizeof(uint64_t);
+
+        memcpy(str_dst, str_src, str_len);
+        str_dst[str_len] = 0;
+
+        return parsectx_align4_output(context);
+    }
+
+    bdata = (mjson_entry_t*)parsectx_allocate_output(context, (ptrdiff_t)(sizeof(mjson_entry_t) + str_len + 1));
+
+    if (!bdata) return 0;
+
+    bdata->id      = id;
+    bdata->val_u32 = (uint32_t)str_len;
+    str_dst        = (uint8_t*)(bdata + 1);
+    offset         = (uint8_t*)bdata - context->bjson_start;
+
+    memcpy(str_dst, str_src, str_len);
+    str_dst[str_len] = 0;
+
+    // padding may grow storage, entry is found again by offset
+    if (!parsectx_align4_output(context)) return 0;
+    intern_string(context, (mjson_entry_t*)(context->bjson_start + offset));
+
+    return 1;
+}
+
+static int emit_string(mjson_parser_t *context, uint32_t id)
+{
+    int result;
+    STATS_START(context);
+
+    result = emit_string_token(context, id);
+
+    STATS_ADD(context, escaped_strings, context->token == TOK_STRING);
+    STATS_ADD(context, plain_strings,   context->token != TOK_STRING);
+    STATS_TICKS(context, string_ticks);
+
+    return result;
+}
+
+static int emit_string_token(mjson_parser_t *context, uint32_t id)
+{
+    mjson_entry_t* bdata;
+    uint8_t*       str_dst;
+    uint8_t*       str_end;
+    const uint8_t* str_src;
+    ptrdiff_t      str_len;
+    ptrdiff_t      offset;
+
+    assert(
+        context->token == TOK_STRING       ||
+        context->token == TOK_NOESC_STRING ||
+        context->token == TOK_IDENTIFIER
+    );
+    
+    if (context->token != TOK_STRING)
+    {
+        str_src = context->start;
+        str_len = context->next - context->start;
+
+        if (context->token==TOK_NOESC_STRING)
+        {
+            str_src += 1;
+            str_len -= 2;
+        }
+
+        return emit_raw_string(context, id, str_src, str_len);
+    }
+
+    // decoded string is never longer than escaped one, so storage only grows
+    // here and decode_string checks the limit for fixed size storage
+    parsectx_reserve_output(context, (ptrdiff_t)sizeof(mjson_entry_t) + (context->next - context->start));
+
+    bdata = (mjson_entry_t*)parsectx_allocate_output(context, (ptrdiff_t)sizeof(mjson_entry_t));
+
+    if (!bdata) return 0;
+
+    bdata->id = id;
+    str_dst   = context->bjson;
+    str_end   = decode_string(context->start + 1, context->next - 1, str_dst, context->bjson_limit);
+
+    if (!str_end || str_end == context->bjson_limit) return 0;
+
+    *str_end = 0;
+
+    if ((size_t)(str_end - str_dst) > MJSON_MAX_SIZE32)
+        return widen_string(context, bdata, str_end - str_dst);
+
+    bdata->val_u32 = (uint32_t)(str_end - str_dst);
+    offset         = (uint8_t*)bdata - context->bjson_start;
+    parsectx_advance_output(context, str_end + 1 - str_dst);
+    if (!parsectx_align4_output(context)) return 0;
+    intern_string(context, (mjson_entry_t*)(context->bjson_start + offset));
+
+    return 1;
+}
+
+// Decoded string at entry turned out too long for 32 bit size, moves it to
+// make room for 64 bit one. Only strings over 4 GB pay for this.
+static int widen_string(mjson_parser_t *context, mjson_entry_t* entry, size_t len)
+{
+    ptrdiff_t offset = (uint8_t*)entry - context->bjson_start;
+    uint64_t  len64  = len;
+    uint8_t*  data;
+
+    if (!parsectx_reserve_output(context, (ptrdiff_t)(sizeof(uint32_t) + len + 1)))
+        return 0;
+
+    entry = (mjson_entry_t*)(context->bjson_start + offset);
+    data  = (uint8_t*)(entry + 1);
+
+    memmove(data + sizeof(uint32_t), data, len + 1);
+
+    entry->id += 1;
+    memcpy(&entry->val_u32, &len64, sizeof(len64));
+    parsectx_advance_output(context, sizeof(uint32_t) + len + 1);
+
+    return parsectx_align4_output(context);
+}
+
+static int emit_simple(mjson_parser_t *context)
+{
+    assert(
+        context->token == TOK_NULL  ||
+        context->token == TOK_FALSE ||
+        context->token == TOK_TRUE
+    );
+
+    switch (context->token)
+    {
+        case TOK_FALSE:
+            return emit_id(context, MJSON_ID_FALSE);
+        case TOK_TRUE:
+            return emit_id(context, MJSON_ID_TRUE);
+    }
+
+    return emit_id(context, MJSON_ID_NULL);
+}
+
+// Entry without value: null, false or true
+static int emit_id(mjson_parser_t *context, uint32_t bjson_id)
+{
+    uint32_t* id;
+
+    id = (uint32_t*)parsectx_allocate_output(context, sizeof(uint32_t));
+    if (!id) return 0;
+
+    *id = bjson_id;
+
+    return 1;
+}
+
+// Emits value of scalar token, returns 0 if token is not a value
+static int emit_scalar(mjson_parser_t *context)
+{
+    switch (context->token)
+    {
+        case TOK_NULL:
+        case TOK_FALSE:
+        case TOK_TRUE:
+            return emit_simple(context);
+
+        case TOK_OCT_NUMBER:
+        case TOK_HEX_NUMBER:
+        case TOK_DEC_NUMBER:
+        case TOK_FLOAT_NUMBER:
+            return emit_number(context);
+
+        case TOK_NOESC_STRING:
+        case TOK_STRING:
+            return emit_string(context, MJSON_ID_UTF8_STRING32);
+    }
+
+    return 0;
+}
+
+static int parse_value(mjson_parser_t *context)
+{
+    assert(context);
+ 
+    switch (context->token)
+    {
+        case TOK_LEFT_CURLY_BRACKET:
+            parsectx_next_token(context);
+            return parse_key_value_pair(context, TOK_RIGHT_CURLY_BRACKET);
+
+        case TOK_LEFT_BRACKET:
+            parsectx_next_token(context);
+            return parse_value_list(context);
+    }
+
+    if (!emit_scalar(context))
+        return 0;
+
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+static int parse_document(mjson_parser_t *context, mjson_element_t* top_element)
+{
+    uint32_t* fourcc;
+    int       stop_token = TOK_NONE;
+
+    *top_element = 0;
+
+    fourcc = (uint32_t*)parsectx_allocate_output(context, (ptrdiff_t)sizeof(uint32_t));
+
+    if (!fourcc) return 0;
+
+    *fourcc = MJSON_FOURCC;
+
+    parsectx_next_token(context);
+
+    if (context->token == TOK_LEFT_BRACKET)
+    {
+        parsectx_next_token(context);
+        if (!parse_value_list(context))
+            return 0;
+    }
+    else
+    {
+        if (context->token == TOK_LEFT_CURLY_BRACKET)
+        {
+            stop_token = TOK_RIGHT_CURLY_BRACKET;
+            parsectx_next_token(context);
+        }
+
+        if (!parse_key_value_pair(context, stop_token))
+            return 0;
+    }
+
+    if (context->token != TOK_NONE)
+        return 0;
+
+    *top_element = (mjson_entry_t*)(context->bjson_start + sizeof(uint32_t));
+
+    return 1;
+}
+
+static int parse_document_with_flags(mjson_parser_t *context, mjson_element_t* top_element)
+{
+    mjson_index_t  index;
+    mjson_intern_t intern;
+
+    if (context->flags & MJSON_PARSE_INDEXED)
+    {
+        index_init(&index, context->next);
+        context->index = &index;
+    }
+
+    if (context->flags & (MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS))
+    {
+        memset(&intern, 0, sizeof(intern));
+        context->intern = &intern;
+    }
+
+    return parse_document(context, top_element);
+}
+
+// Appends table of element offsets relative to the array entry
+static int emit_array_table(mjson_parser_t* context, mjson_entry_t* array)
+{
+    mjson_entry_t*  table;
+    mjson_element_t element;
+    mjson_element_t end = (mjson_element_t)context->bjson;
+    ptrdiff_t       offset = (uint8_t*)array - context->bjson_start;
+    uint32_t*       offsets;
+    uint32_t        count = 0;
+
+    for (element = array + 1; element < end; element = next_element(element))
+        ++count;
+
+    table = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t) + count * sizeof(uint32_t));
+
+    if (!table) return 0;
+
+    array = (mjson_entry_t*)(context->bjson_start + offset);
+    end   = table;
+
+    table->id      = MJSON_ID_BINARY32;
+    table->val_u32 = count * sizeof(uint32_t);
+    offsets        = (uint32_t*)(table + 1);
+
+    for (element = array + 1; element < end; element = next_element(element))
+        *offsets++ = (uint32_t)((const uint8_t*)element - (const uint8_t*)array);
+
+    array->id |= MJSON_FLAG_TABLE;
+
+    return 1;
+}
+
+static int parse_value_list(mjson_parser_t *context)
+{
+    mjson_entry_t* array;
+    ptrdiff_t      offset;
+    int            expect_separator;
+
+    assert(context);
+
+    array = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t));
+
+    if (!array) return 0;
+    
+    STATS_ENTER(context);
+
+    array->id = MJSON_ID_ARRAY32;
+    offset    = (uint8_t*)array - context->bjson_start;
+
+    expect_separator = FALSE;
+
+    while (context->token != TOK_RIGHT_BRACKET)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        if (!parse_value(context))
+            return 0;
+    }
+
+    if (!close_container(context, offset, FALSE))
+        return 0;
+
+    STATS_LEAVE(context);
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+// Appends hash table of dictionary keys, capacity is power of two at least
+// twice the number of members, so probing always finds an empty slot.
+static int emit_dict_table(mjson_parser_t* context, mjson_entry_t* dictionary)
+{
+    mjson_entry_t*  table;
+    mjson_element_t key;
+    mjson_element_t end = (mjson_element_t)context->bjson;
+    ptrdiff_t       offset = (uint8_t*)dictionary - context->bjson_start;
+    uint32_t*       slots;
+    uint32_t        count = 0, capacity = 2, hash, i;
+
+    for (key = dictionary + 1; key < end; key = next_element(next_element(key)))
+        ++count;
+
+    while (capacity < count * 2)
+        capacity *= 2;
+
+    // offsets fit, as container is under 4 GB, but table itself may not
+    if ((uint64_t)capacity * 2 * sizeof(uint32_t) > MJSON_MAX_SIZE32)
+        return 1;
+
+    table = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t) + capacity * 2 * sizeof(uint32_t));
+
+    if (!table) return 0;
+
+    dictionary = (mjson_entry_t*)(context->bjson_start + offset);
+    end        = table;
+
+    table->id      = MJSON_ID_BINARY32;
+    table->val_u32 = capacity * 2 * sizeof(uint32_t);
+    slots          = (uint32_t*)(table + 1);
+    memset(slots, 0, table->val_u32);
+
+    for (key = dictionary + 1; key < end; key = next_element(next_element(key)))
+    {
+        hash = hash_key((const uint8_t*)(string_target(key) + 1), string_target(key)->val_u32);
+        for (i = hash & (capacity - 1); slots[2*i+1] != 0; i = (i + 1) & (capacity - 1))
+            ;
+        slots[2*i]   = hash;
+        slots[2*i+1] = (uint32_t)((const uint8_t*)key - (const uint8_t*)dictionary);
+    }
+
+    dictionary->id |= MJSON_FLAG_TABLE;
+
+    return 1;
+}
+
+// Back-patches size of container at offset once its elements are emitted
+// and appends lookup table requested by flags. Container over 4 GB gets
+// 64 bit size and no table.
+static int close_container(mjson_parser_t* context, ptrdiff_t offset, int is_dict)
+{
+    mjson_entry_t* container = (mjson_entry_t*)(context->bjson_start + offset);
+    size_t         size      = context->bjson - (uint8_t*)(container + 1);
+    int            result    = 1;
+    STATS_START(context);
+
+    assert((size & 3) == 0);
+
+    if (size > MJSON_MAX_SIZE32)
+    {
+        result = widen_container(context, offset, size);
+    }
+    else
+    {
+        container->val_u32 = (uint32_t)size;
+
+        if (size > 0 && is_dict && (context->flags & MJSON_PARSE_HASH_DICTS))
+            result = emit_dict_table(context, container);
+        else if (size > 0 && !is_dict && (context->flags & MJSON_PARSE_INDEX_ARRAYS))
+            result = emit_array_table(context, container);
+    }
+
+    STATS_TICKS(context, container_ticks);
+
+    return result;
+}
+
+// Moves container data by 4 bytes to make room for 64 bit size. Backward
+// references from moved strings to ones before the container and intern
+// cache entries are adjusted, everything else in blob is relative to
+// entries which moved together.
+static int widen_container(mjson_parser_t* context, ptrdiff_t offset, size_t size)
+{
+    mjson_entry_t* container;
+    mjson_entry_t* entry;
+    uint8_t*       data;
+    uint8_t*       end;
+    uint64_t       size64 = size;
+    size_t         moved, i;
+
+    if (!parsectx_allocate_output(context, sizeof(uint32_t)))
+        return 0;
+
+    container = (mjson_entry_t*)(context->bjson_start + offset);
+    data      = (uint8_t*)container + sizeof(uint32_t) + sizeof(uint64_t);
+    end       = data + size;
+
+    memmove(data, container + 1, size);
+
+    container->id += 1;
+    memcpy(&container->val_u32, &size64, sizeof(size64));
+
+    // linear walk over entries, entering nested containers
+    while (data < end)
+    {
+        entry = (mjson_entry_t*)data;
+
+        switch (mjson_get_type(entry))
+        {
+            case MJSON_ID_ARRAY32:
+            case MJSON_ID_ARRAY64:
+            case MJSON_ID_DICT32:
+            case MJSON_ID_DICT64:
+                data = (uint8_t*)entry_data(entry);
+                break;
+
+            default:
+                if ((entry->id & MJSON_FLAG_REF) && data - entry->val_u32 < (uint8_t*)container + sizeof(uint32_t) + sizeof(uint64_t))
+                    entry->val_u32 += sizeof(uint32_t);
+                data += element_size(entry);
+                break;
+        }
+    }
+
+    if (context->intern)
+    {
+        moved = offset + sizeof(mjson_entry_t);
+        for (i = 0; i < INTERN_CACHE_SIZE; ++i)
+        {
+            if (context->intern->offsets[i] >= moved)
+                context->intern->offsets[i] += sizeof(uint32_t);
+        }
+    }
+
+    return 1;
+}
+
+static int parse_key_value_pair(mjson_parser_t* context, int stop_token)
+{
+    mjson_entry_t* dictionary;
+    ptrdiff_t      offset;
+    int            expect_separator;
+ 
+    assert(context);
+
+    dictionary = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t));
+    
+    if (!dictionary) return 0;
+    
+    STATS_ENTER(context);
+
+    dictionary->id = MJSON_ID_DICT32;
+    offset         = (uint8_t*)dictionary - context->bjson_start;
+    
+    expect_separator = FALSE;
+    while (context->token != stop_token)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        switch (context->token)
+        {
+            case TOK_IDENTIFIER:
+            case TOK_NOESC_STRING:
+                if (!emit_string(context, MJSON_ID_UTF8_KEY32))
+                    return 0;
+                parsectx_next_token(context);
+                break;        
+            default:
+                return 0;
+        }
+
+        if (context->token != TOK_COLON && context->token != TOK_EQUAL)
+            return 0;
+
+        parsectx_next_token(context);
+
+        if (!parse_value(context))
+            return 0;
+    }
+
+    if (!close_container(context, offset, TRUE))
+        return 0;
+    
+    STATS_LEAVE(context);
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Parse statistics
+/////////////////////////////////////////////////////////////////////////////
+
+#if defined(MJSON_STATS)
+static const signed char stats_token_kind[TOK_COUNT] = {
+    -1,                         // TOK_NONE
+    MJSON_STATS_IDENTIFIER,     // TOK_IDENTIFIER
+    MJSON_STATS_STRING,         // TOK_NOESC_STRING
+    MJSON_STATS_STRING,         // TOK_STRING
+    MJSON_STATS_INTEGER,        // TOK_OCT_NUMBER
+    MJSON_STATS_INTEGER,        // TOK_HEX_NUMBER
+    MJSON_STATS_INTEGER,        // TOK_DEC_NUMBER
+    MJSON_STATS_FLOAT,          // TOK_FLOAT_NUMBER
+    MJSON_STATS_SEPARATOR,      // TOK_COMMA
+    MJSON_STATS_SEPARATOR,      // TOK_COLON
+    MJSON_STATS_SEPARATOR,      // TOK_EQUAL
+    MJSON_STATS_OPEN,           // TOK_LEFT_BRACKET
+    MJSON_STATS_CLOSE,          // TOK_RIGHT_BRACKET
+    MJSON_STATS_OPEN,           // TOK_LEFT_CURLY_BRACKET
+    MJSON_STATS_CLOSE,          // TOK_RIGHT_CURLY_BRACKET
+    MJSON_STATS_LITERAL,        // TOK_FALSE
+    MJSON_STATS_LITERAL,        // TOK_TRUE
+    MJSON_STATS_LITERAL,        // TOK_NULL
+    -1,                         // TOK_WHITESPACE
+    -1                          // TOK_INVALID
+};
+
+static uint64_t stats_clock(void)
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    return __builtin_ia32_rdtsc();
+#elif defined(__GNUC__) && defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64_t)clock();
+#endif
+}
+
+// Lexes next token and counts it together with whitespace and comments
+// skipped before it
+static void stats_next_token(mjson_parser_t* context)
+{
+    mjson_parse_stats_t* stats = context->stats;
+    uint8_t*             prev  = context->next;
+    uint64_t             start = stats_clock();
+
+    parsectx_lex_token(context);
+
+    stats->lex_ticks += stats_clock() - start;
+
+    if (context->token == TOK_NONE && prev)
+        stats->skipped_bytes += context->end - prev;
+
+    if (stats_token_kind[context->token] >= 0)
+    {
+        stats->skipped_bytes += context->start - prev;
+        stats->tokens[stats_token_kind[context->token]]++;
+    }
+}
+
+// Blob is flat, so stepping over container headers only visits every entry
+// including lookup tables which follow container data
+static void stats_count_output(mjson_parse_stats_t* stats, const uint8_t* blob, const uint8_t* end)
+{
+    mjson_element_t element;
+    size_t          size;
+
+    while (blob < end)
+    {
+        element = (mjson_element_t)blob;
+
+        if (is_array(element) || is_dict(element))
+            size = entry_data(element) - blob;
+        else
+            size = element_size(element);
+
+        stats->output_bytes[mjson_get_type(element)] += size;
+        blob += size;
+    }
+}
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Size pass: same grammar as parse_* functions, but only sums entry sizes
+/////////////////////////////////////////////////////////////////////////////
+
+static size_t string_entry_size(mjson_parser_t *context)
+{
+    size_t len;
+
+    switch (context->token)
+    {
+        case TOK_STRING:
+            len = decoded_string_length(context->start + 1, context->next - 1);
+            break;
+        case TOK_NOESC_STRING:
+            len = context->next - context->start - 2;
+            break;
+        default:
+            len = context->next - context->start;
+            break;
+    }
+
+    if (len > MJSON_MAX_SIZE32)
+        return sizeof(uint32_t) + sizeof(uint64_t) + ((len + 1 + 3) & (~(size_t)3));
+
+    return sizeof(mjson_entry_t) + ((len + 1 + 3) & (~3));
+}
+
+// Container data which started at size start is complete, adds 64 bit size
+// or lookup table the same way close_container does. With interning data
+// may end up under 4 GB, so upper bound includes both.
+static void measure_container_end(mjson_parser_t *context, size_t start, int is_dict, uint32_t count, size_t* size)
+{
+    uint64_t capacity = 2;
+
+    if (*size - start > MJSON_MAX_SIZE32)
+    {
+        *size += sizeof(uint32_t);
+        if (!(context->flags & (MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS)))
+            return;
+    }
+
+    if (count == 0)
+        return;
+
+    if (!is_dict && (context->flags & MJSON_PARSE_INDEX_ARRAYS))
+        *size += sizeof(mjson_entry_t) + count * sizeof(uint32_t);
+
+    if (is_dict && (context->flags & MJSON_PARSE_HASH_DICTS))
+    {
+        while (capacity < count * 2)
+            capacity *= 2;
+        if (capacity * 2 * sizeof(uint32_t) <= MJSON_MAX_SIZE32)
+            *size += sizeof(mjson_entry_t) + capacity * 2 * sizeof(uint32_t);
+    }
+}
+
+static int measure_value_list    (mjson_parser_t *context, size_t* size);
+static int measure_key_value_pair(mjson_parser_t *context, int stop_token, size_t* size);
+
+static int measure_value(mjson_parser_t *context, size_t* size)
+{
+    uint32_t bjson_id;
+    uint64_t payload;
+
+    switch (context->token)
+    {
+        case TOK_NULL:
+        case TOK_FALSE:
+        case TOK_TRUE:
+            *size += sizeof(uint32_t);
+            break;
+
+        case TOK_OCT_NUMBER:
+        case TOK_HEX_NUMBER:
+        case TOK_DEC_NUMBER:
+        case TOK_FLOAT_NUMBER:
+            if (!decode_number(context, &bjson_id, &payload))
+                return 0;
+            *size += number_entry_size(bjson_id);
+            break;
+
+        case TOK_NOESC_STRING:
+        case TOK_STRING:
+            *size += string_entry_size(context);
+            break;
+
+        case TOK_LEFT_CURLY_BRACKET:
+            parsectx_next_token(context);
+            return measure_key_value_pair(context, TOK_RIGHT_CURLY_BRACKET, size);
+
+        case TOK_LEFT_BRACKET:
+            parsectx_next_token(context);
+            return measure_value_list(context, size);
+
+        default:
+            return 0;
+    }
+
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+static int measure_value_list(mjson_parser_t *context, size_t* size)
+{
+    int      expect_separator = FALSE;
+    uint32_t count            = 0;
+    size_t   start;
+
+    *size += sizeof(mjson_entry_t);
+    start  = *size;
+
+    while (context->token != TOK_RIGHT_BRACKET)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        if (!measure_value(context, size))
+            return 0;
+
+        ++count;
+    }
+
+    measure_container_end(context, start, FALSE, count, size);
+
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+static int measure_key_value_pair(mjson_parser_t *context, int stop_token, size_t* size)
+{
+    int      expect_separator = FALSE;
+    uint32_t count            = 0;
+    size_t   start;
+
+    *size += sizeof(mjson_entry_t);
+    start  = *size;
+
+    while (context->token != stop_token)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        if (context->token != TOK_IDENTIFIER && context->token != TOK_NOESC_STRING)
+            return 0;
+
+        *size += string_entry_size(context);
+        parsectx_next_token(context);
+
+        if (context->token != TOK_COLON && context->token != TOK_EQUAL)
+            return 0;
+
+        parsectx_next_token(context);
+
+        if (!measure_value(context, size))
+            return 0;
+
+        ++count;
+    }
+
+    measure_container_end(context, start, TRUE, count, size);
+
+    parsectx_next_token(context);
+
+    return 1;
+}
+
+static int measure_document(mjson_parser_t *context, size_t* size)
+{
+    int stop_token = TOK_NONE;
+
+    parsectx_next_token(context);
+
+    if (context->token == TOK_LEFT_BRACKET)
+    {
+        parsectx_next_token(context);
+        if (!measure_value_list(context, size))
+            return 0;
+    }
+    else
+    {
+        if (context->token == TOK_LEFT_CURLY_BRACKET)
+        {
+            stop_token = TOK_RIGHT_CURLY_BRACKET;
+            parsectx_next_token(context);
+        }
+
+        if (!measure_key_value_pair(context, stop_token, size))
+            return 0;
+    }
+
+    return context->token == TOK_NONE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Binding: same grammar as parse_* functions, values go into caller struct
+/////////////////////////////////////////////////////////////////////////////
+
+static int bind_value(mjson_parser_t* context, const mjson_bind_field_t* field, int type, uint8_t* base, uint8_t* dst);
+
+// Field for key token, NULL if member is not bound
+static const mjson_bind_field_t* bind_find_field(const mjson_schema_t* schema, const mjson_parser_t* context)
+{
+    const uint8_t* key = context->start;
+    size_t         len = context->next - context->start;
+    size_t         i;
+
+    if (context->token == TOK_NOESC_STRING)
+    {
+        key += 1;
+        len -= 2;
+    }
+
+    for (i = 0; i < schema->field_count; ++i)
+    {
+        const char* name = schema->fields[i].key;
+
+        if (strncmp(name, (const char*)key, len) == 0 && name[len] == 0)
+            return &schema->fields[i];
+    }
+
+    return NULL;
+}
+
+static int bind_integer(const mjson_parser_t* context, int type, uint8_t* dst)
+{
+    uint64_t magnitude;
+    int      negative;
+
+    RETURN_VAL_IF_FAIL(context->token != TOK_FLOAT_NUMBER, FALSE);
+    RETURN_VAL_IF_FAIL(decode_integer(context->token, context->start, context->next, &magnitude, &negative), FALSE);
+
+    // "-0" fits everywhere
+    if (magnitude == 0)
+        negative = FALSE;
+
+    switch (type)
+    {
+        case MJSON_BIND_INT32:
+            RETURN_VAL_IF_FAIL(magnitude <= (negative ? 0x80000000u : 0x7FFFFFFFu), FALSE);
+            *(int32_t*)dst = negative ? (int32_t)(0 - (uint32_t)magnitude) : (int32_t)magnitude;
+            return TRUE;
+
+        case MJSON_BIND_INT64:
+            RETURN_VAL_IF_FAIL(magnitude <= (negative ? 0x8000000000000000ull : 0x7FFFFFFFFFFFFFFFull), FALSE);
+            *(int64_t*)dst = negative ? (int64_t)(0 - magnitude) : (int64_t)magnitude;
+            return TRUE;
+
+        case MJSON_BIND_UINT32:
+            RETURN_VAL_IF_FAIL(!negative && magnitude <= 0xFFFFFFFFu, FALSE);
+            *(uint32_t*)dst = (uint32_t)magnitude;
+            return TRUE;
+
+        case MJSON_BIND_UINT64:
+            RETURN_VAL_IF_FAIL(!negative, FALSE);
+            *(uint64_t*)dst = magnitude;
+            return TRUE;
+    }
+
+    return FALSE;
+}
+
+static int bind_float(mjson_parser_t* context, int type, uint8_t* dst)
+{
+    uint32_t id;
+    uint64_t bits;
+    float    f;
+    double   value;
+
+    RETURN_VAL_IF_FAIL(decode_number(context, &id, &bits), FALSE);
+
+    switch (id)
+    {
+        case MJSON_ID_SINT32:
+            value = (int32_t)(uint32_t)bits;
+            break;
+        case MJSON_ID_SINT64:
+            value = (double)(int64_t)bits;
+            break;
+        case MJSON_ID_UINT64:
+            value = (double)bits;
+            break;
+        case MJSON_ID_FLOAT32:
+            id = (uint32_t)bits;
+            memcpy(&f, &id, sizeof(f));
+            value = f;
+            break;
+        default:
+            value = bits_to_double(bits);
+            break;
+    }
+
+    if (type == MJSON_BIND_FLOAT)
+        *(float*)dst = (float)value;
+    else
+        *(double*)dst = value;
+
+    return TRUE;
+}
+
+static int bind_string(const mjson_parser_t* context, size_t size, uint8_t* dst)
+{
+    uint8_t* end;
+    size_t   len;
+
+    RETURN_VAL_IF_FAIL(size > 0, FALSE);
+
+    if (context->token == TOK_NOESC_STRING)
+    {
+        len = context->next - context->start - 2;
+        RETURN_VAL_IF_FAIL(len < size, FALSE);
+
+        memcpy(dst, context->start + 1, len);
+        dst[len] = 0;
+
+        return TRUE;
+    }
+
+    end = decode_string(context->start + 1, context->next - 1, dst, dst + size);
+    RETURN_VAL_IF_FAIL(end && end < dst + size, FALSE);
+
+    *end = 0;
+
+    return TRUE;
+}
+
+static int bind_array(mjson_parser_t* context, const mjson_bind_field_t* field, uint8_t* base, uint8_t* dst)
+{
+    int    expect_separator = FALSE;
+    size_t count            = 0;
+
+    RETURN_VAL_IF_FAIL(field->element_type != MJSON_BIND_ARRAY, FALSE);
+
+    while (context->token != TOK_RIGHT_BRACKET)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        RETURN_VAL_IF_FAIL(count < field->capacity, FALSE);
+
+        if (!bind_value(context, field, field->element_type, base, dst + count * field->size))
+            return FALSE;
+
+        ++count;
+    }
+
+    *(size_t*)(base + field->count_offset) = count;
+
+    parsectx_next_token(context);
+
+    return TRUE;
+}
+
+// Consumes value of field, base is struct which holds dst
+static int bind_value(mjson_parser_t* context, const mjson_bind_field_t* field, int type, uint8_t* base, uint8_t* dst)
+{
+    if (context->token == TOK_NULL)
+    {
+        parsectx_next_token(context);
+        return TRUE;
+    }
+
+    switch (type)
+    {
+        case MJSON_BIND_INT32:
+        case MJSON_BIND_INT64:
+        case MJSON_BIND_UINT32:
+        case MJSON_BIND_UINT64:
+            RETURN_VAL_IF_FAIL(context->token >= TOK_OCT_NUMBER && context->token <= TOK_FLOAT_NUMBER, FALSE);
+            RETURN_VAL_IF_FAIL(bind_integer(context, type, dst), FALSE);
+            break;
+
+        case MJSON_BIND_FLOAT:
+        case MJSON_BIND_DOUBLE:
+            RETURN_VAL_IF_FAIL(context->token >= TOK_OCT_NUMBER && context->token <= TOK_FLOAT_NUMBER, FALSE);
+            RETURN_VAL_IF_FAIL(bind_float(context, type, dst), FALSE);
+            break;
+
+        case MJSON_BIND_BOOL:
+            RETURN_VAL_IF_FAIL(context->token == TOK_TRUE || context->token == TOK_FALSE, FALSE);
+            *(int*)dst = context->token == TOK_TRUE;
+            break;
+
+        case MJSON_BIND_STRING:
+            RETURN_VAL_IF_FAIL(context->token == TOK_STRING || context->token == TOK_NOESC_STRING, FALSE);
+            RETURN_VAL_IF_FAIL(bind_string(context, field->size, dst), FALSE);
+            break;
+
+        case MJSON_BIND_OBJECT:
+            RETURN_VAL_IF_FAIL(context->token == TOK_LEFT_CURLY_BRACKET && field->schema, FALSE);
+            parsectx_next_token(context);
+            return bind_object(context, field->schema, dst, TOK_RIGHT_CURLY_BRACKET);
+
+        case MJSON_BIND_ARRAY:
+            RETURN_VAL_IF_FAIL(context->token == TOK_LEFT_BRACKET, FALSE);
+            parsectx_next_token(context);
+            return bind_array(context, field, base, dst);
+
+        default:
+            return FALSE;
+    }
+
+    parsectx_next_token(context);
+
+    return TRUE;
+}
+
+static int bind_object(mjson_parser_t* context, const mjson_schema_t* schema, uint8_t* out, int stop_token)
+{
+    const mjson_bind_field_t* field;
+    int                       expect_separator = FALSE;
+    size_t                    skipped          = 0;
+
+    while (context->token != stop_token)
+    {
+        if (expect_separator && context->token == TOK_COMMA)
+            parsectx_next_token(context);
+        else
+            expect_separator = TRUE;
+
+        if (context->token != TOK_IDENTIFIER && context->token != TOK_NOESC_STRING)
+            return FALSE;
+
+        field = bind_find_field(schema, context);
+        parsectx_next_token(context);
+
+        if (context->token != TOK_COLON && context->token != TOK_EQUAL)
+            return FALSE;
+
+        parsectx_next_token(context);
+
+        // unknown members are checked by the size pass, which writes nothing
+        if (!field && !measure_value(context, &skipped))
+            return FALSE;
+
+        if (field && !bind_value(context, field, field->type, out, out + field->offset))
+            return FALSE;
+    }
+
+    parsectx_next_token(context);
+
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Streaming parser
+/////////////////////////////////////////////////////////////////////////////
+
+// Sets up zeroed stream and writes fourcc, storage is growable if allocator
+// is given. Fails only if intern cache can not be allocated.
+static int stream_init(mjson_stream_t* stream, uint8_t* storage, size_t storage_size, unsigned flags, const mjson_allocator_t* allocator)
+{
+    uint32_t* fourcc;
+
+    stream->context.token       = TOK_NONE;
+    stream->context.bjson       = storage;
+    stream->context.bjson_limit = storage + storage_size;
+    stream->context.bjson_start = storage;
+    stream->context.flags       = flags & ~MJSON_PARSE_INDEXED;
+    stream->context.allocator   = allocator;
+
+    if (flags & (MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS))
+    {
+        stream->intern = (mjson_intern_t*)calloc(1, sizeof(mjson_intern_t));
+        RETURN_VAL_IF_FAIL(stream->intern, FALSE);
+        stream->context.intern = stream->intern;
+    }
+
+    fourcc = (uint32_t*)parsectx_allocate_output(&stream->context, (ptrdiff_t)sizeof(uint32_t));
+    if (fourcc)
+        *fourcc = MJSON_FOURCC;
+    else
+        stream->failed = TRUE;
+
+    return TRUE;
+}
+
+// Frees everything except stream itself and storage
+static void stream_release(mjson_stream_t* stream)
+{
+    free(stream->carry);
+    free(stream->stack);
+    free(stream->intern);
+}
+
+static int stream_append_carry(mjson_stream_t* stream, const uint8_t* data, size_t size)
+{
+    uint8_t* carry;
+    size_t   capacity;
+
+    if (size == 0)
+        return TRUE;
+
+    if (stream->carry_size + size > stream->carry_capacity)
+    {
+        capacity = stream->carry_capacity ? stream->carry_capacity : 256;
+        while (capacity < stream->carry_size + size)
+            capacity *= 2;
+
+        carry = (uint8_t*)realloc(stream->carry, capacity);
+        if (!carry)
+        {
+            stream->failed = TRUE;
+            return FALSE;
+        }
+
+        stream->carry          = carry;
+        stream->carry_capacity = capacity;
+    }
+
+    memcpy(stream->carry + stream->carry_size, data, size);
+    stream->carry_size += size;
+
+    return TRUE;
+}
+
+static int stream_open_container(mjson_stream_t* stream, int is_dict, int stop_token)
+{
+    mjson_parser_t* context = &stream->context;
+    mjson_entry_t*  container;
+    mjson_frame_t*  stack;
+    mjson_frame_t*  frame;
+
+    if (stream->depth == stream->stack_capacity)
+    {
+        stack = (mjson_frame_t*)realloc(stream->stack, sizeof(mjson_frame_t) * (stream->stack_capacity ? stream->stack_capacity * 2 : 16));
+        if (!stack) return 0;
+
+        stream->stack          = stack;
+        stream->stack_capacity = stream->stack_capacity ? stream->stack_capacity * 2 : 16;
+    }
+
+    container = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t));
+
+    if (!container) return 0;
+
+    container->id = is_dict ? MJSON_ID_DICT32 : MJSON_ID_ARRAY32;
+
+    frame = &stream->stack[stream->depth++];
+    frame->offset     = (uint8_t*)container - context->bjson_start;
+    frame->is_dict    = is_dict;
+    frame->stop_token = stop_token;
+    frame->state      = FRAME_FIRST;
+
+    return 1;
+}
+
+static int stream_close_container(mjson_stream_t* stream)
+{
+    mjson_frame_t*  frame = &stream->stack[--stream->depth];
+
+    if (!close_container(&stream->context, frame->offset, frame->is_dict))
+        return 0;
+
+    if (stream->depth == 0)
+        stream->done = TRUE;
+
+    return 1;
+}
+
+// Value inside array or dictionary, containers are only opened here
+static int stream_value(mjson_stream_t* stream)
+{
+    switch (stream->context.token)
+    {
+        case TOK_LEFT_CURLY_BRACKET:
+            return stream_open_container(stream, TRUE, TOK_RIGHT_CURLY_BRACKET);
+
+        case TOK_LEFT_BRACKET:
+            return stream_open_container(stream, FALSE, TOK_RIGHT_BRACKET);
+    }
+
+    return emit_scalar(&stream->context);
+}
+
+// Consumes current token, same grammar as parse_document, parse_value_list
+// and parse_key_value_pair but with explicit stack of open containers.
+static int stream_token(mjson_stream_t* stream)
+{
+    mjson_parser_t* context = &stream->context;
+    mjson_frame_t*  frame;
+    int             token   = context->token;
+
+    if (stream->done)
+        return token == TOK_NONE;
+
+    if (stream->depth == 0)
+    {
+        if (token == TOK_LEFT_BRACKET)
+            return stream_open_container(stream, FALSE, TOK_RIGHT_BRACKET);
+
+        if (token == TOK_LEFT_CURLY_BRACKET)
+            return stream_open_container(stream, TRUE, TOK_RIGHT_CURLY_BRACKET);
+
+        // dictionary without braces, token belongs to it
+        if (!stream_open_container(stream, TRUE, TOK_NONE))
+            return 0;
+    }
+
+    frame = &stream->stack[stream->depth - 1];
+
+    switch (frame->state)
+    {
+        case FRAME_FIRST:
+        case FRAME_NEXT:
+            if (token == frame->stop_token)
+                return stream_close_container(stream);
+
+            if (frame->state == FRAME_NEXT && token == TOK_COMMA)
+            {
+                frame->state = FRAME_AFTER_COMMA;
+                return 1;
             }
-yy104:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 'Z') {
-                if (yych <= '/') goto yy74;
-                if (yych <= '9') goto yy106;
-                if (yych <= '@') goto yy74;
-                goto yy106;
-            } else {
-                if (yych <= '_') {
-                    if (yych <= '^') goto yy74;
-                    goto yy106;
-                } else {
-                    if (yych <= '`') goto yy74;
-                    if (yych <= 'z') goto yy106;
-                    goto yy74;
-                }
+            // fall through
+        case FRAME_AFTER_COMMA:
+            if (!frame->is_dict)
+            {
+                frame->state = FRAME_NEXT;
+                return stream_value(stream);
             }
-yy105:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-yy106:
-            if (yych <= 'Z') {
-                if (yych <= '9') {
-                    if (yych >= '0') goto yy105;
-                } else {
-                    if (yych <= '@') goto yy107;
-                    if (yych <= 'F') goto yy105;
-                    goto yy72;
-                }
-            } else {
-                if (yych <= '`') {
-                    if (yych == '_') goto yy72;
-                } else {
-                    if (yych <= 'f') goto yy105;
-                    if (yych <= 'z') goto yy72;
-                }
+
+            if (token != TOK_IDENTIFIER && token != TOK_NOESC_STRING)
+                return 0;
+
+            frame->state = FRAME_COLON;
+            return emit_string(context, MJSON_ID_UTF8_KEY32);
+
+        case FRAME_COLON:
+            if (token != TOK_COLON && token != TOK_EQUAL)
+                return 0;
+
+            frame->state = FRAME_VALUE;
+            return 1;
+
+        case FRAME_VALUE:
+            frame->state = FRAME_NEXT;
+            return stream_value(stream);
+    }
+
+    return 0;
+}
+
+// Lexes and consumes tokens in [c, e). Returns position where incomplete
+// token starts, which has to be retried with more input, or NULL on error.
+static uint8_t* stream_lex(mjson_stream_t* stream, uint8_t* c, uint8_t* e, int partial)
+{
+    mjson_parser_t* context = &stream->context;
+    uint8_t*        start;
+
+    context->next    = c;
+    context->end     = e;
+    context->partial = partial;
+
+    while (!stream->finished)
+    {
+        start = context->next;
+
+        parsectx_next_token(context);
+
+        if (partial && context->hit_end)
+            return start;
+
+        if (!stream_token(stream))
+        {
+            stream->failed = TRUE;
+            return NULL;
+        }
+
+        if (context->token == TOK_NONE)
+            stream->finished = TRUE;
+    }
+
+    return e;
+}
+
+// File loading: mapped read-only where mmap is available, otherwise read
+// into malloc'ed block. Empty file maps to static empty buffer.
+static const uint8_t empty_file[4];
+
+#if defined(MJSON_MMAP)
+
+static const uint8_t* file_map(const char* path, size_t* size, int sequential)
+{
+    struct stat st;
+    void*       data;
+    int         fd;
+
+    fd = open(path, O_RDONLY);
+    RETURN_VAL_IF_FAIL(fd >= 0, NULL);
+
+    if (fstat(fd, &st) != 0 || st.st_size < 0)
+    {
+        close(fd);
+        return NULL;
+    }
+
+    *size = (size_t)st.st_size;
+
+    if (*size == 0)
+    {
+        close(fd);
+        return empty_file;
+    }
+
+    data = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    RETURN_VAL_IF_FAIL(data != MAP_FAILED, NULL);
+
+#if defined(POSIX_MADV_SEQUENTIAL)
+    if (sequential)
+        posix_madvise(data, *size, POSIX_MADV_SEQUENTIAL);
+#elif defined(MADV_SEQUENTIAL)
+    if (sequential)
+        madvise(data, *size, MADV_SEQUENTIAL);
+#endif
+
+    return (const uint8_t*)data;
+}
+
+static void file_unmap(const uint8_t* data, size_t size)
+{
+    if (data != empty_file)
+        munmap((void*)data, size);
+}
+
+#else
+
+static const uint8_t* file_map(const char* path, size_t* size, int sequential)
+{
+    FILE*    file;
+    uint8_t* data = NULL;
+    long     length;
+
+    file = fopen(path, "rb");
+    RETURN_VAL_IF_FAIL(file, NULL);
+
+    if (fseek(file, 0, SEEK_END) == 0 && (length = ftell(file)) >= 0 && fseek(file, 0, SEEK_SET) == 0)
+    {
+        *size = (size_t)length;
+        data  = *size ? (uint8_t*)malloc(*size) : (uint8_t*)empty_file;
+
+        if (data && *size && fread(data, 1, *size, file) != *size)
+        {
+            free(data);
+            data = NULL;
+        }
+    }
+
+    fclose(file);
+
+    return data;
+}
+
+static void file_unmap(const uint8_t* data, size_t size)
+{
+    if (data != empty_file)
+        free((void*)data);
+}
+
+#endif
+
+// Blob validation: check_entry verifies entry fits into limit and returns
+// size of entry itself (only header for containers) or 0 if it is broken.
+static size_t check_entry(mjson_element_t element, const uint8_t* blob, const uint8_t* limit)
+{
+    const uint8_t*  data = (const uint8_t*)element;
+    mjson_element_t target, table;
+    size_t          room = limit - data;
+    uint32_t        flags, offset, length, capacity;
+    uint64_t        length64;
+
+    RETURN_VAL_IF_FAIL(room >= sizeof(uint32_t), 0);
+
+    flags = element->id & ~MJSON_ID_MASK;
+
+    RETURN_VAL_IF_FAIL((flags & ~(MJSON_FLAG_TABLE | MJSON_FLAG_REF)) == 0, 0);
+
+    switch (mjson_get_type(element))
+    {
+        case MJSON_ID_NULL:
+        case MJSON_ID_FALSE:
+        case MJSON_ID_EMPTY_STRING:
+        case MJSON_ID_TRUE:
+            RETURN_VAL_IF_FAIL(flags == 0, 0);
+            return sizeof(uint32_t);
+
+        case MJSON_ID_UINT32:
+        case MJSON_ID_SINT32:
+        case MJSON_ID_FLOAT32:
+            RETURN_VAL_IF_FAIL(flags == 0 && room >= sizeof(mjson_entry_t), 0);
+            return sizeof(mjson_entry_t);
+
+        case MJSON_ID_UINT64:
+        case MJSON_ID_SINT64:
+        case MJSON_ID_FLOAT64:
+            RETURN_VAL_IF_FAIL(flags == 0 && room >= sizeof(uint32_t) + sizeof(uint64_t), 0);
+            return sizeof(uint32_t) + sizeof(uint64_t);
+
+        case MJSON_ID_UTF8_KEY32:
+        case MJSON_ID_UTF8_STRING32:
+            RETURN_VAL_IF_FAIL((flags & MJSON_FLAG_TABLE) == 0 && room >= sizeof(mjson_entry_t), 0);
+
+            if (flags & MJSON_FLAG_REF)
+            {
+                // target is complete string which precedes reference
+                offset = element->val_u32;
+                RETURN_VAL_IF_FAIL((offset & 3) == 0 && offset >= sizeof(mjson_entry_t), 0);
+                RETURN_VAL_IF_FAIL(offset <= (size_t)(data - blob) - sizeof(uint32_t), 0);
+
+                target = (mjson_element_t)(data - offset);
+                length = target->val_u32;
+                RETURN_VAL_IF_FAIL(target->id == MJSON_ID_UTF8_KEY32 || target->id == MJSON_ID_UTF8_STRING32, 0);
+                RETURN_VAL_IF_FAIL(length < offset - sizeof(mjson_entry_t), 0);
+                RETURN_VAL_IF_FAIL(((const uint8_t*)(target + 1))[length] == 0, 0);
+
+                return sizeof(mjson_entry_t);
             }
-yy107:
+
+            length = element->val_u32;
+            RETURN_VAL_IF_FAIL(length < room - sizeof(mjson_entry_t), 0);
+            RETURN_VAL_IF_FAIL(((const uint8_t*)(element + 1))[length] == 0, 0);
+            RETURN_VAL_IF_FAIL(element_size(element) <= room, 0);
+
+            return element_size(element);
+
+        case MJSON_ID_BINARY32:
+            RETURN_VAL_IF_FAIL(flags == 0 && room >= sizeof(mjson_entry_t), 0);
+            RETURN_VAL_IF_FAIL(element->val_u32 <= room - sizeof(mjson_entry_t) && element_size(element) <= room, 0);
+            return element_size(element);
+
+        case MJSON_ID_UTF8_KEY64:
+        case MJSON_ID_UTF8_STRING64:
+        case MJSON_ID_BINARY64:
+            // never interned, size is 64 bit payload
+            RETURN_VAL_IF_FAIL(flags == 0 && room >= sizeof(uint32_t) + sizeof(uint64_t), 0);
+
+            length64 = entry_payload_u64(element);
+            room    -= sizeof(uint32_t) + sizeof(uint64_t);
+
+            if (mjson_get_type(element) == MJSON_ID_BINARY64)
             {
-                token = TOK_HEX_NUMBER;
-                goto done;
+                RETURN_VAL_IF_FAIL(length64 <= room, 0);
             }
-yy108:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 0x00) goto yy36;
-            if (yych == '*') goto yy114;
-            goto yy108;
-yy110:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 0x00) goto yy36;
-            if (yych != '\n') goto yy110;
-            ++YYCURSOR;
+            else
             {
-                continue; 
+                RETURN_VAL_IF_FAIL(length64 < room, 0);
+                RETURN_VAL_IF_FAIL(entry_data(element)[length64] == 0, 0);
             }
-yy114:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych == '*') goto yy117;
-            if (yych == '/') goto yy119;
-            goto yy116;
-yy115:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-yy116:
-            if (yych <= 0x00) goto yy36;
-            if (yych == '*') goto yy122;
-            goto yy115;
-yy117:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '*') {
-                if (yych <= 0x00) goto yy36;
-                if (yych <= ')') goto yy115;
-                goto yy117;
-            } else {
-                if (yych == '/') goto yy121;
-                goto yy115;
+
+            RETURN_VAL_IF_FAIL(element_size(element) <= room + sizeof(uint32_t) + sizeof(uint64_t), 0);
+            return element_size(element);
+
+        case MJSON_ID_ARRAY64:
+        case MJSON_ID_DICT64:
+            RETURN_VAL_IF_FAIL(flags == 0 && room >= sizeof(uint32_t) + sizeof(uint64_t), 0);
+
+            length64 = entry_payload_u64(element);
+            RETURN_VAL_IF_FAIL((length64 & 3) == 0 && length64 <= room - sizeof(uint32_t) - sizeof(uint64_t), 0);
+
+            return sizeof(uint32_t) + sizeof(uint64_t);
+
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_DICT32:
+            RETURN_VAL_IF_FAIL((flags & MJSON_FLAG_REF) == 0 && room >= sizeof(mjson_entry_t), 0);
+            RETURN_VAL_IF_FAIL((element->val_u32 & 3) == 0 && element->val_u32 <= room - sizeof(mjson_entry_t), 0);
+
+            table = container_table(element);
+
+            if (table)
+            {
+                room -= sizeof(mjson_entry_t) + element->val_u32;
+                RETURN_VAL_IF_FAIL(room >= sizeof(mjson_entry_t) && table->id == MJSON_ID_BINARY32, 0);
+                RETURN_VAL_IF_FAIL((table->val_u32 & 3) == 0 && table->val_u32 <= room - sizeof(mjson_entry_t), 0);
+
+                if (mjson_get_type(element) == MJSON_ID_DICT32)
+                {
+                    // power of two number of {hash, offset} slots
+                    capacity = table->val_u32 / (2 * sizeof(uint32_t));
+                    RETURN_VAL_IF_FAIL(table->val_u32 % (2 * sizeof(uint32_t)) == 0, 0);
+                    RETURN_VAL_IF_FAIL(capacity >= 2 && (capacity & (capacity - 1)) == 0, 0);
+                }
             }
-yy119:
-            ++YYCURSOR;
-yy120:
+
+            return sizeof(mjson_entry_t);
+    }
+
+    return 0;
+}
+
+// Checks element against container it is in, including lookup table
+static int check_child(mjson_check_t* check, mjson_element_t element)
+{
+    const uint32_t* slots;
+    mjson_element_t str;
+    size_t          offset;
+    uint32_t        hash, mask, i, n;
+    int             member_key = is_key(element);
+
+    // tables are only present in 32 bit containers, so offset fits
+    offset = (const uint8_t*)element - (const uint8_t*)check->container;
+
+    if (is_array(check->container))
+    {
+        RETURN_VAL_IF_FAIL(!member_key, FALSE);
+
+        if (check->table)
+        {
+            RETURN_VAL_IF_FAIL(check->count < check->table->val_u32 / sizeof(uint32_t), FALSE);
+            RETURN_VAL_IF_FAIL(((const uint32_t*)(check->table + 1))[check->count] == offset, FALSE);
+        }
+
+        ++check->count;
+
+        return TRUE;
+    }
+
+    // dictionary is sequence of key, value pairs
+    RETURN_VAL_IF_FAIL(member_key == ((check->count & 1) == 0), FALSE);
+
+    ++check->count;
+
+    if (!member_key || !check->table)
+        return TRUE;
+
+    // key must be reachable by lookup, i.e. before first empty slot
+    slots = (const uint32_t*)(check->table + 1);
+    mask  = check->table->val_u32 / (2 * sizeof(uint32_t)) - 1;
+    str   = string_target(element);
+    hash  = hash_key(entry_data(str), entry_length(str));
+
+    for (i = hash & mask, n = 0; n <= mask && slots[2*i+1] != 0; i = (i + 1) & mask, ++n)
+    {
+        if (slots[2*i+1] == offset)
+            return slots[2*i] == hash;
+    }
+
+    return FALSE;
+}
+
+// Checks container once all its elements were seen
+static int check_container(const mjson_check_t* check)
+{
+    const uint32_t* slots;
+    uint32_t        capacity, used = 0, i;
+
+    if (is_array(check->container))
+        return !check->table || check->count == check->table->val_u32 / sizeof(uint32_t);
+
+    RETURN_VAL_IF_FAIL((check->count & 1) == 0, FALSE);
+    RETURN_VAL_IF_FAIL(check->table, TRUE);
+
+    // every key was found in its own slot, so equal number of used slots
+    // means there are no stray ones, and free slot keeps probing finite
+    slots    = (const uint32_t*)(check->table + 1);
+    capacity = check->table->val_u32 / (2 * sizeof(uint32_t));
+
+    for (i = 0; i < capacity; ++i)
+        used += slots[2*i+1] != 0;
+
+    return used == check->count / 2 && used < capacity;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Writer
+/////////////////////////////////////////////////////////////////////////////
+
+typedef struct
+{
+    uint64_t f;
+    int      e;
+} num_diyfp_t;
+
+// Grisu2 (Loitsch) cached powers: 10^k for k = -348 + 8*i, 64 bit significand
+#define NUM_CACHED_POWER_MIN  (-348)
+
+static const uint64_t cached_power_f[] =
+{
+    0xfa8fd5a0081c0288ull, 0xbaaee17fa23ebf76ull, 0x8b16fb203055ac76ull, 0xcf42894a5dce35eaull,
+    0x9a6bb0aa55653b2dull, 0xe61acf033d1a45dfull, 0xab70fe17c79ac6caull, 0xff77b1fcbebcdc4full,
+    0xbe5691ef416bd60cull, 0x8dd01fad907ffc3cull, 0xd3515c2831559a83ull, 0x9d71ac8fada6c9b5ull,
+    0xea9c227723ee8bcbull, 0xaecc49914078536dull, 0x823c12795db6ce57ull, 0xc21094364dfb5637ull,
+    0x9096ea6f3848984full, 0xd77485cb25823ac7ull, 0xa086cfcd97bf97f4ull, 0xef340a98172aace5ull,
+    0xb23867fb2a35b28eull, 0x84c8d4dfd2c63f3bull, 0xc5dd44271ad3cdbaull, 0x936b9fcebb25c996ull,
+    0xdbac6c247d62a584ull, 0xa3ab66580d5fdaf6ull, 0xf3e2f893dec3f126ull, 0xb5b5ada8aaff80b8ull,
+    0x87625f056c7c4a8bull, 0xc9bcff6034c13053ull, 0x964e858c91ba2655ull, 0xdff9772470297ebdull,
+    0xa6dfbd9fb8e5b88full, 0xf8a95fcf88747d94ull, 0xb94470938fa89bcfull, 0x8a08f0f8bf0f156bull,
+    0xcdb02555653131b6ull, 0x993fe2c6d07b7facull, 0xe45c10c42a2b3b06ull, 0xaa242499697392d3ull,
+    0xfd87b5f28300ca0eull, 0xbce5086492111aebull, 0x8cbccc096f5088ccull, 0xd1b71758e219652cull,
+    0x9c40000000000000ull, 0xe8d4a51000000000ull, 0xad78ebc5ac620000ull, 0x813f3978f8940984ull,
+    0xc097ce7bc90715b3ull, 0x8f7e32ce7bea5c70ull, 0xd5d238a4abe98068ull, 0x9f4f2726179a2245ull,
+    0xed63a231d4c4fb27ull, 0xb0de65388cc8ada8ull, 0x83c7088e1aab65dbull, 0xc45d1df942711d9aull,
+    0x924d692ca61be758ull, 0xda01ee641a708deaull, 0xa26da3999aef774aull, 0xf209787bb47d6b85ull,
+    0xb454e4a179dd1877ull, 0x865b86925b9bc5c2ull, 0xc83553c5c8965d3dull, 0x952ab45cfa97a0b3ull,
+    0xde469fbd99a05fe3ull, 0xa59bc234db398c25ull, 0xf6c69a72a3989f5cull, 0xb7dcbf5354e9beceull,
+    0x88fcf317f22241e2ull, 0xcc20ce9bd35c78a5ull, 0x98165af37b2153dfull, 0xe2a0b5dc971f303aull,
+    0xa8d9d1535ce3b396ull, 0xfb9b7cd9a4a7443cull, 0xbb764c4ca7a44410ull, 0x8bab8eefb6409c1aull,
+    0xd01fef10a657842cull, 0x9b10a4e5e9913129ull, 0xe7109bfba19c0c9dull, 0xac2820d9623bf429ull,
+    0x80444b5e7aa7cf85ull, 0xbf21e44003acdd2dull, 0x8e679c2f5e44ff8full, 0xd433179d9c8cb841ull,
+    0x9e19db92b4e31ba9ull, 0xeb96bf6ebadf77d9ull, 0xaf87023b9bf0ee6bull,
+};
+
+static const int16_t cached_power_e[] =
+{
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954,
+    -927, -901, -874, -847, -821, -794, -768, -741, -715, -688, -661,
+    -635, -608, -582, -555, -529, -502, -475, -449, -422, -396, -369,
+    -343, -316, -289, -263, -236, -210, -183, -157, -130, -103, -77,
+    -50, -24, 3, 30, 56, 83, 109, 136, 162, 189, 216,
+    242, 269, 295, 322, 348, 375, 402, 428, 455, 481, 508,
+    534, 561, 588, 614, 641, 667, 694, 720, 747, 774, 800,
+    827, 853, 880, 907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10_u64[20] =
+{
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull
+};
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static num_diyfp_t diyfp_mul(num_diyfp_t a, num_diyfp_t b)
+{
+    num_diyfp_t r;
+    uint64_t    lo, hi;
+
+    lo  = mul_64x64_128(a.f, b.f, &hi);
+    r.f = hi + (lo >> 63);
+    r.e = a.e + b.e + 64;
+
+    return r;
+}
+
+static num_diyfp_t diyfp_normalize(num_diyfp_t v)
+{
+    unsigned shift = count_leading_zeros64(v.f);
+
+    v.f <<= shift;
+    v.e  -= (int)shift;
+
+    return v;
+}
+
+// Cached power c such that product with 64 bit number with binary exponent
+// e has exponent in [-60, -32], *k receives its negated decimal exponent
+static num_diyfp_t cached_power(int e, int* k)
+{
+    num_diyfp_t c;
+    double      dk = (-61 - e) * 0.30102999566398114 + 347;
+    int         ki = (int)dk;
+    unsigned    index;
+
+    if (dk - ki > 0.0)
+        ++ki;
+
+    index = (unsigned)((ki >> 3) + 1);
+    *k    = -(NUM_CACHED_POWER_MIN + (int)(index << 3));
+    c.f   = cached_power_f[index];
+    c.e   = cached_power_e[index];
+
+    return c;
+}
+
+static int count_digits32(uint32_t n)
+{
+    int digits = 1;
+
+    while (digits < 10 && n >= (uint32_t)pow10_u64[digits])
+        ++digits;
+
+    return digits;
+}
+
+// Moves last digit towards w while it stays inside the rounding interval
+static void grisu_round(char* digits, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w)
+{
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        digits[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int grisu_digits(num_diyfp_t w, num_diyfp_t mp, uint64_t delta, char* digits, int* k)
+{
+    int      shift    = -mp.e;
+    uint64_t one_mask = (1ull << shift) - 1;
+    uint64_t wp_w     = mp.f - w.f;
+    uint32_t p1       = (uint32_t)(mp.f >> shift);
+    uint64_t p2       = mp.f & one_mask;
+    uint64_t rest;
+    uint32_t d;
+    int      kappa    = count_digits32(p1);
+    int      length   = 0;
+
+    while (kappa > 0)
+    {
+        // constant divisors, so there are no divisions in generated code
+        switch (kappa)
+        {
+            case 10: d = p1 / 1000000000; p1 %= 1000000000; break;
+            case  9: d = p1 /  100000000; p1 %=  100000000; break;
+            case  8: d = p1 /   10000000; p1 %=   10000000; break;
+            case  7: d = p1 /    1000000; p1 %=    1000000; break;
+            case  6: d = p1 /     100000; p1 %=     100000; break;
+            case  5: d = p1 /      10000; p1 %=      10000; break;
+            case  4: d = p1 /       1000; p1 %=       1000; break;
+            case  3: d = p1 /        100; p1 %=        100; break;
+            case  2: d = p1 /         10; p1 %=         10; break;
+            default: d = p1;              p1  =          0; break;
+        }
+
+        if (d || length)
+            digits[length++] = (char)('0' + d);
+
+        --kappa;
+        rest = ((uint64_t)p1 << shift) + p2;
+
+        if (rest <= delta)
+        {
+            *k += kappa;
+            grisu_round(digits, length, delta, rest, pow10_u64[kappa] << shift, wp_w);
+            return length;
+        }
+    }
+
+    for (;;)
+    {
+        p2    *= 10;
+        delta *= 10;
+        d      = (uint32_t)(p2 >> shift);
+
+        if (d || length)
+            digits[length++] = (char)('0' + d);
+
+        p2 &= one_mask;
+        --kappa;
+
+        if (p2 < delta)
+        {
+            *k += kappa;
+            grisu_round(digits, length, delta, p2, one_mask + 1, -kappa < 20 ? wp_w * pow10_u64[-kappa] : 0);
+            return length;
+        }
+    }
+}
+
+// Shortest digits of positive finite value which parse back to it,
+// value == digits * 10^k
+static int grisu2(double value, char* digits, int* k)
+{
+    uint64_t    bits     = double_to_bits(value);
+    uint64_t    mantissa = bits & ((1ull << 52) - 1);
+    int         biased   = (int)(bits >> 52);
+    num_diyfp_t v, plus, minus, c, w, wp, wm;
+
+    if (biased)
+    {
+        v.f = mantissa | (1ull << 52);
+        v.e = biased - 1075;
+    }
+    else
+    {
+        v.f = mantissa;
+        v.e = -1074;
+    }
+
+    // boundaries are halfway to neighbour doubles, lower one is closer on power of 2
+    plus.f = (v.f << 1) + 1;
+    plus.e = v.e - 1;
+    plus   = diyfp_normalize(plus);
+
+    if (v.f == (1ull << 52))
+    {
+        minus.f = (v.f << 2) - 1;
+        minus.e = v.e - 2;
+    }
+    else
+    {
+        minus.f = (v.f << 1) - 1;
+        minus.e = v.e - 1;
+    }
+
+    minus.f <<= minus.e - plus.e;
+    minus.e   = plus.e;
+
+    c  = cached_power(plus.e, k);
+    w  = diyfp_mul(diyfp_normalize(v), c);
+    wp = diyfp_mul(plus,  c);
+    wm = diyfp_mul(minus, c);
+
+    ++wm.f;
+    --wp.f;
+
+    return grisu_digits(w, wp, wp.f - wm.f, digits, k);
+}
+
+static char* format_exponent(char* out, int exponent)
+{
+    if (exponent < 0)
+    {
+        *out++    = '-';
+        exponent = -exponent;
+    }
+
+    if (exponent >= 100)
+    {
+        *out++    = (char)('0' + exponent / 100);
+        exponent %= 100;
+        *out++    = digit_pairs[exponent * 2];
+        *out++    = digit_pairs[exponent * 2 + 1];
+    }
+    else if (exponent >= 10)
+    {
+        *out++ = digit_pairs[exponent * 2];
+        *out++ = digit_pairs[exponent * 2 + 1];
+    }
+    else
+    {
+        *out++ = (char)('0' + exponent);
+    }
+
+    return out;
+}
+
+// Lays out digits * 10^k as decimal, it always has fraction or exponent so
+// parser reads it back as floating point number
+static char* format_decimal(char* out, int length, int k)
+{
+    int kk = length + k; // 10^(kk-1) <= value < 10^kk
+    int i;
+
+    if (k >= 0 && kk <= 21)
+    {
+        // 1234e7 -> 12340000000.0
+        for (i = length; i < kk; ++i)
+            out[i] = '0';
+        out[kk]     = '.';
+        out[kk + 1] = '0';
+        return out + kk + 2;
+    }
+
+    if (kk > 0 && kk <= 21)
+    {
+        // 1234e-2 -> 12.34
+        memmove(out + kk + 1, out + kk, length - kk);
+        out[kk] = '.';
+        return out + length + 1;
+    }
+
+    if (kk > -6 && kk <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        memmove(out + 2 - kk, out, length);
+        out[0] = '0';
+        out[1] = '.';
+        for (i = 2; i < 2 - kk; ++i)
+            out[i] = '0';
+        return out + length + 2 - kk;
+    }
+
+    if (length == 1)
+    {
+        // 1e30
+        out[1] = 'e';
+        return format_exponent(out + 2, kk - 1);
+    }
+
+    // 1234e30 -> 1.234e33
+    memmove(out + 2, out + 1, length - 1);
+    out[1]          = '.';
+    out[length + 1] = 'e';
+    return format_exponent(out + length + 2, kk - 1);
+}
+
+// Grisu2 result is not always shortest, such cases are rare and have 15 to
+// 17 digits. Tries one digit less, rounded either way, and keeps it if it
+// still parses back to value.
+static int shorten_digits(char* digits, int* length, int* k, double value)
+{
+    char  text[32];
+    char* end;
+    int   n = *length - 1, up, attempt, i;
+
+    for (attempt = 0, up = digits[n] >= '5'; attempt < 2; ++attempt, up = !up)
+    {
+        memcpy(text, digits, n);
+
+        for (i = n - 1; up && i >= 0; --i)
+        {
+            if (text[i] != '9')
             {
-                continue; 
-            }
-yy121:
-            yyaccept = 4;
-            ++YYCURSOR;
-            YYMARKER = YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 0x00) goto yy120;
-            if (yych != '*') goto yy115;
-yy122:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '*') {
-                if (yych <= 0x00) goto yy36;
-                if (yych <= ')') goto yy115;
-            } else {
-                if (yych == '/') goto yy119;
-                goto yy115;
-            }
-yy123:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '*') {
-                if (yych <= 0x00) goto yy36;
-                if (yych <= ')') goto yy115;
-                goto yy123;
-            } else {
-                if (yych == '/') goto yy121;
-                goto yy115;
-            }
-yy125:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-yy126:
-            if (yych <= '\f') {
-                if (yych <= 0x08) goto yy3;
-                if (yych <= '\n') goto yy125;
-                goto yy3;
-            } else {
-                if (yych <= '\r') goto yy125;
-                if (yych == ' ') goto yy125;
-                goto yy3;
+                ++text[i];
+                break;
             }
+            text[i] = '0';
+        }
+
+        if (up && i < 0)
+            continue;
+
+        text[n] = 'e';
+        end     = format_exponent(text + n + 1, *k + 1);
+
+        if (decode_double((const uint8_t*)text, (const uint8_t*)end) == value)
+        {
+            memcpy(digits, text, n);
+            *length = n;
+            *k     += 1;
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+// Shortest text which parses back to the same double, returns its length.
+// Infinity has no JSON form, it is written as out of range literal or null
+// in strict mode, NaN is always null.
+static int format_double(char* out/*[32]*/, double value, int strict)
+{
+    uint64_t bits = double_to_bits(value);
+    char*    p    = out;
+    int      length, k;
+
+    if ((bits & 0x7FF0000000000000ull) == 0x7FF0000000000000ull)
+    {
+        if ((bits & ((1ull << 52) - 1)) || strict)
+        {
+            memcpy(out, "null", 4);
+            return 4;
+        }
+
+        if (bits >> 63)
+            *p++ = '-';
+
+        memcpy(p, "1e999", 5);
+        return (int)(p - out) + 5;
+    }
+
+    if (bits >> 63)
+    {
+        *p++  = '-';
+        value = -value;
+    }
+
+    if (value == 0.0)
+    {
+        memcpy(p, "0.0", 3);
+        return (int)(p - out) + 3;
+    }
+
+    length = grisu2(value, p, &k);
+
+    while (length >= 15 && shorten_digits(p, &length, &k, value))
+        ;
+
+    return (int)(format_decimal(p, length, k) - out);
+}
+
+// Writes decimal digits of value ending at out, returns first digit
+static char* format_uint64(char* out, uint64_t value)
+{
+    unsigned pair;
+
+    while (value >= 100)
+    {
+        pair   = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--out = digit_pairs[pair + 1];
+        *--out = digit_pairs[pair];
+    }
+
+    if (value >= 10)
+    {
+        pair   = (unsigned)value * 2;
+        *--out = digit_pairs[pair + 1];
+        *--out = digit_pairs[pair];
+    }
+    else
+    {
+        *--out = (char)('0' + value);
+    }
+
+    return out;
+}
+
+static void writer_flush(mjson_writer_t* writer)
+{
+    size_t size = writer->pos - writer->buf;
+
+    writer->flushed += size;
+
+    if (writer->sink)
+    {
+        if (!writer->failed && size && !writer->sink(writer->user_data, (const char*)writer->buf, size))
+            writer->failed = TRUE;
+    }
+    else
+    {
+        // caller buffer is full, rest of text is only counted
+        writer->overflow = TRUE;
+        writer->buf      = writer->chunk;
+        writer->end      = writer->chunk + WRITE_CHUNK_SIZE;
+    }
+
+    writer->pos = writer->buf;
+}
+
+static size_t writer_finish(mjson_writer_t* writer)
+{
+    size_t size = writer->flushed + (writer->pos - writer->buf);
+
+    if (writer->sink && writer->pos != writer->buf)
+        writer_flush(writer);
+
+    return size;
+}
+
+static void writer_write(mjson_writer_t* writer, const void* data, size_t size)
+{
+    const uint8_t* src = (const uint8_t*)data;
+    size_t         room;
+
+    while (size)
+    {
+        if (writer->pos == writer->end)
+            writer_flush(writer);
+
+        room = writer->end - writer->pos;
+        room = room < size ? room : size;
+
+        memcpy(writer->pos, src, room);
+        writer->pos += room;
+        src         += room;
+        size        -= room;
+    }
+}
+
+static void writer_put(mjson_writer_t* writer, uint8_t ch)
+{
+    if (writer->pos == writer->end)
+        writer_flush(writer);
+
+    *writer->pos++ = ch;
+}
+
+static void write_newline(mjson_writer_t* writer)
+{
+    static const char spaces[] = "                                ";
+    size_t            indent   = (size_t)writer->depth * WRITE_INDENT;
+
+    if (!(writer->flags & MJSON_WRITE_PRETTY))
+        return;
+
+    writer_put(writer, '\n');
+
+    for (; indent > sizeof(spaces) - 1; indent -= sizeof(spaces) - 1)
+        writer_write(writer, spaces, sizeof(spaces) - 1);
+
+    writer_write(writer, spaces, indent);
+}
+
+// Returns pointer to the first byte which has to be escaped, or e
+static const uint8_t* find_escape(const uint8_t* c, const uint8_t* e)
+{
+#if defined(SIMD_WIDTH)
+    uint32_t mask;
+
+    while (e - c >= SIMD_WIDTH)
+    {
+        mask = simd_escape_mask(c);
+        if (mask)
+            return c + bit_scan_forward(mask);
+        c += SIMD_WIDTH;
+    }
+#endif
+
+    while (c < e && *c != '"' && *c != '\\' && *c >= 0x20)
+        ++c;
+
+    return c;
+}
+
+static void write_string(mjson_writer_t* writer, const uint8_t* str, size_t len)
+{
+    static const char hex[] = "0123456789abcdef";
+    const uint8_t*    e     = str + len;
+    const uint8_t*    run;
+    char              escape[6];
+
+    writer_put(writer, '"');
+
+    for (;;)
+    {
+        run = find_escape(str, e);
+        writer_write(writer, str, run - str);
+
+        if (run == e)
+            break;
+
+        escape[0] = '\\';
+        switch (*run)
+        {
+            case '"':  escape[1] = '"';  break;
+            case '\\': escape[1] = '\\'; break;
+            case '\b': escape[1] = 'b';  break;
+            case '\f': escape[1] = 'f';  break;
+            case '\n': escape[1] = 'n';  break;
+            case '\r': escape[1] = 'r';  break;
+            case '\t': escape[1] = 't';  break;
+            default:
+                escape[1] = 'u';
+                escape[2] = '0';
+                escape[3] = '0';
+                escape[4] = hex[*run >> 4];
+                escape[5] = hex[*run & 15];
+                writer_write(writer, escape, 6);
+                str = run + 1;
+                continue;
         }
 
-    }
+        writer_write(writer, escape, 2);
+        str = run + 1;
+    }
+
+    writer_put(writer, '"');
+}
+
+// Key can stay unquoted in mjson syntax if it is identifier, but not keyword
+static int is_plain_key(const uint8_t* key, size_t len)
+{
+    size_t i;
+
+    if (len == 0 || is_digit(key[0]))
+        return FALSE;
+
+    for (i = 0; i < len; ++i)
+    {
+        if (!is_ident_char(key[i]))
+            return FALSE;
+    }
+
+    return !((len == 4 && memcmp(key, "true",  4) == 0) ||
+             (len == 5 && memcmp(key, "false", 5) == 0) ||
+             (len == 4 && memcmp(key, "null",  4) == 0));
+}
+
+// Parser takes no escapes in keys, so key bytes are written as they are.
+// Key with quote or backslash, possible only with builder, has no text
+// form which parses back and fails the writer.
+static void write_key(mjson_writer_t* writer, const uint8_t* key, size_t len)
+{
+    if (!(writer->flags & MJSON_WRITE_STRICT) && is_plain_key(key, len))
+    {
+        writer_write(writer, key, len);
+        return;
+    }
+
+    if (memchr(key, '"', len) || memchr(key, '\\', len))
+    {
+        writer->failed = TRUE;
+        return;
+    }
+
+    writer_put(writer, '"');
+    writer_write(writer, key, len);
+    writer_put(writer, '"');
+}
+
+static void write_number(mjson_writer_t* writer, mjson_element_t element)
+{
+    char     buf[32];
+    char*    end = buf + sizeof(buf);
+    char*    start;
+    uint64_t magnitude;
+    int64_t  value;
+
+    switch (mjson_get_type(element))
+    {
+        case MJSON_ID_UINT32:
+            start = format_uint64(end, element->val_u32);
+            break;
+
+        case MJSON_ID_UINT64:
+            start = format_uint64(end, entry_payload_u64(element));
+            break;
 
-done:
-    context->token = token;
-    context->start = s;
-    context->next  = c;
+        case MJSON_ID_SINT32:
+        case MJSON_ID_SINT64:
+            value     = mjson_get_type(element) == MJSON_ID_SINT32 ? element->val_s32 : (int64_t)entry_payload_u64(element);
+            magnitude = value < 0 ? 0 - (uint64_t)value : (uint64_t)value;
+            start     = format_uint64(end, magnitude);
+            if (value < 0)
+                *--start = '-';
+            break;
 
-#undef YYREADINPUT
-#undef YYCTYPE           
-#undef YYCURSOR          
-#undef YYMARKER          
+        case MJSON_ID_FLOAT32:
+            start = buf;
+            end   = buf + format_double(buf, element->val_f32, writer->flags & MJSON_WRITE_STRICT);
+            break;
+
+        default:
+            start = buf;
+            end   = buf + format_double(buf, bits_to_double(entry_payload_u64(element)), writer->flags & MJSON_WRITE_STRICT);
+            break;
+    }
+
+    writer_write(writer, start, end - start);
 }
 
-static int parse_number(mjson_parser_t *context)
+static void write_element(mjson_writer_t* writer, mjson_element_t element)
 {
-    int            num_parsed;
-    uint8_t        bjson_id;
-    const char*    format;
-    mjson_entry_t* bdata;
+    mjson_element_t child, end, str;
+    int             first = TRUE;
 
-    switch(context->token)
+    if (writer->failed)
+        return;
+
+    switch (mjson_get_type(element))
     {
-        case TOK_OCT_NUMBER:
-            bjson_id = MJSON_ID_SINT32;
-            format   = "%o";
+        case MJSON_ID_NULL:
+            writer_write(writer, "null", 4);
             break;
-        case TOK_HEX_NUMBER:
-            bjson_id = MJSON_ID_SINT32;
-            format   = "%x";
+
+        case MJSON_ID_FALSE:
+            writer_write(writer, "false", 5);
             break;
-        case TOK_DEC_NUMBER:
-            bjson_id = MJSON_ID_SINT32;
-            format   = "%d";
+
+        case MJSON_ID_TRUE:
+            writer_write(writer, "true", 4);
             break;
-        case TOK_FLOAT_NUMBER:
-            bjson_id = MJSON_ID_FLOAT32;
-            format   = "%f";
+
+        case MJSON_ID_EMPTY_STRING:
+            writer_write(writer, "\"\"", 2);
+            break;
+
+        case MJSON_ID_UINT32:
+        case MJSON_ID_UINT64:
+        case MJSON_ID_SINT32:
+        case MJSON_ID_SINT64:
+        case MJSON_ID_FLOAT32:
+        case MJSON_ID_FLOAT64:
+            write_number(writer, element);
+            break;
+
+        case MJSON_ID_UTF8_KEY32:
+        case MJSON_ID_UTF8_KEY64:
+        case MJSON_ID_UTF8_STRING32:
+        case MJSON_ID_UTF8_STRING64:
+            str = string_target(element);
+            write_string(writer, entry_data(str), entry_length(str));
+            break;
+
+        case MJSON_ID_ARRAY32:
+        case MJSON_ID_ARRAY64:
+        case MJSON_ID_DICT32:
+        case MJSON_ID_DICT64:
+            end = (mjson_element_t)(entry_data(element) + entry_length(element));
+
+            writer_put(writer, is_array(element) ? '[' : '{');
+            ++writer->depth;
+
+            for (child = (mjson_element_t)entry_data(element); child < end && !writer->failed; child = next_element(child))
+            {
+                if (!first)
+                    writer_put(writer, ',');
+                write_newline(writer);
+                first = FALSE;
+
+                if (is_dict(element))
+                {
+                    str = string_target(child);
+                    write_key(writer, entry_data(str), entry_length(str));
+                    writer_write(writer, ": ", writer->flags & MJSON_WRITE_PRETTY ? 2 : 1);
+                    child = next_element(child);
+                }
+
+                write_element(writer, child);
+            }
+
+            --writer->depth;
+            if (!first)
+                write_newline(writer);
+            writer_put(writer, is_array(element) ? ']' : '}');
             break;
+
         default:
-            assert(!"unknown token");
+            // lookup tables are skipped with containers, anything else has no text form
+            writer_write(writer, "null", 4);
+            break;
     }
+}
 
-    bdata = (mjson_entry_t*)parsectx_allocate_output(context, (ptrdiff_t)sizeof(mjson_entry_t));
+/////////////////////////////////////////////////////////////////////////////
+// Builder
+/////////////////////////////////////////////////////////////////////////////
 
-    if (!bdata) return 0;
+// Values go through the same checks as tokens in stream_token, first
+// failure sticks and every later call returns 0.
+static int builder_value(mjson_builder_t* builder, int is_container)
+{
+    mjson_stream_t* stream;
+    mjson_frame_t*  frame;
 
-    bdata->id = bjson_id;
-    num_parsed = sscanf((char*)context->start, format, &bdata->val_u32);
-    assert(num_parsed == 1);
+    RETURN_VAL_IF_FAIL(builder, FALSE);
 
-    parsectx_next_token(context);
+    stream = &builder->stream;
+    RETURN_VAL_IF_FAIL(!stream->failed, FALSE);
+
+    // single top element, which is a container
+    if (stream->depth == 0)
+        return builder_result(builder, is_container && !stream->done);
+
+    frame = &stream->stack[stream->depth - 1];
+    if (frame->is_dict)
+    {
+        if (frame->state != FRAME_VALUE)
+            return builder_result(builder, FALSE);
+
+        frame->state = FRAME_NEXT;
+    }
+
+    return TRUE;
+}
+
+static int builder_result(mjson_builder_t* builder, int result)
+{
+    if (!result)
+        builder->stream.failed = TRUE;
+
+    return result;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Threads
+/////////////////////////////////////////////////////////////////////////////
+
+#if defined(MJSON_THREADS) && defined(_WIN32)
+
+static DWORD WINAPI thread_entry(LPVOID arg)
+{
+    mjson_thread_t* thread = (mjson_thread_t*)arg;
+
+    thread->func(thread->arg);
+
+    return 0;
+}
+
+static int thread_start(mjson_thread_t* thread, void (*func)(void* arg), void* arg)
+{
+    thread->func   = func;
+    thread->arg    = arg;
+    thread->handle = CreateThread(NULL, 0, thread_entry, thread, 0, NULL);
+
+    return thread->handle != NULL;
+}
+
+static void thread_join(mjson_thread_t* thread)
+{
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+}
+
+static int cpu_count(void)
+{
+    SYSTEM_INFO info;
+
+    GetSystemInfo(&info);
+
+    return (int)info.dwNumberOfProcessors;
+}
+
+static void mutex_init(mjson_mutex_t* mutex)
+{
+    InitializeCriticalSection(mutex);
+}
+
+static void mutex_destroy(mjson_mutex_t* mutex)
+{
+    DeleteCriticalSection(mutex);
+}
+
+static void mutex_lock(mjson_mutex_t* mutex)
+{
+    EnterCriticalSection(mutex);
+}
+
+static void mutex_unlock(mjson_mutex_t* mutex)
+{
+    LeaveCriticalSection(mutex);
+}
+
+#elif defined(MJSON_THREADS)
+
+static void* thread_entry(void* arg)
+{
+    mjson_thread_t* thread = (mjson_thread_t*)arg;
+
+    thread->func(thread->arg);
+
+    return NULL;
+}
+
+static int thread_start(mjson_thread_t* thread, void (*func)(void* arg), void* arg)
+{
+    thread->func = func;
+    thread->arg  = arg;
+
+    return pthread_create(&thread->handle, NULL, thread_entry, thread) == 0;
+}
+
+static void thread_join(mjson_thread_t* thread)
+{
+    pthread_join(thread->handle, NULL);
+}
+
+static int cpu_count(void)
+{
+    long count = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return count > 0 ? (int)count : 1;
+}
+
+static void mutex_init(mjson_mutex_t* mutex)
+{
+    pthread_mutex_init(mutex, NULL);
+}
+
+static void mutex_destroy(mjson_mutex_t* mutex)
+{
+    pthread_mutex_destroy(mutex);
+}
+
+static void mutex_lock(mjson_mutex_t* mutex)
+{
+    pthread_mutex_lock(mutex);
+}
+
+static void mutex_unlock(mjson_mutex_t* mutex)
+{
+    pthread_mutex_unlock(mutex);
+}
+
+#else
+
+static int cpu_count(void)
+{
     return 1;
 }
 
-static int parse_string(mjson_parser_t *context, uint32_t id)
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+// Parallel parsing
+/////////////////////////////////////////////////////////////////////////////
+
+// Guesses where element of top level array ends after guess: first comma at
+// the lowest bracket depth seen in window. Scan starts after newline if
+// there is one, which is likely but not certain to be outside of strings and
+// comments. Comments are not recognized, wrong guesses are caught by
+// parse_segments.
+static const uint8_t* find_split(const uint8_t* guess, const uint8_t* end)
 {
-#define YYREADINPUT(c) (c>=e?0:*c)
-#define YYCTYPE        uint8_t
-#define YYCURSOR       c
-#define YYMARKER       m
+    const uint8_t* e     = end - guess > PARALLEL_SCAN_WINDOW ? guess + PARALLEL_SCAN_WINDOW : end;
+    const uint8_t* c     = guess;
+    const uint8_t* split = NULL;
+    int            depth = 0, lowest = 0;
 
-    uint8_t* c = context->start+1;
-    uint8_t* e = context->next;
-    uint8_t* m = NULL;
-    uint8_t* s;
+    while (c < e && *c != '\n')
+        ++c;
 
-    mjson_entry_t* bdata;
-    uint32_t       ch = 0;
-    uint8_t*       str_dst;
-    const uint8_t* str_src;
-    ptrdiff_t      str_len;
-    size_t         len;
-    int            num_parsed;
+    if (c == e)
+        c = guess;
 
-    assert(
-        context->token == TOK_STRING       ||
-        context->token == TOK_NOESC_STRING ||
-        context->token == TOK_IDENTIFIER
-    );
-    
-    bdata = (mjson_entry_t*)parsectx_allocate_output(context, (ptrdiff_t)sizeof(mjson_entry_t));
-    
-    if (!bdata) return 0;
-    
-    bdata->id = id;
+    for (; c < e; ++c)
+    {
+        switch (*c)
+        {
+            case '"':
+                for (++c; c < e && *c != '"'; ++c)
+                {
+                    if (*c == '\\' && c + 1 < e)
+                        ++c;
+                }
+                break;
 
-    if (context->token != TOK_STRING)
+            case '[':
+            case '{':
+                ++depth;
+                break;
+
+            case ']':
+            case '}':
+                if (--depth < lowest)
+                {
+                    lowest = depth;
+                    split  = NULL;
+                }
+                break;
+
+            case ',':
+                if (depth == lowest && !split)
+                    split = c + 1;
+                break;
+        }
+    }
+
+    return split;
+}
+
+// Same grammar as parse_value_list: segment other than the first starts
+// after separator, so value must follow, and all but the last end right
+// after separator.
+static int parse_segment_elements(mjson_parser_t* context, int first, int last)
+{
+    int stop_token  = last ? TOK_RIGHT_BRACKET : TOK_NONE;
+    int after_comma = !first;
+    int separated   = FALSE;
+
+    parsectx_next_token(context);
+
+    while (context->token != stop_token)
     {
-        str_src = context->start;
-        str_len = context->next - context->start;
+        if (!parse_value(context))
+            return FALSE;
+
+        after_comma = context->token == TOK_COMMA;
+        separated   = after_comma && context->next == context->end;
+
+        if (after_comma)
+            parsectx_next_token(context);
+    }
+
+    if (!last)
+        return separated;
+
+    parsectx_next_token(context);
+
+    return !after_comma && context->token == TOK_NONE;
+}
+
+// MULTILINE_COMMENT closed by "/" after two or more stars is matched
+// greedily and may extend past segment end when whole document is lexed,
+// e.g. over separator taken as split. Segment with such closer is only
+// trusted if it is the last one.
+static int has_greedy_comment_end(const uint8_t* c, const uint8_t* e)
+{
+    while ((c = (const uint8_t*)memchr(c, '*', e - c)) != NULL)
+    {
+        if (e - c >= 3 && c[1] == '*' && c[2] == '/')
+            return TRUE;
+        ++c;
+    }
+
+    return FALSE;
+}
+
+static void parse_segment(mjson_segment_t* segment)
+{
+    mjson_index_t  index;
+    mjson_intern_t intern;
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)segment->begin, (uint8_t*)segment->end,
+        NULL, NULL,
+        NULL, segment->flags
+    };
+
+    segment->parsed   = FALSE;
+    segment->capacity = segment->end - segment->begin + 256;
+    segment->storage  = (uint8_t*)segment->allocator->reserve(segment->allocator->user_data, segment->capacity);
+
+    RETURN_IF_FAIL(segment->storage);
+
+    c.bjson       = segment->storage;
+    c.bjson_limit = segment->storage + segment->capacity;
+    c.bjson_start = segment->storage;
+    c.allocator   = segment->allocator;
+
+    if (c.flags & MJSON_PARSE_INDEXED)
+    {
+        index_init(&index, c.next);
+        c.index = &index;
+    }
+
+    if (c.flags & (MJSON_PARSE_INTERN_KEYS | MJSON_PARSE_INTERN_STRINGS))
+    {
+        memset(&intern, 0, sizeof(intern));
+        c.intern = &intern;
+    }
+
+    // first segment starts right after opening bracket, others after comma
+    segment->parsed   = parse_segment_elements(&c, segment->begin[-1] == '[', segment->last) &&
+                        (segment->last || !has_greedy_comment_end(segment->begin, segment->end));
+    segment->storage  = c.bjson_start;
+    segment->capacity = c.bjson_limit - c.bjson_start;
+    segment->size     = c.bjson - c.bjson_start;
+}
+
+#if defined(MJSON_THREADS)
+static void parse_segment_thread(void* arg)
+{
+    parse_segment((mjson_segment_t*)arg);
+}
+#endif
+
+static void release_segment(mjson_segment_t* segment)
+{
+    if (segment->storage)
+        segment->allocator->release(segment->allocator->user_data, segment->storage, segment->capacity);
+
+    segment->storage  = NULL;
+    segment->capacity = 0;
+    segment->size     = 0;
+}
+
+// Parses segments concurrently, then checks them in order. Start of segment
+// is known to be right once previous one ended at its separator, otherwise
+// the guess was wrong and segment is parsed again together with previous.
+// Fails if the last segment does not parse, caller then parses document
+// serially, as segment could have failed for a reason serial parse has not.
+static int parse_segments(mjson_segment_t* segments, int count)
+{
+#if defined(MJSON_THREADS)
+    mjson_thread_t threads[PARALLEL_MAX_THREADS];
+    int            started[PARALLEL_MAX_THREADS];
+#endif
+    int            i;
+
+#if defined(MJSON_THREADS)
+    for (i = 1; i < count; ++i)
+        started[i] = thread_start(&threads[i], parse_segment_thread, &segments[i]);
+#endif
+
+    parse_segment(&segments[0]);
+
+    for (i = 1; i < count; ++i)
+    {
+#if defined(MJSON_THREADS)
+        if (started[i])
+        {
+            thread_join(&threads[i]);
+            continue;
+        }
+#endif
+        parse_segment(&segments[i]);
+    }
+
+    for (i = 0; i < count; ++i)
+    {
+        if (segments[i].parsed)
+            continue;
+
+        if (segments[i].last)
+            return FALSE;
+
+        segments[i + 1].begin = segments[i].begin;
+        release_segment(&segments[i]);
+        release_segment(&segments[i + 1]);
+        parse_segment(&segments[i + 1]);
+    }
+
+    return TRUE;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Thread pool
+/////////////////////////////////////////////////////////////////////////////
+
+#if defined(MJSON_THREADS)
+
+static int worker_take(mjson_worker_t* worker, size_t* item)
+{
+    int taken;
+
+    mutex_lock(&worker->lock);
+    taken = worker->next < worker->end;
+    if (taken)
+        *item = worker->next++;
+    mutex_unlock(&worker->lock);
+
+    return taken;
+}
+
+// Moves upper half of first nonempty range of other workers to own range.
+// Ranges in flight are invisible to others, worst case is that some worker
+// quits early, item itself is always parsed by thief.
+static int worker_steal(mjson_worker_t* worker)
+{
+    mjson_pool_t*   pool = worker->pool;
+    mjson_worker_t* victim;
+    size_t          begin = 0, end = 0;
+    int             i;
+
+    for (i = 1; i < pool->count && begin == end; ++i)
+    {
+        victim = &pool->workers[(worker->index + i) % pool->count];
 
-        if (context->token==TOK_NOESC_STRING)
+        mutex_lock(&victim->lock);
+        if (victim->next < victim->end)
         {
-            str_src += 1;
-            str_len -= 2;
+            begin = victim->next + (victim->end - victim->next) / 2;
+            end   = victim->end;
+            victim->end = begin;
         }
-        
-        bdata->val_u32 = str_len;
+        mutex_unlock(&victim->lock);
+    }
 
-        str_dst = (uint8_t*)parsectx_allocate_output(context, str_len + 1);
+    RETURN_VAL_IF_FAIL(begin < end, FALSE);
 
-        if (!str_dst) return 0;
+    mutex_lock(&worker->lock);
+    worker->next = begin;
+    worker->end  = end;
+    mutex_unlock(&worker->lock);
 
-        memcpy(str_dst, str_src, str_len);
-        str_dst[str_len] = 0;
+    return TRUE;
+}
+
+static void worker_run(void* arg)
+{
+    mjson_worker_t* worker = (mjson_worker_t*)arg;
+    size_t          item;
+
+    do
+    {
+        while (worker_take(worker, &item))
+            worker->pool->func(worker->pool->arg, item);
+    }
+    while (worker_steal(worker));
+}
 
-        parsectx_align4_output(context);
+// Calls func for every item on up to thread_count threads (number of CPUs
+// if 0), calling thread is one of workers. Items are split evenly up front,
+// stealing only balances uneven ones.
+static void pool_run(size_t item_count, int thread_count, void (*func)(void* arg, size_t item), void* arg)
+{
+    mjson_pool_t* pool;
+    int           started[PARALLEL_MAX_THREADS];
+    int           i;
 
-        parsectx_next_token(context);
+    if (thread_count <= 0)
+        thread_count = cpu_count();
 
-        return 1;
+    thread_count = thread_count < PARALLEL_MAX_THREADS ? thread_count : PARALLEL_MAX_THREADS;
+    thread_count = (size_t)thread_count < item_count ? thread_count : (int)item_count;
+
+    pool = thread_count > 1 ? (mjson_pool_t*)calloc(1, sizeof(mjson_pool_t)) : NULL;
+
+    if (!pool)
+    {
+        size_t item;
+
+        for (item = 0; item < item_count; ++item)
+            func(arg, item);
+
+        return;
     }
 
-    while (TRUE)
+    pool->count = thread_count;
+    pool->func  = func;
+    pool->arg   = arg;
+
+    for (i = 0; i < thread_count; ++i)
     {
-        s = c;
+        mutex_init(&pool->workers[i].lock);
+        pool->workers[i].next  = item_count / thread_count * i;
+        pool->workers[i].end   = i + 1 < thread_count ? item_count / thread_count * (i + 1) : item_count;
+        pool->workers[i].pool  = pool;
+        pool->workers[i].index = i;
+    }
 
+    // ranges of threads which failed to start are stolen by others
+    for (i = 1; i < thread_count; ++i)
+        started[i] = thread_start(&pool->workers[i].thread, worker_run, &pool->workers[i]);
 
-        {
-            YYCTYPE yych;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '"') {
-                if (yych <= 0x00) goto yy135;
-                if (yych >= '"') goto yy133;
-            } else {
-                if (yych == '\\') goto yy131;
-            }
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy146;
-yy130:
-            {
-                str_dst = (uint8_t*)parsectx_allocate_output(context, c - s);
-                
-                if (!str_dst) return 0;
-                
-                memcpy(str_dst, s, c - s);
+    worker_run(&pool->workers[0]);
 
-                continue;
-            }
-yy131:
-            ++YYCURSOR;
-            YYMARKER = YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= 'e') {
-                if (yych <= '/') {
-                    if (yych == '"') goto yy138;
-                    if (yych >= '/') goto yy138;
-                } else {
-                    if (yych <= '\\') {
-                        if (yych >= '\\') goto yy138;
-                    } else {
-                        if (yych == 'b') goto yy138;
-                    }
-                }
-            } else {
-                if (yych <= 'q') {
-                    if (yych <= 'f') goto yy138;
-                    if (yych == 'n') goto yy138;
-                } else {
-                    if (yych <= 's') {
-                        if (yych <= 'r') goto yy138;
-                    } else {
-                        if (yych <= 't') goto yy138;
-                        if (yych <= 'u') goto yy136;
-                    }
-                }
-            }
-yy132:
-            { 
-                assert(!"reachable");
-            }
-yy133:
-            ++YYCURSOR;
-            {
-                bdata->val_u32 = context->bjson - (uint8_t*)(bdata + 1);
-                *context->bjson++ = 0;
-                parsectx_align4_output(context);
-                parsectx_next_token(context);
+    for (i = 1; i < thread_count; ++i)
+    {
+        if (started[i])
+            thread_join(&pool->workers[i].thread);
+    }
 
-                return 1;
-            }
-yy135:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            goto yy132;
-yy136:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '@') {
-                if (yych <= '/') goto yy137;
-                if (yych <= '9') goto yy140;
-            } else {
-                if (yych <= 'F') goto yy140;
-                if (yych <= '`') goto yy137;
-                if (yych <= 'f') goto yy140;
-            }
-yy137:
-            YYCURSOR = YYMARKER;
-            goto yy132;
-yy138:
-            ++YYCURSOR;
-            {
-                char decoded = s[1];
-                
-                switch (s[1])
-                {
-                    case 'b':
-                        decoded = '\b';
-                        break;
-                    case 'n':
-                        decoded = '\n';
-                        break;
-                    case 'r':
-                        decoded = '\r';
-                        break;
-                    case 't':
-                        decoded = '\t';
-                        break;
-                    case 'f':
-                        decoded = '\f';
-                        break;
-                }
-                
-                str_dst = (uint8_t*)parsectx_allocate_output(context, 1);
-                
-                if (!str_dst) return 0;
-                
-                *str_dst = decoded;
-                
-                continue;
-            }
-yy140:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '@') {
-                if (yych <= '/') goto yy137;
-                if (yych >= ':') goto yy137;
-            } else {
-                if (yych <= 'F') goto yy141;
-                if (yych <= '`') goto yy137;
-                if (yych >= 'g') goto yy137;
-            }
-yy141:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '@') {
-                if (yych <= '/') goto yy137;
-                if (yych >= ':') goto yy137;
-            } else {
-                if (yych <= 'F') goto yy142;
-                if (yych <= '`') goto yy137;
-                if (yych >= 'g') goto yy137;
-            }
-yy142:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-            if (yych <= '@') {
-                if (yych <= '/') goto yy137;
-                if (yych >= ':') goto yy137;
-            } else {
-                if (yych <= 'F') goto yy143;
-                if (yych <= '`') goto yy137;
-                if (yych >= 'g') goto yy137;
-            }
-yy143:
-            ++YYCURSOR;
-            {
-                str_dst = (uint8_t*)parsectx_reserve_output(context, 6);
+    for (i = 0; i < thread_count; ++i)
+        mutex_destroy(&pool->workers[i].lock);
 
-                if (!str_dst) return 0;
+    free(pool);
+}
 
-                num_parsed = sscanf((char*)(s + 2), "%4x", &ch);
-                assert(num_parsed == 1);
-                unicode_cp_to_utf8(ch, str_dst, &len);
+#else
 
-                parsectx_advance_output(context, len);
+static void pool_run(size_t item_count, int thread_count, void (*func)(void* arg, size_t item), void* arg)
+{
+    size_t item;
 
-                continue;
-            }
-yy145:
-            ++YYCURSOR;
-            yych = YYREADINPUT(YYCURSOR);
-yy146:
-            if (yych <= '"') {
-                if (yych <= 0x00) goto yy130;
-                if (yych <= '!') goto yy145;
-                goto yy130;
-            } else {
-                if (yych == '\\') goto yy130;
-                goto yy145;
-            }
-        }
+    for (item = 0; item < item_count; ++item)
+        func(arg, item);
+}
 
-    }
+#endif
 
-#undef YYREADINPUT
-#undef YYCTYPE           
-#undef YYCURSOR          
-#undef YYMARKER 
+/////////////////////////////////////////////////////////////////////////////
+// Batch parsing
+/////////////////////////////////////////////////////////////////////////////
 
-    assert(!"reachable");
-    return 0;
+static void parse_batch_item(void* arg, size_t item)
+{
+    mjson_batch_t*    batch    = (mjson_batch_t*)arg;
+    mjson_document_t* document = &batch->documents[item];
+
+    if (document->storage_buf)
+    {
+        mjson_parse_with_flags(document->json_data, document->json_data_size, document->storage_buf, document->storage_buf_size, batch->flags, &document->top_element);
+        return;
+    }
+
+    mjson_parse_ex(document->json_data, document->json_data_size, batch->flags, batch->allocator, &document->storage_buf, &document->storage_buf_size, &document->top_element);
 }
 
-static int parse_simple(mjson_parser_t *context)
+static int is_blank_line(const uint8_t* begin, const uint8_t* end)
 {
-    uint32_t* id;
+    for (; begin < end; ++begin)
+    {
+        if (*begin != ' ' && *begin != '\t' && *begin != '\r')
+            return FALSE;
+    }
 
-    assert(
-        context->token == TOK_NULL  ||
-        context->token == TOK_FALSE ||
-        context->token == TOK_TRUE
-    );
+    return TRUE;
+}
 
-    id = (uint32_t*)parsectx_allocate_output(context, sizeof(uint32_t));
-    if (!id) return 0;
+/////////////////////////////////////////////////////////////////////////////
+// On-demand navigation
+/////////////////////////////////////////////////////////////////////////////
+
+// Handle to value at current token, NULL one if token does not start a value
+static mjson_lazy_t lazy_value(const mjson_parser_t* context, const char* end)
+{
+    mjson_lazy_t result = { NULL, NULL, FALSE };
 
     switch (context->token)
     {
+        case TOK_LEFT_CURLY_BRACKET:
+        case TOK_LEFT_BRACKET:
         case TOK_NULL:
-            *id = MJSON_ID_NULL;
-            break;
         case TOK_FALSE:
-            *id = MJSON_ID_FALSE;
-            break;
         case TOK_TRUE:
-            *id = MJSON_ID_TRUE;
-            break;
+        case TOK_OCT_NUMBER:
+        case TOK_HEX_NUMBER:
+        case TOK_DEC_NUMBER:
+        case TOK_FLOAT_NUMBER:
+        case TOK_NOESC_STRING:
+        case TOK_STRING:
+            result.begin = (const char*)context->start;
+            result.end   = end;
     }
 
-    parsectx_next_token(context);
-    return 1;
+    return result;
 }
 
-static int parse_value(mjson_parser_t *context)
+// Moves to token after value, containers are skipped without lexing them
+static int lazy_skip_value(mjson_parser_t* context)
 {
-    assert(context);
- 
     switch (context->token)
     {
+        case TOK_LEFT_CURLY_BRACKET:
+        case TOK_LEFT_BRACKET:
+            context->next = lazy_skip_container(context->start, context->end);
+            RETURN_VAL_IF_FAIL(context->next, FALSE);
+            break;
+
         case TOK_NULL:
         case TOK_FALSE:
         case TOK_TRUE:
-            return parse_simple(context);
-
         case TOK_OCT_NUMBER:
         case TOK_HEX_NUMBER:
         case TOK_DEC_NUMBER:
         case TOK_FLOAT_NUMBER:
-            return parse_number(context);
-
         case TOK_NOESC_STRING:
         case TOK_STRING:
-            return parse_string(context, MJSON_ID_UTF8_STRING32);
-
-        case TOK_LEFT_CURLY_BRACKET:
-            parsectx_next_token(context);
-            return parse_key_value_pair(context, TOK_RIGHT_CURLY_BRACKET);
+            break;
 
-        case TOK_LEFT_BRACKET:
-            parsectx_next_token(context);
-            return parse_value_list(context);
+        default:
+            return FALSE;
     }
 
-    return 0;
+    parsectx_next_token(context);
+
+    return TRUE;
 }
 
-static int parse_value_list(mjson_parser_t *context)
+// Finds end of container at c by counting brackets outside of strings, 64
+// bytes at a time with masks like structural index. Comments are stepped over
+// as lexer sees them, contents are not validated.
+static uint8_t* lazy_skip_container(uint8_t* c, uint8_t* e)
 {
-    mjson_entry_t* array;
-    uint8_t*       data_start;
-    int            expect_separator;
+    uint8_t       padded[INDEX_BLOCK_SIZE];
+    index_block_t block;
+    uint8_t*      p;
+    uint64_t      quote, in_string, slash, ops, valid;
+    uint64_t      prev_in_string = 0, prev_escaped = 0;
+    ptrdiff_t     len;
+    size_t        depth = 0;
+
+    while (c < e)
+    {
+        len = e - c;
+        if (len >= INDEX_BLOCK_SIZE)
+        {
+            index_classify_brackets(c, &block);
+            valid = ~0ull;
+        }
+        else
+        {
+            memset(padded, ' ', sizeof(padded));
+            memcpy(padded, c, len);
+            index_classify_brackets(padded, &block);
+            valid = (1ull << len) - 1;
+        }
 
-    assert(context);
+        quote     = block.quote & ~index_escaped_chars(&prev_escaped, block.backslash);
+        in_string = prefix_xor(quote) ^ prev_in_string;
 
-    array = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t));
+        // like in index_fill string state is not valid after comment
+        slash = block.slash & ~in_string & valid;
+        if (slash)
+            valid &= (1ull << bit_scan_forward64(slash)) - 1;
 
-    if (!array) return 0;
-    
-    array->id  = MJSON_ID_ARRAY32;
-    data_start = context->bjson;
+        for (ops = block.op & ~in_string & valid; ops; ops &= ops - 1)
+        {
+            p = c + bit_scan_forward64(ops);
 
-    expect_separator = FALSE;
+            if (*p == '{' || *p == '[')
+                ++depth;
+            else if (--depth == 0)
+                return p + 1;
+        }
 
-    while (context->token != TOK_RIGHT_BRACKET)
-    {
-        if (expect_separator && context->token == TOK_COMMA)
-            parsectx_next_token(context);
-        else
-            expect_separator = TRUE;
+        if (slash)
+        {
+            c += bit_scan_forward64(slash);
+            p  = skip_whitespace_and_comments(c, e, FALSE);
+            c  = p > c ? p : c + 1;
 
-        if (!parse_value(context))
-            return 0;
+            prev_in_string = 0;
+            prev_escaped   = 0;
+        }
+        else
+        {
+            prev_in_string = (uint64_t)((int64_t)in_string >> 63);
+            c = len > INDEX_BLOCK_SIZE ? c + INDEX_BLOCK_SIZE : e;
+        }
     }
 
-    array->val_u32 = context->bjson - data_start;
-
-    assert((array->val_u32 & 3) == 0);
-
-    parsectx_next_token(context);
-
-    return 1;
+    return NULL;
 }
 
-static int parse_key_value_pair(mjson_parser_t* context, int stop_token)
+// Decodes scalar at element into entry of up to 12 bytes laid out as in
+// blob, so blob accessors do conversions. NULL for other values.
+static mjson_element_t lazy_scalar(mjson_lazy_t element, uint32_t* entry)
 {
-    mjson_entry_t* dictionary;
-    uint8_t*       data_start;
-    int            expect_separator;
- 
-    assert(context);
+    uint32_t       id;
+    uint64_t       bits;
+    mjson_parser_t c = {
+        TOK_NONE, 0,
+        (uint8_t*)element.begin, (uint8_t*)element.end,
+        NULL, NULL,
+        NULL, 0
+    };
 
-    dictionary = (mjson_entry_t*)parsectx_allocate_output(context, sizeof(mjson_entry_t));
-    
-    if (!dictionary) return 0;
-    
-    dictionary->id = MJSON_ID_DICT32;
-    data_start     = context->bjson;
-    
-    expect_separator = FALSE;
-    while (context->token != stop_token)
+    RETURN_VAL_IF_FAIL(element.begin && !element.bare, NULL);
+
+    parsectx_next_token(&c);
+
+    switch (c.token)
     {
-        if (expect_separator && context->token == TOK_COMMA)
-            parsectx_next_token(context);
-        else
-            expect_separator = TRUE;
+        case TOK_NULL:
+            entry[0] = MJSON_ID_NULL;
+            return (mjson_element_t)entry;
 
-        switch (context->token)
-        {
-            case TOK_IDENTIFIER:
-            case TOK_NOESC_STRING:
-                if (!parse_string(context, MJSON_ID_UTF8_KEY32))
-                    return 0;
-                break;        
-            default:
-                return 0;
-        }
+        case TOK_FALSE:
+            entry[0] = MJSON_ID_FALSE;
+            return (mjson_element_t)entry;
 
-        if (context->token != TOK_COLON && context->token != TOK_EQUAL)
-            return 0;
+        case TOK_TRUE:
+            entry[0] = MJSON_ID_TRUE;
+            return (mjson_element_t)entry;
 
-        parsectx_next_token(context);
+        case TOK_OCT_NUMBER:
+        case TOK_HEX_NUMBER:
+        case TOK_DEC_NUMBER:
+        case TOK_FLOAT_NUMBER:
+            RETURN_VAL_IF_FAIL(decode_number(&c, &id, &bits), NULL);
 
-        if (!parse_value(context))
-            return 0;
-    }
+            entry[0] = id;
+            if (id == MJSON_ID_SINT32 || id == MJSON_ID_FLOAT32)
+                entry[1] = (uint32_t)bits;
+            else
+                memcpy(entry + 1, &bits, sizeof(bits));
 
-    dictionary->val_u32 = context->bjson - data_start;
-    
-    assert((dictionary->val_u32 & 3) == 0);
-    
-    parsectx_next_token(context);
+            return (mjson_element_t)entry;
+    }
 
-    return 1;
+    return NULL;
 }
@@ -26,6 +26,68 @@ struct _mjson_entry_t;
 
 typedef const struct _mjson_entry_t* mjson_element_t;
 
+struct _mjson_stream_t;
+
+typedef struct _mjson_stream_t mjson_stream_t;
+
+struct _mjson_builder_t;
+
+typedef struct _mjson_builder_t mjson_builder_t;
+
+struct _mjson_path_t;
+
+typedef struct _mjson_path_t mjson_path_t;
+
+/**
+ * Storage callbacks for mjson_parse_ex. grow may move the block, parser
+ * never keeps pointers into it across allocations. Member is called release
+ * rather than free so CRT debug macros do not clash with it.
+ */
+typedef struct mjson_allocator_t
+{
+    void* (*reserve)(void* user_data, size_t size);
+    void* (*grow)   (void* user_data, void* buf, size_t old_size, size_t new_size);
+    void  (*release)(void* user_data, void* buf, size_t size);
+    void* user_data;
+} mjson_allocator_t;
+
+/**
+ * Document of mjson_parse_batch. With storage_buf set document is parsed
+ * into that buffer, otherwise storage is allocated and returned like in
+ * mjson_parse_ex. top_element is NULL if document failed to parse.
+ */
+typedef struct mjson_document_t
+{
+    const char*     json_data;
+    size_t          json_data_size;
+    void*           storage_buf;
+    size_t          storage_buf_size;
+    mjson_element_t top_element;
+} mjson_document_t;
+
+/**
+ * Value inside source text for on-demand access, begin is NULL for
+ * missing one. Handle is only valid while text is.
+ */
+typedef struct mjson_lazy_t
+{
+    const char* begin;
+    const char* end;    /* end of source text */
+    int         bare;   /* top dictionary without braces */
+} mjson_lazy_t;
+
+/**
+ * Position inside array or dictionary, see mjson_cursor_enter. Fields may
+ * be read directly: key is NULL inside arrays, value equals end once all
+ * elements were visited.
+ */
+typedef struct mjson_cursor_t
+{
+    mjson_element_t key;
+    mjson_element_t value;
+    const void*     end;    /* end of container data */
+} mjson_cursor_t;
+
 enum mjson_element_id_t
 {
     MJSON_ID_NULL           =  0,
@@ -58,23 +120,344 @@ enum mjson_element_id_t
     MJSON_ID_DICT64         = 19
 };
 
+enum mjson_parse_flags_t
+{
+    MJSON_PARSE_INDEXED        = 1 << 0, /* lex using structural index, see mjson_parse_indexed */
+    MJSON_PARSE_HASH_DICTS     = 1 << 1, /* append hash table of keys to every dictionary */
+    MJSON_PARSE_INDEX_ARRAYS   = 1 << 2, /* append table of element offsets to every array */
+    MJSON_PARSE_INTERN_KEYS    = 1 << 3, /* store repeated keys as references to the first copy */
+    MJSON_PARSE_INTERN_STRINGS = 1 << 4  /* same for string values up to 32 bytes */
+};
+
+enum mjson_write_flags_t
+{
+    MJSON_WRITE_PRETTY = 1 << 0, /* one element per line, indented by 4 spaces */
+    MJSON_WRITE_STRICT = 1 << 1  /* standard JSON: quoted keys, infinity written as null */
+};
+
+/* Types of struct members filled by mjson_bind */
+enum mjson_bind_type_t
+{
+    MJSON_BIND_INT32,
+    MJSON_BIND_INT64,
+    MJSON_BIND_UINT32,
+    MJSON_BIND_UINT64,
+    MJSON_BIND_FLOAT,
+    MJSON_BIND_DOUBLE,
+    MJSON_BIND_BOOL,        /* int */
+    MJSON_BIND_STRING,      /* char array of size bytes, NUL terminated */
+    MJSON_BIND_OBJECT,      /* nested struct described by schema */
+    MJSON_BIND_ARRAY        /* array of element_type, see mjson_bind_field_t */
+};
+
+struct mjson_schema_t;
+
+/**
+ * Member of bound struct. Arrays hold up to capacity elements of size
+ * bytes each, number of elements is stored to size_t member at
+ * count_offset; arrays of objects use schema for elements, arrays of
+ * arrays are not supported.
+ */
+typedef struct mjson_bind_field_t
+{
+    const char*                  key;
+    int                          type;          /* mjson_bind_type_t */
+    size_t                       offset;        /* of member in struct */
+    size_t                       size;          /* string buffer or array element size */
+    const struct mjson_schema_t* schema;        /* objects and arrays of objects */
+    int                          element_type;  /* arrays only */
+    size_t                       capacity;      /* arrays only */
+    size_t                       count_offset;  /* arrays only */
+} mjson_bind_field_t;
+
+typedef struct mjson_schema_t
+{
+    const mjson_bind_field_t* fields;
+    size_t                    field_count;
+} mjson_schema_t;
+
+/* Token kinds counted by mjson_parse_with_stats */
+enum mjson_stats_token_t
+{
+    MJSON_STATS_IDENTIFIER,  /* unquoted key */
+    MJSON_STATS_STRING,      /* quoted string or key */
+    MJSON_STATS_INTEGER,     /* decimal, hex or octal */
+    MJSON_STATS_FLOAT,
+    MJSON_STATS_LITERAL,     /* true, false, null */
+    MJSON_STATS_SEPARATOR,   /* , : = */
+    MJSON_STATS_OPEN,        /* [ { */
+    MJSON_STATS_CLOSE,       /* ] } */
+    MJSON_STATS_TOKEN_COUNT
+};
+
+/**
+ * Counters of mjson_parse_with_stats. Ticks come from CPU timestamp counter
+ * (clock() where there is none) and do not overlap: lex is tokenizing,
+ * number and string are decoding and emitting values, container is closing
+ * containers including lookup tables. Lookup tables are counted in
+ * output_bytes as BINARY32, fourcc is not counted.
+ */
+typedef struct mjson_parse_stats_t
+{
+    int      enabled;                               /* library was built with MJSON_STATS */
+    int      max_depth;
+    uint64_t tokens[MJSON_STATS_TOKEN_COUNT];
+    uint64_t skipped_bytes;                         /* whitespace and comments */
+    uint64_t plain_strings;                         /* strings and keys copied as is */
+    uint64_t escaped_strings;                       /* strings which needed decoding */
+    uint64_t output_bytes[MJSON_ID_DICT64 + 1];     /* by element id */
+    uint64_t lex_ticks;
+    uint64_t number_ticks;
+    uint64_t string_ticks;
+    uint64_t container_ticks;
+} mjson_parse_stats_t;
+
+/* Receives next piece of text from mjson_write_sink, returns 0 to stop writing */
+typedef int (*mjson_write_func_t)(void* user_data, const char* data, size_t size);
+
 int mjson_parse(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, mjson_element_t* top_element);
 
+/**
+ * Same as mjson_parse, produces identical blob, but lexes input in two stages:
+ * positions of structural characters, strings and values are first located in
+ * 64 byte blocks using SIMD bitmasks, parser then jumps between them instead of
+ * feeding every byte through the lexer. Faster on large documents.
+ */
+int mjson_parse_indexed(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, mjson_element_t* top_element);
+
+/**
+ * Same as mjson_parse with additional options from mjson_parse_flags_t.
+ * Lookup tables are read by the same accessors: mjson_get_member takes
+ * constant time on blobs parsed with MJSON_PARSE_HASH_DICTS, mjson_get_element
+ * and mjson_get_array_length with MJSON_PARSE_INDEX_ARRAYS.
+ */
+int mjson_parse_with_flags(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, unsigned flags, mjson_element_t* top_element);
+
+/**
+ * Same as mjson_parse_with_flags, but storage is obtained from allocator
+ * (malloc/realloc/free if NULL) and grows as needed instead of failing.
+ * On success storage_buf and storage_buf_size receive the block trimmed to
+ * blob size, which the caller releases with the same allocator; on failure
+ * storage is released and nothing is returned.
+ */
+int mjson_parse_ex(const char *json_data, size_t json_data_size, unsigned flags, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element);
+
+/**
+ * Same as mjson_parse_ex, but document with top level array is parsed on
+ * thread_count threads (number of CPUs if 0): input is split between
+ * elements at guessed points, slices are parsed concurrently and copied
+ * into one blob. Guesses are verified, wrong ones cost a serial reparse
+ * of the slice, or of the whole document if the last slice fails. Blob
+ * is identical to mjson_parse_ex except that interning does not cross
+ * slices. Small inputs, other documents and builds with MJSON_NO_THREADS
+ * are parsed serially. Allocator must be thread safe.
+ */
+int mjson_parse_parallel(const char *json_data, size_t json_data_size, unsigned flags, int thread_count, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element);
+
+/**
+ * Parses many independent documents on thread_count threads (number of
+ * CPUs if 0). Documents are split evenly between threads and idle threads
+ * steal work from busy ones. Returns 1 if every document was parsed, failed
+ * ones have NULL top_element. Allocator must be thread safe.
+ *
+ * mjson_parse_ndjson does the same for every non-blank line of input.
+ * document_count holds capacity of documents on input and number of lines
+ * on output; storage_buf of documents is used as described above. With
+ * documents NULL, or fewer than lines, lines are only counted and result is
+ * 1 or 0 respectively.
+ */
+int mjson_parse_batch (mjson_document_t* documents, size_t document_count, unsigned flags, int thread_count, const mjson_allocator_t* allocator);
+int mjson_parse_ndjson(const char *json_data, size_t json_data_size, unsigned flags, int thread_count, const mjson_allocator_t* allocator, mjson_document_t* documents, size_t* document_count);
+
+/**
+ * Validates input and computes exact size of storage buffer mjson_parse needs
+ * without writing any output, so buffer can be allocated once. The _with_flags
+ * variant accounts for lookup tables, with interning flags result is an upper
+ * bound.
+ */
+int mjson_parse_size           (const char *json_data, size_t json_data_size, size_t* storage_buf_size);
+int mjson_parse_size_with_flags(const char *json_data, size_t json_data_size, unsigned flags, size_t* storage_buf_size);
+
+/**
+ * Same as mjson_parse_with_flags, but also adds counters of this parse to
+ * stats, so one zeroed struct can collect many documents. Counters are only
+ * collected by library built with MJSON_STATS defined, otherwise stats are
+ * left untouched; other parse functions never pay for them. output_bytes is
+ * only updated on success.
+ */
+int mjson_parse_with_stats(const char *json_data, size_t json_data_size, void* storage_buf, size_t storage_buf_size, unsigned flags, mjson_parse_stats_t* stats, mjson_element_t* top_element);
+
+/**
+ * Parses document straight into struct described by schema, no blob is
+ * built. Top level has to be dictionary, members without field are
+ * validated and skipped, fields without member and null values leave
+ * struct untouched, so defaults can be set beforehand. Integers have to
+ * fit into their field, float fields accept any number, strings have to
+ * fit into buffer with terminator. Returns 0 on syntax error or value
+ * which does not match its field, out may be partially filled then.
+ */
+int mjson_bind(const char *json_data, size_t json_data_size, const mjson_schema_t* schema, void* out);
+
+/**
+ * Incremental parsing of input which arrives in chunks, e.g. from a pipe.
+ * Produces the same blob as mjson_parse_with_flags (MJSON_PARSE_INDEXED is
+ * ignored), tokens may be split between chunks at any byte. Feed returns 0
+ * once input is known to be invalid or storage is exhausted, end releases
+ * the parser and returns 1 if complete document was parsed.
+ */
+mjson_stream_t* mjson_parser_begin(void* storage_buf, size_t storage_buf_size, unsigned flags);
+int             mjson_parser_feed (mjson_stream_t* parser, const char* chunk, size_t chunk_size);
+int             mjson_parser_end  (mjson_stream_t* parser, mjson_element_t* top_element);
+
+/**
+ * Writes blob directly from code, without text. Top element is a container,
+ * dictionary members are added as key followed by value, end closes
+ * innermost container. Integers and floats are stored in the smallest exact
+ * entry the parser would use, flags are mjson_parse_flags_t and produce the
+ * same lookup tables and interning. Every call returns 0 once storage is
+ * exhausted or calls are out of order, e.g. value without key in dictionary.
+ * _create_ex grows storage obtained from allocator (malloc/realloc/free if
+ * NULL). Finish releases the builder and returns storage with blob size,
+ * storage of failed _create_ex builder is released.
+ */
+mjson_builder_t* mjson_builder_create   (void* storage_buf, size_t storage_buf_size, unsigned flags);
+mjson_builder_t* mjson_builder_create_ex(unsigned flags, const mjson_allocator_t* allocator);
+int              mjson_builder_begin_dict (mjson_builder_t* builder);
+int              mjson_builder_begin_array(mjson_builder_t* builder);
+int              mjson_builder_key   (mjson_builder_t* builder, const char* key);
+int              mjson_builder_end   (mjson_builder_t* builder);
+int              mjson_builder_int   (mjson_builder_t* builder, int64_t  value);
+int              mjson_builder_uint  (mjson_builder_t* builder, uint64_t value);
+int              mjson_builder_float (mjson_builder_t* builder, double   value);
+int              mjson_builder_string(mjson_builder_t* builder, const char* value);
+int              mjson_builder_bool  (mjson_builder_t* builder, int      value);
+int              mjson_builder_null  (mjson_builder_t* builder);
+int              mjson_builder_finish(mjson_builder_t* builder, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element);
+
+/**
+ * Parses text file with mjson_parse_ex. File is mapped and read sequentially
+ * where mmap is available, so it is never copied into a temporary buffer.
+ */
+int mjson_load_text_file(const char* path, unsigned flags, const mjson_allocator_t* allocator, void** storage_buf, size_t* storage_buf_size, mjson_element_t* top_element);
+
+/**
+ * Maps file with blob written by parser read-only and returns it together
+ * with top element, no parsing or copying is done and pages are shared
+ * between processes. Release with mjson_unmap_blob_file.
+ */
+const void* mjson_map_blob_file  (const char* path, size_t* blob_size, mjson_element_t* top_element);
+void        mjson_unmap_blob_file(const void* blob, size_t blob_size);
+
+/**
+ * Checks blob from untrusted source (e.g. file mapped with
+ * mjson_map_blob_file) in a single linear pass: entry ids, container sizes
+ * and nesting, string terminators, interned string references, lookup
+ * tables and 4 byte alignment. Accessors do not go out of bounds on blob
+ * which passed.
+ */
+int mjson_validate_blob(const void* blob, size_t blob_size);
+
+/**
+ * Writes element as text, compact by default, see mjson_write_flags_t.
+ * Without MJSON_WRITE_STRICT identifier keys are left unquoted and output
+ * is mjson rather than JSON. Text parses back into identical elements,
+ * except infinity in strict mode; floats use shortest exact form.
+ * Keys are written unescaped as parser takes no escapes in keys, so key
+ * with control characters is not standard JSON even in strict mode, and
+ * key with quote or backslash (only from builder) fails the write.
+ * mjson_write fills caller buffer and returns 0 if text does not fit,
+ * written receives full text size either way, text is NUL terminated if
+ * there is room. mjson_write_sink passes text in chunks of up to 4 KB.
+ */
+int mjson_write     (mjson_element_t element, unsigned flags, char* buf, size_t buf_size, size_t* written);
+int mjson_write_sink(mjson_element_t element, unsigned flags, mjson_write_func_t sink, void* user_data);
+
+/**
+ * Returns top element of blob written by parser (or of bare top container),
+ * only top entry is checked.
+ */
 mjson_element_t   mjson_get_top_element(void* storage_buf, size_t storage_buf_size);
 
 mjson_element_t   mjson_get_element_first(mjson_element_t array);
 mjson_element_t   mjson_get_element_next (mjson_element_t array, mjson_element_t current_value);
 mjson_element_t   mjson_get_element      (mjson_element_t array, int index);
+int               mjson_get_array_length (mjson_element_t array);
 
 mjson_element_t   mjson_get_member_first(mjson_element_t dictionary, mjson_element_t* value);
 mjson_element_t   mjson_get_member_next (mjson_element_t dictionary, mjson_element_t current_key, mjson_element_t* next_value);
 mjson_element_t   mjson_get_member      (mjson_element_t dictionary, const char* name);
 
+/**
+ * Unchecked iteration for tight loops over valid blobs (parser output or
+ * one passed mjson_validate_blob). Only enter checks its argument, it
+ * returns 0 and leaves cursor at end for anything but array or dictionary.
+ * next must not be called at end. Cursor caches container end and value
+ * of current member, so every step is one size computation per entry:
+ *
+ *     for (mjson_cursor_enter(&c, dict); !mjson_cursor_at_end(&c); mjson_cursor_next(&c))
+ *         use(mjson_cursor_key(&c), mjson_cursor_value(&c));
+ */
+int             mjson_cursor_enter (mjson_cursor_t* cursor, mjson_element_t container);
+void            mjson_cursor_next  (mjson_cursor_t* cursor);
+int             mjson_cursor_at_end(const mjson_cursor_t* cursor);
+mjson_element_t mjson_cursor_key   (const mjson_cursor_t* cursor);
+mjson_element_t mjson_cursor_value (const mjson_cursor_t* cursor);
+
+/* Accessors are macros as well, so loops do not pay for calls */
+#define mjson_cursor_at_end(cursor) ((const void*)(cursor)->value == (cursor)->end)
+#define mjson_cursor_key(cursor)    ((cursor)->key)
+#define mjson_cursor_value(cursor)  ((cursor)->value)
+
+/**
+ * Same as mjson_get_member for name of len bytes which needs not be NUL
+ * terminated. hash is 32 bit FNV-1a of name and is only used with lookup
+ * table of MJSON_PARSE_HASH_DICTS, mjson.hpp computes it at compile time.
+ */
+mjson_element_t   mjson_get_member_hashed(mjson_element_t dictionary, const char* name, size_t len, uint32_t hash);
+
+/**
+ * Compiled path to nested element, reusable with any number of blobs.
+ * Accepts "a.b[3].c" or RFC 6901 JSON Pointer "/a/b/3/c" (text starting
+ * with '/'); empty text refers to element itself. Keys are hashed and
+ * measured once by compile, so eval does no string processing besides
+ * comparing keys. Compile returns NULL on syntax error, eval returns NULL
+ * if any step is missing.
+ */
+mjson_path_t*     mjson_path_compile(const char* path);
+mjson_element_t   mjson_path_eval   (mjson_element_t element, const mjson_path_t* path);
+void              mjson_path_free   (mjson_path_t* path);
+
+/**
+ * On-demand access to text without parsing it: lookups lex only containers
+ * on the path and jump over other values by counting brackets, scalars are
+ * decoded when asked for. Suits reading a few fields of a big document;
+ * text which is not on the path is not validated. Getters follow mjson_get_*
+ * ones, strings are decoded into buf and returned if they fit there with
+ * terminating NUL. mjson_lazy_parse parses container at element into blob.
+ */
+mjson_lazy_t      mjson_lazy_open       (const char* json_data, size_t json_data_size);
+mjson_lazy_t      mjson_lazy_get_member (mjson_lazy_t dictionary, const char* name);
+mjson_lazy_t      mjson_lazy_get_element(mjson_lazy_t array, int index);
+int               mjson_lazy_get_type   (mjson_lazy_t element);
+const char*       mjson_lazy_get_string (mjson_lazy_t element, char* buf, size_t buf_size, const char* fallback);
+int32_t           mjson_lazy_get_int    (mjson_lazy_t element, int32_t  fallback);
+int64_t           mjson_lazy_get_int64  (mjson_lazy_t element, int64_t  fallback);
+uint64_t          mjson_lazy_get_uint64 (mjson_lazy_t element, uint64_t fallback);
+float             mjson_lazy_get_float  (mjson_lazy_t element, float    fallback);
+double            mjson_lazy_get_double (mjson_lazy_t element, double   fallback);
+int               mjson_lazy_get_bool   (mjson_lazy_t element, int      fallback);
+int               mjson_lazy_is_null    (mjson_lazy_t element);
+int               mjson_lazy_parse      (mjson_lazy_t element, void* storage_buf, size_t storage_buf_size, unsigned flags, mjson_element_t* top_element);
+
+/* Strings and containers over 4 GB report *64 ids, e.g. MJSON_ID_ARRAY64 */
 int mjson_get_type(mjson_element_t element);
 
 const char* mjson_get_string(mjson_element_t element, const char* fallback);
 int32_t     mjson_get_int   (mjson_element_t element, int32_t     fallback);
+int64_t     mjson_get_int64 (mjson_element_t element, int64_t     fallback);
+uint64_t    mjson_get_uint64(mjson_element_t element, uint64_t    fallback);
 float       mjson_get_float (mjson_element_t element, float       fallback);
+double      mjson_get_double(mjson_element_t element, double      fallback);
 int         mjson_get_bool  (mjson_element_t element, int         fallback);
 int         mjson_is_null   (mjson_element_t element);
 
@@ -0,0 +1,405 @@
+/**
+ * mjson C++ layer, header only, needs C++17.
+ *
+ * Keys are constexpr objects with length and hash computed at compile time:
+ *
+ *     mj::value width = mj::value(top)[mj::key<"width">];   // C++20
+ *     mj::value width = mj::value(top)["width"_key];        // C++17, using namespace mj::literals
+ *
+ * Lookup compares length before key bytes and probes hash table of
+ * dictionaries parsed with MJSON_PARSE_HASH_DICTS with precomputed hash.
+ *
+ * Views iterate containers by stepping over entries in blob:
+ *
+ *     for (mj::member m : mj::value(top).dict())
+ *         printf("%.*s = %d\n", (int)m.key.size(), m.key.data(), m.val.get<int>());
+ *
+ * Iteration does no checks besides type of the container, blob has to be
+ * valid, see mjson_validate_blob.
+ */
+
+#ifndef __MJSON_HPP_INCLUDED__
+#define __MJSON_HPP_INCLUDED__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <limits>
+#include <string_view>
+#include <type_traits>
+#include "mjson.h"
+
+namespace mj
+{
+
+// Same hash as stored in dictionary tables: 32 bit FNV-1a of key bytes
+constexpr uint32_t hash_key(const char* key, size_t len)
+{
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < len; ++i)
+        hash = (hash ^ (uint8_t)key[i]) * 16777619u;
+
+    return hash;
+}
+
+// Blob layout, same as in mjson.re
+namespace detail
+{
+    enum
+    {
+        ID_MASK    = 0xff,
+        FLAG_TABLE = 0x100,
+        FLAG_REF   = 0x200
+    };
+
+    inline uint32_t read_u32(const uint8_t* p)
+    {
+        uint32_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline uint64_t read_u64(const uint8_t* p)
+    {
+        uint64_t value;
+        memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    inline bool is_id64(uint32_t type)
+    {
+        return type >= MJSON_ID_UTF8_KEY32 && (type & 1);
+    }
+
+    // Data of string, binary or container, after 32 or 64 bit size
+    inline const uint8_t* data(const uint8_t* p)
+    {
+        return p + (is_id64(read_u32(p) & ID_MASK) ? 12 : 8);
+    }
+
+    inline size_t length(const uint8_t* p)
+    {
+        return is_id64(read_u32(p) & ID_MASK) ? (size_t)read_u64(p + 4) : read_u32(p + 4);
+    }
+
+    // Size of entry including data and lookup table
+    inline size_t size(const uint8_t* p)
+    {
+        uint32_t id   = read_u32(p);
+        uint32_t type = id & ID_MASK;
+
+        if (type <= MJSON_ID_TRUE)
+            return 4;
+        if (type < MJSON_ID_UTF8_KEY32)
+            return (type & 1) ? 12 : 8;
+        if (id & FLAG_REF)
+            return 8;
+
+        size_t len = length(p);
+
+        if (type <= MJSON_ID_UTF8_STRING64)
+            len += 1;
+        if (type <= MJSON_ID_BINARY64)
+            len = (len + 3) & ~(size_t)3;
+
+        size_t total = (data(p) - p) + len;
+
+        if (id & FLAG_TABLE)
+            total += 8 + ((read_u32(p + total + 4) + 3) & ~3u);
+
+        return total;
+    }
+
+    // Integral value fits into T
+    template<typename T>
+    bool fits(int64_t value)
+    {
+        if (value < 0)
+            return std::is_signed<T>::value && value >= (int64_t)std::numeric_limits<T>::min();
+        return (uint64_t)value <= (uint64_t)std::numeric_limits<T>::max();
+    }
+
+    template<typename T>
+    bool fits(uint64_t value)
+    {
+        return value <= (uint64_t)std::numeric_limits<T>::max();
+    }
+}
+
+struct key_t
+{
+    const char* name;
+    size_t      len;
+    uint32_t    hash;
+
+    constexpr key_t(const char* name, size_t len) : name(name), len(len), hash(hash_key(name, len)) {}
+};
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+template<size_t N>
+struct fixed_string
+{
+    char str[N];
+
+    constexpr fixed_string(const char (&s)[N])
+    {
+        for (size_t i = 0; i < N; ++i)
+            str[i] = s[i];
+    }
+};
+
+// Template parameter object has static storage, so name stays valid
+template<fixed_string S>
+inline constexpr key_t key = key_t(S.str, sizeof(S.str) - 1);
+#endif
+
+namespace literals
+{
+    constexpr key_t operator""_key(const char* name, size_t len)
+    {
+        return key_t(name, len);
+    }
+}
+
+class array_view;
+class dict_view;
+
+// Element handle, NULL for missing one so lookups can be chained
+class value
+{
+public:
+    constexpr value() : element_(NULL) {}
+    constexpr value(mjson_element_t element) : element_(element) {}
+
+    value operator[](const key_t& key) const
+    {
+        return mjson_get_member_hashed(element_, key.name, key.len, key.hash);
+    }
+
+    value operator[](int index) const
+    {
+        return mjson_get_element(element_, index);
+    }
+
+    explicit operator bool() const { return element_ != NULL; }
+
+    mjson_element_t element() const { return element_; }
+
+    int type() const
+    {
+        return element_ ? (int)(raw_id() & detail::ID_MASK) : MJSON_ID_NULL;
+    }
+
+    bool is_null() const { return !element_ || raw_id() == MJSON_ID_NULL; }
+
+    // String or key, length is taken from entry
+    std::string_view string(std::string_view fallback = std::string_view()) const
+    {
+        int t = type();
+
+        if (!element_ || t < MJSON_ID_UTF8_KEY32 || t > MJSON_ID_UTF8_STRING64)
+            return fallback;
+
+        const uint8_t* p = bytes();
+
+        if (raw_id() & detail::FLAG_REF)
+            p -= detail::read_u32(p + 4);
+
+        return std::string_view((const char*)detail::data(p), detail::length(p));
+    }
+
+    // Any numeric entry converted to T, integers must fit into integral T,
+    // floating point entries only convert to floating point T. get<bool>
+    // reads true and false.
+    template<typename T>
+    T get(T fallback = T()) const
+    {
+        static_assert(std::is_arithmetic<T>::value, "get<T> needs arithmetic type");
+
+        if (!element_)
+            return fallback;
+
+        if constexpr (std::is_same<T, bool>::value)
+        {
+            if (raw_id() == MJSON_ID_TRUE || raw_id() == MJSON_ID_FALSE)
+                return raw_id() == MJSON_ID_TRUE;
+            return fallback;
+        }
+        else
+        {
+            const uint8_t* p = bytes();
+
+            switch (raw_id())
+            {
+                case MJSON_ID_SINT32:
+                    return convert<T>((int64_t)(int32_t)detail::read_u32(p + 4), fallback);
+                case MJSON_ID_UINT32:
+                    return convert<T>((uint64_t)detail::read_u32(p + 4), fallback);
+                case MJSON_ID_SINT64:
+                    return convert<T>((int64_t)detail::read_u64(p + 4), fallback);
+                case MJSON_ID_UINT64:
+                    return convert<T>(detail::read_u64(p + 4), fallback);
+                case MJSON_ID_FLOAT32:
+                    if constexpr (std::is_floating_point<T>::value)
+                    {
+                        float f;
+                        memcpy(&f, p + 4, sizeof(f));
+                        return (T)f;
+                    }
+                    break;
+                case MJSON_ID_FLOAT64:
+                    if constexpr (std::is_floating_point<T>::value)
+                    {
+                        double d;
+                        memcpy(&d, p + 4, sizeof(d));
+                        return (T)d;
+                    }
+                    break;
+            }
+
+            return fallback;
+        }
+    }
+
+    // Empty view if element is not a container of that kind
+    inline array_view array() const;
+    inline dict_view  dict() const;
+
+private:
+    uint32_t raw_id() const { return detail::read_u32(bytes()); }
+
+    const uint8_t* bytes() const { return (const uint8_t*)element_; }
+
+    template<typename T, typename I>
+    static T convert(I value, T fallback)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+            return (T)value;
+        else
+            return detail::fits<T>(value) ? (T)value : fallback;
+    }
+
+    mjson_element_t element_;
+};
+
+struct member
+{
+    std::string_view key;
+    value            val;
+};
+
+class array_view
+{
+public:
+    class iterator
+    {
+    public:
+        explicit iterator(const uint8_t* p) : p_(p) {}
+
+        value operator*() const { return value((mjson_element_t)p_); }
+
+        iterator& operator++()
+        {
+            p_ += detail::size(p_);
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return p_ == other.p_; }
+        bool operator!=(const iterator& other) const { return p_ != other.p_; }
+
+    private:
+        const uint8_t* p_;
+    };
+
+    array_view() : begin_(NULL), end_(NULL), element_(NULL) {}
+
+    explicit array_view(mjson_element_t array) : begin_(NULL), end_(NULL), element_(NULL)
+    {
+        int t = value(array).type();
+
+        if (array && (t == MJSON_ID_ARRAY32 || t == MJSON_ID_ARRAY64))
+        {
+            element_ = array;
+            begin_   = detail::data((const uint8_t*)array);
+            end_     = begin_ + detail::length((const uint8_t*)array);
+        }
+    }
+
+    iterator begin() const { return iterator(begin_); }
+    iterator end()   const { return iterator(end_); }
+    bool     empty() const { return begin_ == end_; }
+
+    // Constant time with MJSON_PARSE_INDEX_ARRAYS
+    int   size()                const { return element_ ? mjson_get_array_length(element_) : 0; }
+    value operator[](int index) const { return mjson_get_element(element_, index); }
+
+private:
+    const uint8_t*  begin_;
+    const uint8_t*  end_;
+    mjson_element_t element_;
+};
+
+class dict_view
+{
+public:
+    class iterator
+    {
+    public:
+        explicit iterator(const uint8_t* p) : p_(p) {}
+
+        member operator*() const
+        {
+            member m = { value((mjson_element_t)p_).string(), value((mjson_element_t)(p_ + detail::size(p_))) };
+            return m;
+        }
+
+        iterator& operator++()
+        {
+            p_ += detail::size(p_);
+            p_ += detail::size(p_);
+            return *this;
+        }
+
+        bool operator==(const iterator& other) const { return p_ == other.p_; }
+        bool operator!=(const iterator& other) const { return p_ != other.p_; }
+
+    private:
+        const uint8_t* p_;
+    };
+
+    dict_view() : begin_(NULL), end_(NULL), element_(NULL) {}
+
+    explicit dict_view(mjson_element_t dictionary) : begin_(NULL), end_(NULL), element_(NULL)
+    {
+        int t = value(dictionary).type();
+
+        if (dictionary && (t == MJSON_ID_DICT32 || t == MJSON_ID_DICT64))
+        {
+            element_ = dictionary;
+            begin_   = detail::data((const uint8_t*)dictionary);
+            end_     = begin_ + detail::length((const uint8_t*)dictionary);
+        }
+    }
+
+    iterator begin() const { return iterator(begin_); }
+    iterator end()   const { return iterator(end_); }
+    bool     empty() const { return begin_ == end_; }
+
+    value operator[](const key_t& key) const
+    {
+        return mjson_get_member_hashed(element_, key.name, key.len, key.hash);
+    }
+
+private:
+    const uint8_t*  begin_;
+    const uint8_t*  end_;
+    mjson_element_t element_;
+};
+
+inline array_view value::array() const { return array_view(element_); }
+inline dict_view  value::dict()  const { return dict_view(element_); }
+
+} // namespace mj
+
+#endif